@@ -22,6 +22,7 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -41,12 +42,33 @@ namespace Audio {
 
 /**
  * Channel used by the default Mixer implementation.
+ *
+ * Once it has been inserted into the mixer, a channel is only used by the
+ * mixer callback. Everything the mixer API needs to know about it is kept
+ * in its MixerImpl::ChannelSlot. Channels are kept around by the mixer and
+ * reused for the following sounds.
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel();
 	~Channel();
 
+	/**
+	 * Starts playing a stream on the channel.
+	 *
+	 * @param outputRate     the output rate of the mixer
+	 * @param stream         the stream to play
+	 * @param autofreeStream whether to delete the stream once it is stopped
+	 * @param reverseStereo  whether to swap the left and right channels
+	 * @param highQuality    whether to use the high quality rate converter
+	 */
+	void start(uint outputRate, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, bool highQuality);
+
+	/**
+	 * Stops playing the channel's stream.
+	 */
+	void stop();
+
 	/**
 	 * Mixes the channel's samples into the given buffer.
 	 *
@@ -64,109 +86,46 @@ public:
 	bool isFinished() const { return _stream->endOfStream(); }
 
 	/**
-	 * Queries whether the channel is a permanent channel.
-	 * A permanent channel is not affected by a Mixer::stopAll
-	 * call.
-	 */
-	bool isPermanent() const { return _permanent; }
-
-	/**
-	 * Returns the id of the channel.
-	 */
-	int getId() const { return _id; }
-
-	/**
-	 * Pauses or unpaused the channel in a recursive fashion.
+	 * Sets the volume settings the channel is mixed with. The effective
+	 * left and right volumes are only recomputed when they changed.
 	 *
-	 * @param paused true, when the channel should be paused.
-	 *               false when it should be unpaused.
-	 */
-	void pause(bool paused);
-
-	/**
-	 * Queries whether the channel is currently paused.
+	 * @param volume     the channel's own volume
+	 * @param balance    the channel's balance
+	 * @param typeVolume the volume of the channel's sound type
+	 * @param muted      whether the channel's sound type is muted
 	 */
-	bool isPaused() const { return (_pauseLevel != 0); }
+	void setVolumes(byte volume, int8 balance, int typeVolume, bool muted);
 
 	/**
-	 * Sets the channel's own volume.
-	 *
-	 * @param volume new volume
-	 */
-	void setVolume(const byte volume);
-
-	/**
-	 * Gets the channel's own volume.
-	 *
-	 * @return volume
-	 */
-	byte getVolume();
-
-	/**
-	 * Sets the channel's balance setting.
-	 *
-	 * @param balance new balance
-	 */
-	void setBalance(const int8 balance);
-
-	/**
-	 * Gets the channel's balance setting.
-	 *
-	 * @return balance
-	 */
-	int8 getBalance();
-
-	/**
-	 * Notifies the channel that the global sound type
-	 * volume settings changed.
-	 */
-	void notifyGlobalVolChange() { updateChannelVolumes(); }
-
-	/**
-	 * Queries how long the channel has been playing.
-	 */
-	Timestamp getElapsedTime();
-
-	/**
-	 * Queries the channel's sound type.
-	 */
-	Mixer::SoundType getType() const { return _type; }
-
-	/**
-	 * Sets the channel's sound handle.
-	 *
-	 * @param handle new handle
+	 * Queries the number of samples played before the last mix() call.
 	 */
-	void setHandle(const SoundHandle handle) { _handle = handle; }
+	uint32 getSamplesConsumed() const { return _samplesConsumed; }
 
 	/**
-	 * Queries the channel's sound handle.
+	 * Queries the time of the last mix() call.
 	 */
-	SoundHandle getHandle() const { return _handle; }
+	uint32 getMixerTimeStamp() const { return _mixerTimeStamp; }
 
 private:
-	const Mixer::SoundType _type;
-	SoundHandle _handle;
-	bool _permanent;
-	int _pauseLevel;
-	int _id;
+	int _volume;
+	int _balance;
+	int _typeVolume;
+	bool _muted;
 
-	byte _volume;
-	int8 _balance;
-
-	void updateChannelVolumes();
 	st_volume_t _volL, _volR;
 
-	Mixer *_mixer;
-
 	uint32 _samplesConsumed;
 	uint32 _samplesDecoded;
 	uint32 _mixerTimeStamp;
-	uint32 _pauseStartTime;
-	uint32 _pauseTime;
 
 	RateConverter *_converter;
-	Common::DisposablePtr<AudioStream> _stream;
+	AudioStream *_stream;
+	DisposeAfterUse::Flag _autofreeStream;
+};
+
+struct MixerImpl::SlotChunk {
+	ChannelSlot slots[kSlotChunkSize];
+	Channel channels[kSlotChunkSize];
 };
 
 #pragma mark -
@@ -175,17 +134,20 @@ private:
 
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _numSlotChunks(0), _numFreeSlots(0), _finishedSlotsStart(0), _finishedSlotsEnd(0) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		_channels[i] = 0;
+	_highQualityResampling = (ConfMan.get("resampler") == "sinc");
+
+	for (int i = 0; i != kMaxSlotChunks; i++)
+		_slotChunks[i] = 0;
 }
 
 MixerImpl::~MixerImpl() {
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		delete _channels[i];
+	for (int i = 0; i != _numSlotChunks; i++)
+		delete _slotChunks[i];
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -196,26 +158,115 @@ uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
-void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
-	int index = -1;
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == 0) {
-			index = i;
-			break;
-		}
+MixerImpl::ChannelSlot &MixerImpl::getSlot(int index) {
+	return _slotChunks[index / kSlotChunkSize]->slots[index % kSlotChunkSize];
+}
+
+Channel &MixerImpl::getChannel(const ChannelSlot &slot) {
+	return _slotChunks[slot.index / kSlotChunkSize]->channels[slot.index % kSlotChunkSize];
+}
+
+MixerImpl::ChannelSlot *MixerImpl::findSlot(SoundHandle handle) {
+	const int index = handle._val % kMaxChannels;
+	if (index >= getNumSlots())
+		return 0;
+
+	ChannelSlot &slot = getSlot(index);
+	if (!Common::atomicLoad(&slot.channel) || (uint32)slot.handle != handle._val)
+		return 0;
+
+	return &slot;
+}
+
+MixerImpl::ChannelSlot *MixerImpl::allocateSlot() {
+	// Take back the slots of the channels which have finished playing
+	const int32 finishedSlotsEnd = Common::atomicLoad(&_finishedSlotsEnd);
+	while (_finishedSlotsStart != finishedSlotsEnd) {
+		_freeSlots[_numFreeSlots++] = _finishedSlots[_finishedSlotsStart % kMaxChannels];
+		_finishedSlotsStart++;
 	}
-	if (index == -1) {
-		warning("MixerImpl::out of mixer slots");
-		delete chan;
-		return;
+
+	if (!_numFreeSlots) {
+		if (_numSlotChunks == kMaxSlotChunks)
+			return 0;
+
+		SlotChunk *chunk = new SlotChunk();
+		for (int i = 0; i != kSlotChunkSize; i++)
+			chunk->slots[i].index = _numSlotChunks * kSlotChunkSize + i;
+
+		// Hand out the lowest slots first
+		for (int i = kSlotChunkSize - 1; i >= 0; i--)
+			_freeSlots[_numFreeSlots++] = chunk->slots[i].index;
+
+		// Publish the chunk before the mixer callback may look at it
+		_slotChunks[_numSlotChunks] = chunk;
+		Common::atomicStore(&_numSlotChunks, _numSlotChunks + 1);
 	}
 
-	_channels[index] = chan;
+	return &getSlot(_freeSlots[--_numFreeSlots]);
+}
+
+bool MixerImpl::takeChannel(ChannelSlot &slot) {
+	return Common::atomicExchange(&slot.channel, (Channel *)0) != 0;
+}
+
+void MixerImpl::stopChannel(ChannelSlot &slot) {
+	// The mixer callback marks the slot as busy before it looks at the
+	// channel. Once it is not busy anymore, the callback is either done
+	// with the channel or has found the slot empty. Yield while waiting,
+	// the callback may have been preempted by this very thread.
+	while (Common::atomicLoad(&slot.busy))
+		g_system->delayMillis(0);
+
+	getChannel(slot).stop();
+
+	Common::StackLock lock(_mutex);
+	_freeSlots[_numFreeSlots++] = slot.index;
+}
+
+void MixerImpl::pauseSlot(ChannelSlot &slot, bool paused) {
+	//assert((paused && slot.pauseLevel >= 0) || (!paused && slot.pauseLevel));
+
+	if (paused) {
+		slot.pauseLevel++;
 
+		if (slot.pauseLevel == 1) {
+			slot.pauseStartTime = g_system->getMillis(true);
+			Common::atomicStore(&slot.paused, 1);
+		}
+	} else if (slot.pauseLevel > 0) {
+		slot.pauseLevel--;
+
+		if (!slot.pauseLevel) {
+			slot.pauseEndTime = g_system->getMillis(true);
+			slot.pauseTime = slot.pauseEndTime - slot.pauseStartTime;
+			slot.pauseStartTime = 0;
+			Common::atomicStore(&slot.paused, 0);
+		}
+	}
+}
+
+void MixerImpl::insertChannel(SoundHandle *handle, ChannelSlot &slot, SoundType type, int id, byte volume, int8 balance, bool permanent) {
 	SoundHandle chanHandle;
-	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
+	chanHandle._val = slot.index + (_handleSeed * kMaxChannels);
+
+	slot.handle = chanHandle._val;
+	slot.id = id;
+	slot.type = type;
+	slot.permanent = permanent;
+	slot.volume = volume;
+	slot.balance = balance;
+	slot.paused = 0;
+	slot.pauseLevel = 0;
+	slot.pauseStartTime = 0;
+	slot.pauseEndTime = 0;
+	slot.pauseTime = 0;
+	slot.samplesConsumed = 0;
+	slot.mixerTimeStamp = 0;
+
+	// Hand the channel over to the mixer callback
+	Common::atomicStore(&slot.channel, &getChannel(slot));
 
-	chan->setHandle(chanHandle);
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
@@ -241,8 +292,9 @@ void MixerImpl::playStream(
 
 	// Prevent duplicate sounds
 	if (id != -1) {
-		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != 0 && _channels[i]->getId() == id) {
+		const int numSlots = getNumSlots();
+		for (int i = 0; i != numSlots; i++)
+			if (Common::atomicLoad(&getSlot(i).channel) && getSlot(i).id == id) {
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
 				// yet expect the stream to be gone. The primary example to
@@ -259,18 +311,22 @@ void MixerImpl::playStream(
 	reverseStereo = !reverseStereo;
 #endif
 
-	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
-	chan->setVolume(volume);
-	chan->setBalance(balance);
-	insertChannel(handle, chan);
+	ChannelSlot *slot = allocateSlot();
+	if (!slot) {
+		warning("MixerImpl::out of mixer slots");
+		if (autofreeStream == DisposeAfterUse::YES)
+			delete stream;
+		return;
+	}
+
+	// Set up the channel
+	getChannel(*slot).start(_sampleRate, stream, autofreeStream, reverseStereo, _highQualityResampling);
+	insertChannel(handle, *slot, type, id, volume, balance, permanent);
 }
 
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
-
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
@@ -284,103 +340,141 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 
 	// mix all channels
 	int res = 0, tmp;
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
+	const int numSlots = getNumSlots();
+	for (int i = 0; i != numSlots; i++) {
+		ChannelSlot &slot = getSlot(i);
+
+		// Announce that we are using the slot before looking at its channel,
+		// see stopChannel()
+		Common::atomicExchange(&slot.busy, 1);
+
+		Channel *chan = Common::atomicLoad(&slot.channel);
+		if (chan) {
+			if (chan->isFinished()) {
+				// Unless it is being stopped right now, the channel is ours
+				if (Common::atomicExchange(&slot.channel, (Channel *)0) == chan) {
+					chan->stop();
+
+					// Hand the slot back
+					_finishedSlots[_finishedSlotsEnd % kMaxChannels] = slot.index;
+					Common::atomicStore(&_finishedSlotsEnd, _finishedSlotsEnd + 1);
+				}
+			} else if (!slot.paused) {
+				const SoundTypeSettings &settings = _soundTypeSettings[slot.type];
+				chan->setVolumes(slot.volume, slot.balance, settings.volume, settings.mute != 0);
+
+				tmp = chan->mix(buf, len);
 
 				if (tmp > res)
 					res = tmp;
+
+				Common::atomicIncrement(&slot.timeSequence);
+				slot.samplesConsumed = chan->getSamplesConsumed();
+				slot.mixerTimeStamp = chan->getMixerTimeStamp();
+				Common::atomicIncrement(&slot.timeSequence);
 			}
 		}
 
+		Common::atomicStore(&slot.busy, 0);
+	}
+
 	return res;
 }
 
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
+	ChannelSlot *slots[kMaxChannels];
+	int numStopped = 0;
+	{
+		Common::StackLock lock(_mutex);
+		const int numSlots = getNumSlots();
+		for (int i = 0; i != numSlots; i++) {
+			ChannelSlot &slot = getSlot(i);
+			if (Common::atomicLoad(&slot.channel) && !slot.permanent && takeChannel(slot))
+				slots[numStopped++] = &slot;
 		}
 	}
+
+	for (int i = 0; i != numStopped; i++)
+		stopChannel(*slots[i]);
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
+	ChannelSlot *slots[kMaxChannels];
+	int numStopped = 0;
+	{
+		Common::StackLock lock(_mutex);
+		const int numSlots = getNumSlots();
+		for (int i = 0; i != numSlots; i++) {
+			ChannelSlot &slot = getSlot(i);
+			if (Common::atomicLoad(&slot.channel) && slot.id == id && takeChannel(slot))
+				slots[numStopped++] = &slot;
 		}
 	}
+
+	for (int i = 0; i != numStopped; i++)
+		stopChannel(*slots[i]);
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	ChannelSlot *slot;
+	{
+		Common::StackLock lock(_mutex);
 
-	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+		// Simply ignore stop requests for handles of sounds that already terminated
+		slot = findSlot(handle);
+		if (!slot || !takeChannel(*slot))
+			return;
+	}
 
-	delete _channels[index];
-	_channels[index] = 0;
+	stopChannel(*slot);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
-	_soundTypeSettings[type].mute = mute;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	// Picked up by the mixer callback
+	Common::atomicStore(&_soundTypeSettings[type].mute, mute);
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
-	return _soundTypeSettings[type].mute;
+	return _soundTypeSettings[type].mute != 0;
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
 		return;
 
-	_channels[index]->setVolume(volume);
+	Common::atomicStore(&slot->volume, volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return slot->volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
 		return;
 
-	_channels[index]->setBalance(balance);
+	Common::atomicStore(&slot->balance, balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return slot->balance;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -390,27 +484,72 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return Timestamp(0, _sampleRate);
+	Audio::Timestamp ts(0, _sampleRate);
+
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
+		return ts;
+
+	// Read a consistent snapshot of what the mixer callback published
+	int32 sequence;
+	uint32 samplesConsumed, mixerTimeStamp;
+	do {
+		sequence = Common::atomicLoad(&slot->timeSequence);
+		samplesConsumed = slot->samplesConsumed;
+		mixerTimeStamp = slot->mixerTimeStamp;
+		Common::atomicFence();
+	} while ((sequence & 1) || sequence != slot->timeSequence);
+
+	if (mixerTimeStamp == 0)
+		return ts;
+
+	int32 delta;
+	if (slot->pauseLevel) {
+		delta = slot->pauseStartTime - mixerTimeStamp;
+	} else {
+		delta = g_system->getMillis(true) - mixerTimeStamp;
+
+		// Leave out the time the channel was paused, unless it has been
+		// mixed again since
+		if (slot->pauseEndTime > mixerTimeStamp)
+			delta -= slot->pauseTime;
+	}
+
+	// The mixer callback picks up pause requests asynchronously, so it
+	// may have mixed the channel once more after it was paused
+	if (delta < 0)
+		delta = 0;
 
-	return _channels[index]->getElapsedTime();
+	// Convert the number of samples into a time duration.
+
+	ts = ts.addFrames(samplesConsumed);
+	ts = ts.addMsecs(delta);
+
+	// In theory it would seem like a good idea to limit the approximation
+	// so that it never exceeds the theoretical upper bound set by
+	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
+	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
+	// isn't invoked at the regular intervals that I first imagined.
+
+	return ts;
 }
 
 void MixerImpl::pauseAll(bool paused) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0) {
-			_channels[i]->pause(paused);
+	const int numSlots = getNumSlots();
+	for (int i = 0; i != numSlots; i++) {
+		if (Common::atomicLoad(&getSlot(i).channel)) {
+			pauseSlot(getSlot(i), paused);
 		}
 	}
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
+	const int numSlots = getNumSlots();
+	for (int i = 0; i != numSlots; i++) {
+		if (Common::atomicLoad(&getSlot(i).channel) && getSlot(i).id == id) {
+			pauseSlot(getSlot(i), paused);
 			return;
 		}
 	}
@@ -420,49 +559,44 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 	Common::StackLock lock(_mutex);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
 		return;
 
-	_channels[index]->pause(paused);
+	pauseSlot(*slot, paused);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+	const int numSlots = getNumSlots();
+	for (int i = 0; i != numSlots; i++)
+		if (Common::atomicLoad(&getSlot(i).channel) && getSlot(i).id == id)
 			return true;
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
+	ChannelSlot *slot = findSlot(handle);
+	if (slot)
+		return slot->id;
 	return 0;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return findSlot(handle) != 0;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+	const int numSlots = getNumSlots();
+	for (int i = 0; i != numSlots; i++)
+		if (Common::atomicLoad(&getSlot(i).channel) && getSlot(i).type == type)
 			return true;
 	return false;
 }
@@ -479,13 +613,8 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
-	Common::StackLock lock(_mutex);
-	_soundTypeSettings[type].volume = volume;
-
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	// Picked up by the mixer callback
+	Common::atomicStore(&_soundTypeSettings[type].volume, volume);
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
@@ -499,42 +628,53 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark --- Channel implementations ---
 #pragma mark -
 
-Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
-    : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
-      _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
-      _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
-      _stream(stream, autofreeStream) {
-	assert(mixer);
+Channel::Channel()
+    : _volume(-1), _balance(0), _typeVolume(0), _muted(false), _volL(0), _volR(0),
+      _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0), _converter(0),
+      _stream(0), _autofreeStream(DisposeAfterUse::NO) {
+}
+
+Channel::~Channel() {
+	stop();
+}
+
+void Channel::start(uint outputRate, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, bool highQuality) {
 	assert(stream);
+	assert(!_stream);
+
+	_stream = stream;
+	_autofreeStream = autofreeStream;
+
+	// Force the effective volumes to be computed before the first mix
+	_volume = -1;
+	_volL = _volR = 0;
+
+	_samplesConsumed = 0;
+	_samplesDecoded = 0;
+	_mixerTimeStamp = 0;
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), outputRate, _stream->isStereo(), reverseStereo, highQuality);
 }
 
-Channel::~Channel() {
+void Channel::stop() {
 	delete _converter;
-}
+	_converter = 0;
 
-void Channel::setVolume(const byte volume) {
-	_volume = volume;
-	updateChannelVolumes();
+	if (_autofreeStream == DisposeAfterUse::YES)
+		delete _stream;
+	_stream = 0;
 }
 
-byte Channel::getVolume() {
-	return _volume;
-}
+void Channel::setVolumes(byte volume, int8 balance, int typeVolume, bool muted) {
+	if (volume == _volume && balance == _balance && typeVolume == _typeVolume && muted == _muted)
+		return;
 
-void Channel::setBalance(const int8 balance) {
+	_volume = volume;
 	_balance = balance;
-	updateChannelVolumes();
-}
-
-int8 Channel::getBalance() {
-	return _balance;
-}
+	_typeVolume = typeVolume;
+	_muted = muted;
 
-void Channel::updateChannelVolumes() {
 	// From the channel balance/volume and the global volume, we compute
 	// the effective volume for the left and right channel. Note the
 	// slightly odd divisor: the 255 reflects the fact that the maximal
@@ -543,8 +683,8 @@ void Channel::updateChannelVolumes() {
 	// volume is in the range 0 - kMaxMixerVolume.
 	// Hence, the vol_l/vol_r values will be in that range, too
 
-	if (!_mixer->isSoundTypeMuted(_type)) {
-		int vol = _mixer->getVolumeForSoundType(_type) * _volume;
+	if (!_muted) {
+		int vol = _typeVolume * _volume;
 
 		if (_balance == 0) {
 			_volL = vol / Mixer::kMaxChannelVolume;
@@ -561,52 +701,6 @@ void Channel::updateChannelVolumes() {
 	}
 }
 
-void Channel::pause(bool paused) {
-	//assert((paused && _pauseLevel >= 0) || (!paused && _pauseLevel));
-
-	if (paused) {
-		_pauseLevel++;
-
-		if (_pauseLevel == 1)
-			_pauseStartTime = g_system->getMillis(true);
-	} else if (_pauseLevel > 0) {
-		_pauseLevel--;
-
-		if (!_pauseLevel) {
-			_pauseTime = (g_system->getMillis(true) - _pauseStartTime);
-			_pauseStartTime = 0;
-		}
-	}
-}
-
-Timestamp Channel::getElapsedTime() {
-	const uint32 rate = _mixer->getOutputRate();
-	uint32 delta = 0;
-
-	Audio::Timestamp ts(0, rate);
-
-	if (_mixerTimeStamp == 0)
-		return ts;
-
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
-	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
-
-	// Convert the number of samples into a time duration.
-
-	ts = ts.addFrames(_samplesConsumed);
-	ts = ts.addMsecs(delta);
-
-	// In theory it would seem like a good idea to limit the approximation
-	// so that it never exceeds the theoretical upper bound set by
-	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
-	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
-	// isn't invoked at the regular intervals that I first imagined.
-
-	return ts;
-}
-
 int Channel::mix(int16 *data, uint len) {
 	assert(_stream);
 
@@ -617,7 +711,6 @@ int Channel::mix(int16 *data, uint len) {
 		assert(_converter);
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis(true);
-		_pauseTime = 0;
 		res = _converter->flow(*_stream, data, len, _volL, _volR);
 		_samplesDecoded += res;
 	}
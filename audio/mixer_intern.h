@@ -24,6 +24,7 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/atomic.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
 
@@ -51,25 +52,143 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		/** Number of channel slots added whenever the mixer runs out of them. */
+		kSlotChunkSize = 16,
+
+		/** Maximal number of channels playing at the same time. */
+		kMaxChannels = 256,
+
+		kMaxSlotChunks = kMaxChannels / kSlotChunkSize
 	};
 
+	/**
+	 * The state of a channel slot. The mixer callback never waits for the
+	 * threads calling the mixer API: channels are handed over by atomically
+	 * exchanging the channel pointer, and everything else the callback needs
+	 * or provides is published as single words.
+	 */
+	struct ChannelSlot {
+		/**
+		 * The channel playing in this slot. It is owned by whoever atomically
+		 * takes it out of the slot: the mixer callback once the channel has
+		 * finished, or the API when stopping it.
+		 */
+		Channel *volatile channel;
+
+		/** Set by the mixer callback while it is using the slot's channel. */
+		volatile int32 busy;
+
+		/** Index of the slot, encoded in the handles of its channels. */
+		int index;
+
+		// Set up before the channel is published and left alone afterwards
+		volatile int32 handle;
+		volatile int32 id;
+		SoundType type;
+		bool permanent;
+
+		// Picked up by the mixer callback before mixing the channel
+		volatile int32 volume;
+		volatile int32 balance;
+		volatile int32 paused;
+
+		// Pause book-keeping for getElapsedTime(), guarded by _mutex
+		int pauseLevel;
+		uint32 pauseStartTime;
+		uint32 pauseEndTime;
+		uint32 pauseTime;
+
+		// Published by the mixer callback after mixing the channel. The
+		// sequence counter is odd while an update is in progress.
+		volatile int32 timeSequence;
+		volatile int32 samplesConsumed;
+		volatile int32 mixerTimeStamp;
+	};
+
+	/**
+	 * Serializes the threads calling the mixer API. It is never taken by
+	 * the mixer callback.
+	 */
 	Common::Mutex _mutex;
 
 	const uint _sampleRate;
 	bool _mixerReady;
+	/** Whether to use the sinc resampler, read from the config when the mixer is created */
+	bool _highQualityResampling;
 	uint32 _handleSeed;
 
 	struct SoundTypeSettings {
 		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
 
-		bool mute;
-		int volume;
+		volatile int32 mute;
+		volatile int32 volume;
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
-	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * A block of channel slots, along with the channels playing in them.
+	 * Channels are reused instead of being allocated for every sound.
+	 */
+	struct SlotChunk;
+
+	/**
+	 * The channel slots, allocated in chunks as needed. Chunks are never
+	 * freed while the mixer exists, so the mixer callback can walk them
+	 * while new ones are being added.
+	 */
+	SlotChunk *_slotChunks[kMaxSlotChunks];
+	volatile int32 _numSlotChunks;
+
+	/** Indices of the slots available for new channels, guarded by _mutex. */
+	int _freeSlots[kMaxChannels];
+	int _numFreeSlots;
+
+	/**
+	 * Indices of the slots whose channel has finished, handed back by the
+	 * mixer callback. As every slot is in here at most once, the ring
+	 * never overflows. The callback only writes _finishedSlotsEnd, the API
+	 * only writes _finishedSlotsStart.
+	 */
+	int _finishedSlots[kMaxChannels];
+	volatile int32 _finishedSlotsStart;
+	volatile int32 _finishedSlotsEnd;
+
+	/** Get the number of slots the mixer currently has. */
+	int getNumSlots() const { return Common::atomicLoad(&_numSlotChunks) * kSlotChunkSize; }
+
+	ChannelSlot &getSlot(int index);
+	Channel &getChannel(const ChannelSlot &slot);
+
+	/**
+	 * Get a slot for a new channel, adding slots if necessary. Returns 0 if
+	 * kMaxChannels channels are playing already. Must be called with _mutex
+	 * held.
+	 */
+	ChannelSlot *allocateSlot();
+
+	/**
+	 * Look up the slot of the channel with the given handle. Returns 0 if
+	 * the channel is not playing anymore.
+	 */
+	ChannelSlot *findSlot(SoundHandle handle);
+
+	/**
+	 * Take the channel out of the given slot, so that the mixer callback
+	 * does not pick it up anymore. Returns false if the channel has finished
+	 * meanwhile. Must be called with _mutex held.
+	 */
+	bool takeChannel(ChannelSlot &slot);
+
+	/**
+	 * Stop a channel taken out of the given slot once the mixer callback is
+	 * done with it, and make the slot available again. Must not be called
+	 * with _mutex held: the channel's stream may be calling back into the
+	 * mixer while it is being mixed.
+	 */
+	void stopChannel(ChannelSlot &slot);
+
+	void pauseSlot(ChannelSlot &slot, bool paused);
 
 public:
 
@@ -119,7 +238,7 @@ public:
 	virtual uint getOutputRate() const;
 
 protected:
-	void insertChannel(SoundHandle *handle, Channel *chan);
+	void insertChannel(SoundHandle *handle, ChannelSlot &slot, SoundType type, int id, byte volume, int8 balance, bool permanent);
 
 public:
 	/**
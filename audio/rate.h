@@ -78,7 +78,20 @@ public:
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+/**
+ * Create and return a RateConverter object for the specified input and output rates.
+ *
+ * @param highQuality whether to use the windowed sinc converter instead of
+ *                    linear interpolation when the rates differ
+ */
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, bool highQuality = false);
+
+/**
+ * Create and return a RateConverter object which uses a windowed sinc filter
+ * for band-limited interpolation. This sounds much cleaner than the default
+ * linear interpolation, but takes more CPU time.
+ */
+RateConverter *makeSincRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
 
 } // End of namespace Audio
 
@@ -0,0 +1,454 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_mix.h"
+#include "audio/mixer.h"
+#include "common/atomic.h"
+#include "common/util.h"
+
+// Instruction sets always available when compiling for them
+#if !defined(OUTPUT_UNSIGNED_AUDIO)
+#	if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define USE_RATE_MIX_SSE2
+#		include <emmintrin.h>
+#	endif
+#	if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#		define USE_RATE_MIX_NEON
+#		include <arm_neon.h>
+#	endif
+#endif
+
+// AVX2 is only used when the CPU supports it, which needs compiler support
+// for per-function target instruction sets
+#if defined(USE_RATE_MIX_SSE2) && defined(__GNUC__) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#	define USE_RATE_MIX_AVX2
+#	include <immintrin.h>
+#endif
+
+namespace Audio {
+
+#pragma mark -
+#pragma mark --- Reference implementation ---
+#pragma mark -
+
+static void mixStereo(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; numFrames > 0; numFrames--) {
+		clampedAdd(obuf[0], (samples[0] * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(obuf[1], (samples[1] * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		samples += 2;
+		obuf += 2;
+	}
+}
+
+static void mixStereoReversed(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; numFrames > 0; numFrames--) {
+		clampedAdd(obuf[1], (samples[0] * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(obuf[0], (samples[1] * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		samples += 2;
+		obuf += 2;
+	}
+}
+
+static void mixMono(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; numFrames > 0; numFrames--) {
+		clampedAdd(obuf[0], (*samples * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(obuf[1], (*samples * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		samples++;
+		obuf += 2;
+	}
+}
+
+static int32 dotProduct(const st_sample_t *a, const st_sample_t *b, uint length) {
+	int32 sum = 0;
+	for (; length > 0; length--)
+		sum += *a++ * *b++;
+	return sum;
+}
+
+/**
+ * The loop shared by all filter kernels. The dot product of the respective
+ * instruction set is provided by the static compute() method of DotProduct,
+ * so it can be inlined.
+ */
+template<class DotProduct, bool stereo>
+static inline uint filterWindow(st_sample_t *out, const st_sample_t *const *windows, const int16 *coeffs, uint numTaps, frac_t &opos, frac_t oposInc, uint maxFrames) {
+	uint frames = 0;
+
+	while (opos < (frac_t)FRAC_ONE && frames < maxFrames) {
+		const int phase = (opos + (1 << (FRAC_BITS - kRateFilterPhaseBits - 1))) >> (FRAC_BITS - kRateFilterPhaseBits);
+		const int16 *phaseCoeffs = coeffs + phase * numTaps;
+
+		for (uint channel = 0; channel < (stereo ? 2U : 1U); channel++) {
+			const int32 val = (DotProduct::compute(windows[channel], phaseCoeffs, numTaps) + (1 << (kRateFilterCoeffBits - 1))) >> kRateFilterCoeffBits;
+			*out++ = (st_sample_t)CLIP<int32>(val, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+		}
+
+		frames++;
+		opos += oposInc;
+	}
+
+	return frames;
+}
+
+struct DotProductCPP {
+	static int32 compute(const st_sample_t *a, const st_sample_t *b, uint length) { return dotProduct(a, b, length); }
+};
+
+static uint filterMono(st_sample_t *out, const st_sample_t *const *windows, const int16 *coeffs, uint numTaps, frac_t &opos, frac_t oposInc, uint maxFrames) {
+	return filterWindow<DotProductCPP, false>(out, windows, coeffs, numTaps, opos, oposInc, maxFrames);
+}
+
+static uint filterStereo(st_sample_t *out, const st_sample_t *const *windows, const int16 *coeffs, uint numTaps, frac_t &opos, frac_t oposInc, uint maxFrames) {
+	return filterWindow<DotProductCPP, true>(out, windows, coeffs, numTaps, opos, oposInc, maxFrames);
+}
+
+static const RateMixKernels s_kernelsCPP = {
+	"C++", &mixStereo, &mixStereoReversed, &mixMono, &filterMono, &filterStereo
+};
+
+// The vector implementations below all work the same way: the samples are
+// multiplied by the volumes into 32 bit products, which are divided by 256
+// rounding towards zero (by adding 255 to negative products before shifting),
+// and then added to the output with signed saturation.
+
+#ifdef USE_RATE_MIX_SSE2
+
+#pragma mark -
+#pragma mark --- SSE2 implementation ---
+#pragma mark -
+
+static inline __m128i applyVolumeSSE2(__m128i samples, __m128i volumes) {
+	const __m128i lo = _mm_mullo_epi16(samples, volumes);
+	const __m128i hi = _mm_mulhi_epi16(samples, volumes);
+	const __m128i bias = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias)), 8);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias)), 8);
+
+	return _mm_packs_epi32(p0, p1);
+}
+
+static inline void mixSSE2(st_sample_t *obuf, __m128i samples, __m128i volumes) {
+	const __m128i out = _mm_loadu_si128((const __m128i *)obuf);
+	_mm_storeu_si128((__m128i *)obuf, _mm_adds_epi16(out, applyVolumeSSE2(samples, volumes)));
+}
+
+static void mixStereoSSE2(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m128i volumes = _mm_setr_epi16(vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r);
+
+	for (; numFrames >= 4; numFrames -= 4) {
+		mixSSE2(obuf, _mm_loadu_si128((const __m128i *)samples), volumes);
+		samples += 8;
+		obuf += 8;
+	}
+
+	mixStereo(obuf, samples, numFrames, vol_l, vol_r);
+}
+
+static void mixStereoReversedSSE2(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m128i volumes = _mm_setr_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+	for (; numFrames >= 4; numFrames -= 4) {
+		__m128i in = _mm_loadu_si128((const __m128i *)samples);
+		in = _mm_shufflehi_epi16(_mm_shufflelo_epi16(in, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		mixSSE2(obuf, in, volumes);
+		samples += 8;
+		obuf += 8;
+	}
+
+	mixStereoReversed(obuf, samples, numFrames, vol_l, vol_r);
+}
+
+static void mixMonoSSE2(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m128i volumes = _mm_setr_epi16(vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r);
+
+	for (; numFrames >= 8; numFrames -= 8) {
+		const __m128i in = _mm_loadu_si128((const __m128i *)samples);
+		mixSSE2(obuf, _mm_unpacklo_epi16(in, in), volumes);
+		mixSSE2(obuf + 8, _mm_unpackhi_epi16(in, in), volumes);
+		samples += 8;
+		obuf += 16;
+	}
+
+	mixMono(obuf, samples, numFrames, vol_l, vol_r);
+}
+
+static inline int32 sumSSE2(__m128i sum) {
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+static int32 dotProductSSE2(const st_sample_t *a, const st_sample_t *b, uint length) {
+	__m128i sum = _mm_setzero_si128();
+
+	for (; length >= 8; length -= 8) {
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)a), _mm_loadu_si128((const __m128i *)b)));
+		a += 8;
+		b += 8;
+	}
+
+	return sumSSE2(sum) + dotProduct(a, b, length);
+}
+
+struct DotProductSSE2 {
+	static int32 compute(const st_sample_t *a, const st_sample_t *b, uint length) { return dotProductSSE2(a, b, length); }
+};
+
+static uint filterMonoSSE2(st_sample_t *out, const st_sample_t *const *windows, const int16 *coeffs, uint numTaps, frac_t &opos, frac_t oposInc, uint maxFrames) {
+	return filterWindow<DotProductSSE2, false>(out, windows, coeffs, numTaps, opos, oposInc, maxFrames);
+}
+
+static uint filterStereoSSE2(st_sample_t *out, const st_sample_t *const *windows, const int16 *coeffs, uint numTaps, frac_t &opos, frac_t oposInc, uint maxFrames) {
+	return filterWindow<DotProductSSE2, true>(out, windows, coeffs, numTaps, opos, oposInc, maxFrames);
+}
+
+static const RateMixKernels s_kernelsSSE2 = {
+	"SSE2", &mixStereoSSE2, &mixStereoReversedSSE2, &mixMonoSSE2, &filterMonoSSE2, &filterStereoSSE2
+};
+
+#endif // USE_RATE_MIX_SSE2
+
+#ifdef USE_RATE_MIX_AVX2
+
+#pragma mark -
+#pragma mark --- AVX2 implementation ---
+#pragma mark -
+
+#define RATE_MIX_AVX2_FUNC __attribute__((target("avx2")))
+
+// The AVX2 unpack and pack instructions work on each 128 bit half of the
+// registers separately, so the sample order is preserved as with SSE2.
+
+RATE_MIX_AVX2_FUNC static inline void mixAVX2(st_sample_t *obuf, __m256i samples, __m256i volumes) {
+	const __m256i lo = _mm256_mullo_epi16(samples, volumes);
+	const __m256i hi = _mm256_mulhi_epi16(samples, volumes);
+	const __m256i bias = _mm256_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+
+	__m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+	__m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+	p0 = _mm256_srai_epi32(_mm256_add_epi32(p0, _mm256_and_si256(_mm256_srai_epi32(p0, 31), bias)), 8);
+	p1 = _mm256_srai_epi32(_mm256_add_epi32(p1, _mm256_and_si256(_mm256_srai_epi32(p1, 31), bias)), 8);
+
+	const __m256i out = _mm256_loadu_si256((const __m256i *)obuf);
+	_mm256_storeu_si256((__m256i *)obuf, _mm256_adds_epi16(out, _mm256_packs_epi32(p0, p1)));
+}
+
+RATE_MIX_AVX2_FUNC static void mixStereoAVX2(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m256i volumes = _mm256_set1_epi32((uint16)vol_l | ((uint32)vol_r << 16));
+
+	for (; numFrames >= 8; numFrames -= 8) {
+		mixAVX2(obuf, _mm256_loadu_si256((const __m256i *)samples), volumes);
+		samples += 16;
+		obuf += 16;
+	}
+
+	mixStereoSSE2(obuf, samples, numFrames, vol_l, vol_r);
+}
+
+RATE_MIX_AVX2_FUNC static void mixStereoReversedAVX2(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m256i volumes = _mm256_set1_epi32((uint16)vol_r | ((uint32)vol_l << 16));
+
+	for (; numFrames >= 8; numFrames -= 8) {
+		__m256i in = _mm256_loadu_si256((const __m256i *)samples);
+		in = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(in, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		mixAVX2(obuf, in, volumes);
+		samples += 16;
+		obuf += 16;
+	}
+
+	mixStereoReversedSSE2(obuf, samples, numFrames, vol_l, vol_r);
+}
+
+RATE_MIX_AVX2_FUNC static void mixMonoAVX2(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m256i volumes = _mm256_set1_epi32((uint16)vol_l | ((uint32)vol_r << 16));
+
+	for (; numFrames >= 16; numFrames -= 16) {
+		// Put the quarters in the order 0, 2, 1, 3 so that unpacking each
+		// half duplicates the samples in their original order
+		__m256i in = _mm256_loadu_si256((const __m256i *)samples);
+		in = _mm256_permute4x64_epi64(in, _MM_SHUFFLE(3, 1, 2, 0));
+		mixAVX2(obuf, _mm256_unpacklo_epi16(in, in), volumes);
+		mixAVX2(obuf + 16, _mm256_unpackhi_epi16(in, in), volumes);
+		samples += 16;
+		obuf += 32;
+	}
+
+	mixMonoSSE2(obuf, samples, numFrames, vol_l, vol_r);
+}
+
+// The AVX2 dot product can't be inlined into the filter loop, which isn't
+// compiled for AVX2, so the SSE2 filters are used.
+static const RateMixKernels s_kernelsAVX2 = {
+	"AVX2", &mixStereoAVX2, &mixStereoReversedAVX2, &mixMonoAVX2, &filterMonoSSE2, &filterStereoSSE2
+};
+
+#endif // USE_RATE_MIX_AVX2
+
+#ifdef USE_RATE_MIX_NEON
+
+#pragma mark -
+#pragma mark --- NEON implementation ---
+#pragma mark -
+
+static inline int32x4_t divideVolumeNEON(int32x4_t p) {
+	const int32x4_t bias = vdupq_n_s32(Audio::Mixer::kMaxMixerVolume - 1);
+	return vshrq_n_s32(vaddq_s32(p, vandq_s32(vshrq_n_s32(p, 31), bias)), 8);
+}
+
+static inline void mixNEON(st_sample_t *obuf, int16x8_t samples, int16x8_t volumes) {
+	const int32x4_t p0 = divideVolumeNEON(vmull_s16(vget_low_s16(samples), vget_low_s16(volumes)));
+	const int32x4_t p1 = divideVolumeNEON(vmull_s16(vget_high_s16(samples), vget_high_s16(volumes)));
+
+	const int16x8_t out = vld1q_s16(obuf);
+	vst1q_s16(obuf, vqaddq_s16(out, vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1))));
+}
+
+static inline int16x8_t makeVolumesNEON(st_volume_t vol0, st_volume_t vol1) {
+	const int16_t volumes[8] = { (int16)vol0, (int16)vol1, (int16)vol0, (int16)vol1, (int16)vol0, (int16)vol1, (int16)vol0, (int16)vol1 };
+	return vld1q_s16(volumes);
+}
+
+static void mixStereoNEON(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	const int16x8_t volumes = makeVolumesNEON(vol_l, vol_r);
+
+	for (; numFrames >= 4; numFrames -= 4) {
+		mixNEON(obuf, vld1q_s16(samples), volumes);
+		samples += 8;
+		obuf += 8;
+	}
+
+	mixStereo(obuf, samples, numFrames, vol_l, vol_r);
+}
+
+static void mixStereoReversedNEON(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	const int16x8_t volumes = makeVolumesNEON(vol_r, vol_l);
+
+	for (; numFrames >= 4; numFrames -= 4) {
+		mixNEON(obuf, vrev32q_s16(vld1q_s16(samples)), volumes);
+		samples += 8;
+		obuf += 8;
+	}
+
+	mixStereoReversed(obuf, samples, numFrames, vol_l, vol_r);
+}
+
+static void mixMonoNEON(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	const int16x8_t volumes = makeVolumesNEON(vol_l, vol_r);
+
+	for (; numFrames >= 8; numFrames -= 8) {
+		const int16x8_t in = vld1q_s16(samples);
+		const int16x8x2_t pairs = vzipq_s16(in, in);
+		mixNEON(obuf, pairs.val[0], volumes);
+		mixNEON(obuf + 8, pairs.val[1], volumes);
+		samples += 8;
+		obuf += 16;
+	}
+
+	mixMono(obuf, samples, numFrames, vol_l, vol_r);
+}
+
+static int32 dotProductNEON(const st_sample_t *a, const st_sample_t *b, uint length) {
+	int32x4_t sum = vdupq_n_s32(0);
+
+	for (; length >= 8; length -= 8) {
+		const int16x8_t va = vld1q_s16(a);
+		const int16x8_t vb = vld1q_s16(b);
+		sum = vmlal_s16(sum, vget_low_s16(va), vget_low_s16(vb));
+		sum = vmlal_s16(sum, vget_high_s16(va), vget_high_s16(vb));
+		a += 8;
+		b += 8;
+	}
+
+	const int32x2_t sum2 = vpadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	return vget_lane_s32(vpadd_s32(sum2, sum2), 0) + dotProduct(a, b, length);
+}
+
+struct DotProductNEON {
+	static int32 compute(const st_sample_t *a, const st_sample_t *b, uint length) { return dotProductNEON(a, b, length); }
+};
+
+static uint filterMonoNEON(st_sample_t *out, const st_sample_t *const *windows, const int16 *coeffs, uint numTaps, frac_t &opos, frac_t oposInc, uint maxFrames) {
+	return filterWindow<DotProductNEON, false>(out, windows, coeffs, numTaps, opos, oposInc, maxFrames);
+}
+
+static uint filterStereoNEON(st_sample_t *out, const st_sample_t *const *windows, const int16 *coeffs, uint numTaps, frac_t &opos, frac_t oposInc, uint maxFrames) {
+	return filterWindow<DotProductNEON, true>(out, windows, coeffs, numTaps, opos, oposInc, maxFrames);
+}
+
+static const RateMixKernels s_kernelsNEON = {
+	"NEON", &mixStereoNEON, &mixStereoReversedNEON, &mixMonoNEON, &filterMonoNEON, &filterStereoNEON
+};
+
+#endif // USE_RATE_MIX_NEON
+
+#pragma mark -
+#pragma mark --- Dispatch ---
+#pragma mark -
+
+static const RateMixKernels *s_kernels[4];
+static volatile int32 s_kernelsCount = 0;
+
+static void initRateMixKernels() {
+	if (Common::atomicLoad(&s_kernelsCount))
+		return;
+
+	uint count = 0;
+	s_kernels[count++] = &s_kernelsCPP;
+
+#ifdef USE_RATE_MIX_SSE2
+	s_kernels[count++] = &s_kernelsSSE2;
+#endif
+
+#ifdef USE_RATE_MIX_AVX2
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		s_kernels[count++] = &s_kernelsAVX2;
+#endif
+
+#ifdef USE_RATE_MIX_NEON
+	s_kernels[count++] = &s_kernelsNEON;
+#endif
+
+	// Concurrent callers all arrive at the same result
+	Common::atomicStore(&s_kernelsCount, count);
+}
+
+uint getRateMixKernelsCount() {
+	initRateMixKernels();
+	return s_kernelsCount;
+}
+
+const RateMixKernels &getRateMixKernels(uint index) {
+	initRateMixKernels();
+	assert(index < (uint)s_kernelsCount);
+	return *s_kernels[index];
+}
+
+const RateMixKernels &getBestRateMixKernels() {
+	initRateMixKernels();
+	return *s_kernels[s_kernelsCount - 1];
+}
+
+} // End of namespace Audio
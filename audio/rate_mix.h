@@ -0,0 +1,118 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_RATE_MIX_H
+#define AUDIO_RATE_MIX_H
+
+#include "audio/rate.h"
+#include "common/frac.h"
+
+namespace Audio {
+
+/**
+ * Mixes converted samples into the output buffer of a rate converter.
+ *
+ * Each sample is multiplied by its channel's volume and divided by
+ * Mixer::kMaxMixerVolume (rounding towards zero), then added to the output
+ * with clampedAdd(). All implementations produce exactly the same output.
+ *
+ * @param obuf       output buffer, holding stereo sample pairs
+ * @param samples    the converted samples
+ * @param numFrames  number of frames (mono samples or stereo pairs) to mix
+ * @param vol_l      volume for the (input) left channel
+ * @param vol_r      volume for the (input) right channel
+ */
+typedef void (*RateMixProc)(st_sample_t *obuf, const st_sample_t *samples, uint numFrames, st_volume_t vol_l, st_volume_t vol_r);
+
+enum {
+	/** Number of fractional positions of a RateFilterProc filter, in bits. */
+	kRateFilterPhaseBits = 8,
+
+	/** Number of fractional bits of RateFilterProc filter coefficients. */
+	kRateFilterCoeffBits = 14
+};
+
+/**
+ * Applies a polyphase filter to the input window of a filtering rate
+ * converter. Output frames are computed for the positions opos,
+ * opos + oposInc, ... before FRAC_ONE, i.e. for all positions up to the next
+ * input sample, but for at most maxFrames frames.
+ *
+ * Each output sample is the dot product of the window with the coefficients
+ * of the phase nearest to its position, divided by 1 << kRateFilterCoeffBits
+ * (rounding to the nearest) and clipped to the sample range. The caller has
+ * to make sure the dot products fit into 32 bits. All implementations
+ * produce exactly the same output.
+ *
+ * @param out        output buffer, receives the samples of all channels interleaved
+ * @param windows    the input window of each channel, numTaps samples each
+ * @param coeffs     the coefficients of the (1 << kRateFilterPhaseBits) + 1
+ *                   phases, numTaps for each one
+ * @param numTaps    filter length, a multiple of 8
+ * @param opos       position of the first output frame, advanced past the last one
+ * @param oposInc    distance between two output frames
+ * @param maxFrames  maximum number of frames to compute
+ * @return the number of frames computed
+ */
+typedef uint (*RateFilterProc)(st_sample_t *out, const st_sample_t *const *windows, const int16 *coeffs, uint numTaps, frac_t &opos, frac_t oposInc, uint maxFrames);
+
+/**
+ * A set of mixing routines, all using the same instruction set.
+ */
+struct RateMixKernels {
+	const char *name;
+
+	/** Mix stereo sample pairs. */
+	RateMixProc mixStereo;
+
+	/** Mix stereo sample pairs, swapping the left and right channel. */
+	RateMixProc mixStereoReversed;
+
+	/** Mix mono samples into both channels. */
+	RateMixProc mixMono;
+
+	/** Filter one window of mono samples. */
+	RateFilterProc filterMono;
+
+	/** Filter one window of stereo samples. */
+	RateFilterProc filterStereo;
+};
+
+/**
+ * Returns the number of kernel sets which can be used on this CPU.
+ */
+uint getRateMixKernelsCount();
+
+/**
+ * Returns one of the kernel sets which can be used on this CPU. Set 0 is
+ * the portable reference implementation, the last set is the fastest one.
+ */
+const RateMixKernels &getRateMixKernels(uint index);
+
+/**
+ * Returns the fastest kernel set which can be used on this CPU.
+ */
+const RateMixKernels &getBestRateMixKernels();
+
+} // End of namespace Audio
+
+#endif
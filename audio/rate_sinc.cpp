@@ -0,0 +1,371 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+#include "audio/rate_mix.h"
+#include "common/frac.h"
+#include "common/list.h"
+#include "common/system.h"
+#include "common/singleton.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+namespace Audio {
+class SincFilterCache;
+}
+
+namespace Common {
+DECLARE_SINGLETON(Audio::SincFilterCache);
+}
+
+namespace Audio {
+
+enum {
+	/** The size of the intermediate input and output buffers. */
+	kSincBufferSize = 512,
+
+	/** Number of fractional positions a filter is precomputed for. */
+	kSincPhaseBits = kRateFilterPhaseBits,
+	kSincPhases = 1 << kSincPhaseBits,
+
+	/**
+	 * Number of zero crossings of the sinc function covered by the filter,
+	 * i.e. the filter length when no downsampling is done.
+	 */
+	kSincZeroCrossings = 32,
+
+	/** Upper limit for the filter length, in samples. */
+	kSincMaxTaps = 64,
+
+	/** Number of fractional bits of the filter coefficients. */
+	kSincCoeffBits = kRateFilterCoeffBits
+};
+
+/** Shape parameter of the Kaiser window applied to the sinc function. */
+static const double kSincKaiserBeta = 7.0;
+
+/**
+ * Cutoff frequency of the filter, relative to the Nyquist frequency of the
+ * lower one of both rates.
+ */
+static const double kSincCutoff = 0.9;
+
+/**
+ * Modified Bessel function of the first kind of order 0, as needed for the
+ * Kaiser window.
+ */
+static double besselI0(double x) {
+	const double y = x * x / 4.0;
+	double sum = 1.0, term = 1.0;
+
+	for (int k = 1; k < 64 && term > sum * 1e-12; k++) {
+		term *= y / ((double)k * k);
+		sum += term;
+	}
+	return sum;
+}
+
+static double sinc(double x) {
+	if (fabs(x) < 1e-9)
+		return 1.0;
+	return sin(M_PI * x) / (M_PI * x);
+}
+
+/**
+ * Windowed sinc filter for converting from one rate to another, precomputed
+ * for kSincPhases + 1 fractional positions between two input samples. The
+ * output sample for a position lies between the input samples
+ * numTaps / 2 - 1 and numTaps / 2 of the filter window.
+ */
+struct SincFilter {
+	st_rate_t inrate;
+	st_rate_t outrate;
+
+	/** filter length, a multiple of 8 samples */
+	uint numTaps;
+
+	/** filter coefficients, numTaps for each of the kSincPhases + 1 positions */
+	int16 *coeffs;
+
+	SincFilter(st_rate_t in, st_rate_t out);
+	~SincFilter() {
+		delete[] coeffs;
+	}
+};
+
+SincFilter::SincFilter(st_rate_t in, st_rate_t out) : inrate(in), outrate(out) {
+	// When downsampling, the cutoff frequency has to be lowered to the new
+	// Nyquist frequency, which widens the filter by the same factor.
+	const double ratio = MIN<double>(1.0, (double)outrate / inrate);
+	numTaps = (uint)ceil(kSincZeroCrossings / ratio);
+	numTaps = MIN<uint>((numTaps + 7) & ~7, kSincMaxTaps);
+
+	coeffs = new int16[(kSincPhases + 1) * numTaps];
+
+	const double cutoff = kSincCutoff * ratio;
+	const double halfLength = numTaps / 2;
+	const double windowScale = 1.0 / besselI0(kSincKaiserBeta);
+	double values[kSincMaxTaps];
+
+	for (int phase = 0; phase <= kSincPhases; phase++) {
+		int16 *phaseCoeffs = coeffs + phase * numTaps;
+		double sum = 0.0;
+
+		for (uint tap = 0; tap < numTaps; tap++) {
+			const double dist = tap - (halfLength - 1.0) - (double)phase / kSincPhases;
+			const double r = dist / halfLength;
+			const double window = (r <= -1.0 || r >= 1.0) ? 0.0 : besselI0(kSincKaiserBeta * sqrt(1.0 - r * r)) * windowScale;
+
+			values[tap] = cutoff * sinc(cutoff * dist) * window;
+			sum += values[tap];
+		}
+
+		// Normalize the filter to unity gain, so a constant signal is passed
+		// through unchanged. The rounding error goes into the biggest tap.
+		const double scale = (1 << kSincCoeffBits) / sum;
+		int total = 0;
+		uint center = 0;
+
+		for (uint tap = 0; tap < numTaps; tap++) {
+			phaseCoeffs[tap] = (int16)floor(values[tap] * scale + 0.5);
+			total += phaseCoeffs[tap];
+			if (values[tap] > values[center])
+				center = tap;
+		}
+		phaseCoeffs[center] += (1 << kSincCoeffBits) - total;
+	}
+}
+
+/**
+ * Keeps the filters of all rate pairs converted so far, so that starting a
+ * channel doesn't have to compute the filter again. Games only use a handful
+ * of different rates, so the filters are kept until the cache is destroyed.
+ *
+ * Like the other singletons, the cache is created on first use, which is
+ * from the engine thread starting a sound. Without an OSystem, as in the
+ * unit tests, there are no other threads and no mutex is used.
+ */
+class SincFilterCache : public Common::Singleton<SincFilterCache> {
+public:
+	~SincFilterCache();
+
+	/** Returns the filter for the given rates, computing it if needed. */
+	const SincFilter *getFilter(st_rate_t inrate, st_rate_t outrate);
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	SincFilterCache() : _mutex(g_system ? g_system->createMutex() : 0) {}
+
+	OSystem::MutexRef _mutex;
+	Common::List<SincFilter *> _filters;
+};
+
+SincFilterCache::~SincFilterCache() {
+	for (Common::List<SincFilter *>::iterator i = _filters.begin(); i != _filters.end(); ++i)
+		delete *i;
+	if (_mutex)
+		g_system->deleteMutex(_mutex);
+}
+
+const SincFilter *SincFilterCache::getFilter(st_rate_t inrate, st_rate_t outrate) {
+	if (_mutex)
+		g_system->lockMutex(_mutex);
+
+	SincFilter *filter = 0;
+	for (Common::List<SincFilter *>::const_iterator i = _filters.begin(); i != _filters.end(); ++i) {
+		if ((*i)->inrate == inrate && (*i)->outrate == outrate) {
+			filter = *i;
+			break;
+		}
+	}
+
+	if (!filter) {
+		filter = new SincFilter(inrate, outrate);
+		_filters.push_back(filter);
+	}
+
+	if (_mutex)
+		g_system->unlockMutex(_mutex);
+	return filter;
+}
+
+/**
+ * Audio rate converter based on band-limited interpolation, using a windowed
+ * sinc filter. The filter is precomputed for a fixed number of fractional
+ * positions between two input samples, so computing an output sample only
+ * takes a single dot product per channel. The output samples between two
+ * input samples are all computed by a single call of the filter kernel.
+ *
+ * Compared to the LinearRateConverter this greatly reduces aliasing and
+ * imaging artifacts, at the cost of some more CPU time and a latency of half
+ * the filter length.
+ *
+ * Limited to sampling frequency <= 65535 Hz.
+ */
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	st_sample_t inBuf[kSincBufferSize];
+	const st_sample_t *inPtr;
+	int inLen;
+
+	/** fractional position of the output stream in input stream unit */
+	frac_t opos;
+
+	/** fractional position increment in the output stream */
+	frac_t opos_inc;
+
+	/** filter length, a multiple of 8 samples, see SincFilter */
+	uint numTaps;
+
+	/** filter coefficients, owned by the SincFilterCache */
+	const int16 *coeffs;
+
+	/**
+	 * The last numTaps input samples of each channel, stored twice in a row
+	 * so the filter window never wraps around.
+	 */
+	st_sample_t history[2][2 * kSincMaxTaps];
+	uint historyPos;
+
+	/** converted samples, waiting to be mixed into the output */
+	st_sample_t outBuf[kSincBufferSize];
+	RateMixProc mixProc;
+	RateFilterProc filterProc;
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate);
+
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+
+/*
+ * Prepare processing.
+ */
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate) {
+	if (inrate >= 65536 || outrate >= 65536) {
+		error("rate effect can only handle rates < 65536");
+	}
+
+	opos = FRAC_ONE;
+	opos_inc = (inrate << FRAC_BITS) / outrate;
+
+	const SincFilter *sincFilter = SincFilterCache::instance().getFilter(inrate, outrate);
+	numTaps = sincFilter->numTaps;
+	coeffs = sincFilter->coeffs;
+
+	memset(history, 0, sizeof(history));
+	historyPos = 0;
+
+	inLen = 0;
+
+	const RateMixKernels &kernels = getBestRateMixKernels();
+	if (!stereo)
+		mixProc = kernels.mixMono;
+	else
+		mixProc = reverseStereo ? kernels.mixStereoReversed : kernels.mixStereo;
+	filterProc = stereo ? kernels.filterStereo : kernels.filterMono;
+}
+
+/*
+ * Processed signed long samples from ibuf to obuf.
+ * Return number of sample pairs processed.
+ */
+template<bool stereo, bool reverseStereo>
+int SincRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	assert(input.isStereo() == stereo);
+
+	st_sample_t *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	while (obuf < oend) {
+		// Convert as many samples as fit into the intermediate buffer
+		const st_size_t maxFrames = MIN<st_size_t>((oend - obuf) / 2, ARRAYSIZE(outBuf) / (stereo ? 2 : 1));
+		st_sample_t *out = outBuf;
+		st_size_t frames = 0;
+		bool endOfInput = false;
+
+		while (frames < maxFrames) {
+			// Shift input samples into the filter window until opos < 1
+			while ((frac_t)FRAC_ONE <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				history[0][historyPos] = history[0][historyPos + numTaps] = *inPtr++;
+				if (stereo)
+					history[1][historyPos] = history[1][historyPos + numTaps] = *inPtr++;
+				if (++historyPos == numTaps)
+					historyPos = 0;
+				opos -= FRAC_ONE;
+			}
+
+			if (endOfInput)
+				break;
+
+			// Filter as long as the outpos trails behind, and as long as there
+			// is still space in the intermediate buffer.
+			const st_sample_t *const windows[2] = { history[0] + historyPos, history[1] + historyPos };
+			const uint filtered = filterProc(out, windows, coeffs, numTaps, opos, opos_inc, maxFrames - frames);
+			out += filtered * (stereo ? 2 : 1);
+			frames += filtered;
+		}
+
+		// Mix the converted samples into the output buffer
+		mixProc(obuf, outBuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
+
+		if (endOfInput)
+			break;
+	}
+	return (obuf - ostart) / 2;
+}
+
+
+#pragma mark -
+
+
+RateConverter *makeSincRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+	if (stereo) {
+		if (reverseStereo)
+			return new SincRateConverter<true, true>(inrate, outrate);
+		else
+			return new SincRateConverter<true, false>(inrate, outrate);
+	} else
+		return new SincRateConverter<false, false>(inrate, outrate);
+}
+
+} // End of namespace Audio
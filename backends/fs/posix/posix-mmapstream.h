@@ -0,0 +1,57 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef BACKENDS_FS_POSIX_MMAPSTREAM_H
+#define BACKENDS_FS_POSIX_MMAPSTREAM_H
+
+#include "common/scummsys.h"
+#include "common/memstream.h"
+#include "common/noncopyable.h"
+#include "common/str.h"
+
+/**
+ * Read stream for a file which is mapped into memory with mmap().
+ *
+ * Reads are served directly from the mapping without any system calls, and
+ * getBackingPointer() gives client code zero-copy access to the complete file.
+ */
+class PosixMmapStream : public Common::MemoryReadStream, public Common::NonCopyable {
+protected:
+	void *_mapping;
+	size_t _mappingSize;
+
+	PosixMmapStream(void *mapping, size_t mappingSize);
+
+public:
+	/**
+	 * Given a path, maps the whole file into memory and wraps the mapping
+	 * in a PosixMmapStream instance. Returns 0 if the file could not be
+	 * mapped, in which case the caller should fall back to a regular
+	 * file stream.
+	 */
+	static PosixMmapStream *makeFromPath(const Common::String &path);
+
+	virtual ~PosixMmapStream();
+};
+
+#endif
@@ -0,0 +1,193 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+// Disable symbol overrides so that we can use system headers.
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#if defined(WIN32) && !defined(_WIN32_WCE)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#undef ARRAYSIZE // winnt.h defines ARRAYSIZE, but we want our own one...
+#elif defined(POSIX)
+#include <sys/time.h>
+#endif
+
+#include "backends/graphics/frameprofiler.h"
+
+#include "common/config-manager.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+static const char *const s_stageNames[FrameProfiler::kStageCount] = {
+	"copyrect",
+	"scale",
+	"cursor",
+	"update"
+};
+
+FrameProfiler::FrameProfiler()
+	: _historyPos(0), _historyCount(0), _frameCount(0), _showOnOSD(false) {
+	memset(&_current, 0, sizeof(_current));
+	memset(_stageStart, 0, sizeof(_stageStart));
+	memset(_history, 0, sizeof(_history));
+	_frameStart = getMicroseconds();
+}
+
+FrameProfiler::~FrameProfiler() {
+	if (_csv.isOpen()) {
+		_csv.flush();
+		_csv.close();
+	}
+}
+
+FrameProfiler *FrameProfiler::createFromConfig() {
+	const bool showOnOSD = ConfMan.hasKey("frame_profile") && ConfMan.getBool("frame_profile");
+	const Common::String csvFile = ConfMan.hasKey("frame_profile_csv") ? ConfMan.get("frame_profile_csv") : Common::String();
+
+	if (!showOnOSD && csvFile.empty())
+		return 0;
+
+	FrameProfiler *profiler = new FrameProfiler();
+	profiler->setShowOnOSD(showOnOSD);
+	if (!csvFile.empty() && !profiler->openCSV(csvFile))
+		warning("Could not open frame profile file '%s'", csvFile.c_str());
+
+	return profiler;
+}
+
+bool FrameProfiler::openCSV(const Common::String &filename) {
+	if (!_csv.open(filename))
+		return false;
+
+	Common::String header = "frame,frame_us,engine_us";
+	for (int i = 0; i < kStageCount; ++i)
+		header += Common::String::format(",%s_us", s_stageNames[i]);
+	header += ",dirty_pixels\n";
+
+	_csv.writeString(header);
+	return true;
+}
+
+uint64 FrameProfiler::getMicroseconds() {
+#if defined(WIN32) && !defined(_WIN32_WCE)
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (uint64)counter.QuadPart * 1000000 / (uint64)frequency.QuadPart;
+#elif defined(POSIX)
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return (uint64)tv.tv_sec * 1000000 + tv.tv_usec;
+#else
+	return (uint64)g_system->getMillis() * 1000;
+#endif
+}
+
+void FrameProfiler::beginStage(Stage stage) {
+	_stageStart[stage] = getMicroseconds();
+}
+
+void FrameProfiler::endStage(Stage stage) {
+	// Stages may run several times per frame, e.g. copyRectToScreen()
+	_current.stageTime[stage] += (uint32)(getMicroseconds() - _stageStart[stage]);
+}
+
+bool FrameProfiler::endFrame() {
+	const uint64 now = getMicroseconds();
+	_current.frameTime = (uint32)(now - _frameStart);
+	_frameStart = now;
+
+	uint32 stageTotal = 0;
+	for (int i = 0; i < kStageCount; ++i)
+		stageTotal += _current.stageTime[i];
+	_current.engineTime = (_current.frameTime > stageTotal) ? _current.frameTime - stageTotal : 0;
+
+	if (_csv.isOpen())
+		writeCSV(_current);
+
+	_history[_historyPos] = _current;
+	_historyPos = (_historyPos + 1) % kHistorySize;
+	if (_historyCount < kHistorySize)
+		++_historyCount;
+
+	memset(&_current, 0, sizeof(_current));
+	return (++_frameCount % kHistorySize) == 0;
+}
+
+void FrameProfiler::writeCSV(const Frame &frame) {
+	Common::String line = Common::String::format("%u,%u,%u", _frameCount, frame.frameTime, frame.engineTime);
+	for (int i = 0; i < kStageCount; ++i)
+		line += Common::String::format(",%u", frame.stageTime[i]);
+	line += Common::String::format(",%u\n", frame.dirtyPixels);
+
+	_csv.writeString(line);
+}
+
+Common::String FrameProfiler::getSummary() const {
+	if (!_historyCount)
+		return Common::String();
+
+	// Upper limits of the histogram buckets in milliseconds, the last bucket
+	// takes all slower frames
+	static const uint32 bucketLimits[] = { 8, 17, 33, 50 };
+	uint bucketCounts[ARRAYSIZE(bucketLimits) + 1] = { 0 };
+
+	uint64 frameTotal = 0, engineTotal = 0, dirtyTotal = 0;
+	uint64 stageTotal[kStageCount] = { 0 };
+	uint32 frameMax = 0;
+
+	for (uint i = 0; i < _historyCount; ++i) {
+		const Frame &frame = _history[i];
+
+		frameTotal += frame.frameTime;
+		engineTotal += frame.engineTime;
+		dirtyTotal += frame.dirtyPixels;
+		for (int j = 0; j < kStageCount; ++j)
+			stageTotal[j] += frame.stageTime[j];
+		frameMax = MAX(frameMax, frame.frameTime);
+
+		uint bucket = 0;
+		while (bucket < ARRAYSIZE(bucketLimits) && frame.frameTime >= bucketLimits[bucket] * 1000)
+			++bucket;
+		++bucketCounts[bucket];
+	}
+
+	// Times are shown in tenths of milliseconds
+	Common::String summary = Common::String::format("%u frames: avg %u.%u ms, max %u.%u ms\n",
+		_historyCount,
+		(uint)(frameTotal / _historyCount / 1000), (uint)(frameTotal / _historyCount / 100 % 10),
+		frameMax / 1000, frameMax / 100 % 10);
+
+	for (uint i = 0; i < ARRAYSIZE(bucketCounts); ++i) {
+		if (i < ARRAYSIZE(bucketLimits))
+			summary += Common::String::format("<%ums: %u  ", bucketLimits[i], bucketCounts[i]);
+		else
+			summary += Common::String::format(">=%ums: %u\n", bucketLimits[i - 1], bucketCounts[i]);
+	}
+
+	summary += Common::String::format("ms per frame: engine %u.%u", (uint)(engineTotal / _historyCount / 1000), (uint)(engineTotal / _historyCount / 100 % 10));
+	for (int i = 0; i < kStageCount; ++i)
+		summary += Common::String::format("  %s %u.%u", s_stageNames[i], (uint)(stageTotal[i] / _historyCount / 1000), (uint)(stageTotal[i] / _historyCount / 100 % 10));
+
+	summary += Common::String::format("\n%u dirty pixels per frame", (uint)(dirtyTotal / _historyCount));
+	return summary;
+}
@@ -0,0 +1,123 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#ifndef BACKENDS_GRAPHICS_FRAMEPROFILER_H
+#define BACKENDS_GRAPHICS_FRAMEPROFILER_H
+
+#include "common/scummsys.h"
+#include "common/file.h"
+#include "common/str.h"
+
+/**
+ * Measures where the time of each frame goes, for graphics managers.
+ *
+ * The graphics manager brackets the stages of its screen update with
+ * beginStage() and endStage(), and calls endFrame() once the frame has been
+ * presented. The time between two frames which is not spent in any stage
+ * is accounted to the engine. The last kHistorySize frames are kept for a
+ * summary, and every frame can be written to a CSV file.
+ *
+ * The profiler is enabled with the "frame_profile" (summary on the OSD) and
+ * "frame_profile_csv" (CSV file name) config keys, see createFromConfig().
+ */
+class FrameProfiler {
+public:
+	enum Stage {
+		/** Copying game graphics to the screen, i.e. copyRectToScreen() */
+		kStageCopyRect,
+		/** Scaling the dirty parts of the screen, or drawing the textures */
+		kStageScale,
+		/** Drawing the mouse cursor */
+		kStageCursor,
+		/** Presenting the frame, e.g. SDL_UpdateRects() */
+		kStageUpdate,
+		kStageCount
+	};
+
+	enum {
+		/** Number of frames kept for the summary */
+		kHistorySize = 256
+	};
+
+	FrameProfiler();
+	~FrameProfiler();
+
+	/**
+	 * Create a profiler when enabled in the config, or return 0. Use
+	 * showOnOSD() to check whether the summary should be shown.
+	 */
+	static FrameProfiler *createFromConfig();
+
+	/** Write one line per frame to the given file. */
+	bool openCSV(const Common::String &filename);
+
+	void setShowOnOSD(bool show) { _showOnOSD = show; }
+	bool showOnOSD() const { return _showOnOSD; }
+
+	void beginStage(Stage stage);
+	void endStage(Stage stage);
+
+	/** Count pixels which had to be redrawn in the current frame. */
+	void addDirtyPixels(uint32 pixels) { _current.dirtyPixels += pixels; }
+
+	/**
+	 * Finish the current frame.
+	 *
+	 * @return true every kHistorySize frames, i.e. when a new summary
+	 *         should be shown
+	 */
+	bool endFrame();
+
+	/**
+	 * Describe the frames in the history: average and maximum frame time,
+	 * a histogram of the frame times, the average time of every stage and
+	 * the average number of dirty pixels.
+	 */
+	Common::String getSummary() const;
+
+private:
+	struct Frame {
+		/** Time between the end of the last and the end of this frame */
+		uint32 frameTime;
+		uint32 engineTime;
+		uint32 stageTime[kStageCount];
+		uint32 dirtyPixels;
+	};
+
+	/** Return a time stamp in microseconds. */
+	static uint64 getMicroseconds();
+
+	void writeCSV(const Frame &frame);
+
+	Frame _current;
+	uint64 _stageStart[kStageCount];
+	uint64 _frameStart;
+
+	Frame _history[kHistorySize];
+	uint _historyPos;
+	uint _historyCount;
+	uint32 _frameCount;
+
+	bool _showOnOSD;
+	Common::DumpFile _csv;
+};
+
+#endif
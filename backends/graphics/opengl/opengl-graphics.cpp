@@ -25,6 +25,7 @@
 #include "backends/graphics/opengl/texture.h"
 #include "backends/graphics/opengl/debug.h"
 #include "backends/graphics/opengl/extensions.h"
+#include "backends/graphics/frameprofiler.h"
 
 #include "common/textconsole.h"
 #include "common/translation.h"
@@ -51,12 +52,14 @@ OpenGLGraphicsManager::OpenGLGraphicsManager()
       _overlayVisible(false), _cursor(nullptr),
       _cursorX(0), _cursorY(0), _cursorHotspotX(0), _cursorHotspotY(0), _cursorHotspotXScaled(0),
       _cursorHotspotYScaled(0), _cursorWidthScaled(0), _cursorHeightScaled(0), _cursorKeyColor(0),
-      _cursorVisible(false), _cursorDontScale(false), _cursorPaletteEnabled(false)
+      _cursorVisible(false), _cursorDontScale(false), _cursorPaletteEnabled(false),
+      _profiler(nullptr)
 #ifdef USE_OSD
       , _osdAlpha(0), _osdFadeStartTime(0), _osd(nullptr)
 #endif
     {
 	memset(_gamePalette, 0, sizeof(_gamePalette));
+	_profiler = FrameProfiler::createFromConfig();
 }
 
 OpenGLGraphicsManager::~OpenGLGraphicsManager() {
@@ -66,6 +69,7 @@ OpenGLGraphicsManager::~OpenGLGraphicsManager() {
 #ifdef USE_OSD
 	delete _osd;
 #endif
+	delete _profiler;
 }
 
 bool OpenGLGraphicsManager::hasFeature(OSystem::Feature f) {
@@ -330,7 +334,13 @@ int16 OpenGLGraphicsManager::getHeight() {
 }
 
 void OpenGLGraphicsManager::copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {
+	if (_profiler)
+		_profiler->beginStage(FrameProfiler::kStageCopyRect);
+
 	_gameScreen->copyRectToTexture(x, y, w, h, buf, pitch);
+
+	if (_profiler)
+		_profiler->endStage(FrameProfiler::kStageCopyRect);
 }
 
 void OpenGLGraphicsManager::fillScreen(uint32 col) {
@@ -351,6 +361,17 @@ void OpenGLGraphicsManager::updateScreen() {
 		return;
 	}
 
+	if (_profiler) {
+		const Common::Rect dirtyArea = _gameScreen->getDirtyArea();
+		_profiler->addDirtyPixels(dirtyArea.width() * dirtyArea.height());
+		if (_overlayVisible) {
+			const Common::Rect overlayDirtyArea = _overlay->getDirtyArea();
+			_profiler->addDirtyPixels(overlayDirtyArea.width() * overlayDirtyArea.height());
+		}
+
+		_profiler->beginStage(FrameProfiler::kStageScale);
+	}
+
 	// Clear the screen buffer
 	GLCALL(glClear(GL_COLOR_BUFFER_BIT));
 
@@ -364,6 +385,11 @@ void OpenGLGraphicsManager::updateScreen() {
 		_overlay->draw(0, 0, _outputScreenWidth, _outputScreenHeight);
 	}
 
+	if (_profiler) {
+		_profiler->endStage(FrameProfiler::kStageScale);
+		_profiler->beginStage(FrameProfiler::kStageCursor);
+	}
+
 	// Third step: Draw the cursor if visible.
 	if (_cursorVisible && _cursor) {
 		// Adjust game screen shake position, but only when the overlay is not
@@ -374,6 +400,9 @@ void OpenGLGraphicsManager::updateScreen() {
 		              _cursorWidthScaled, _cursorHeightScaled);
 	}
 
+	if (_profiler)
+		_profiler->endStage(FrameProfiler::kStageCursor);
+
 #ifdef USE_OSD
 	// Fourth step: Draw the OSD.
 	if (_osdAlpha > 0) {
@@ -29,6 +29,8 @@
 #include "common/frac.h"
 #include "common/mutex.h"
 
+class FrameProfiler;
+
 namespace Graphics {
 class Font;
 } // End of namespace Graphics
@@ -170,6 +172,13 @@ protected:
 	 */
 	virtual void setInternalMousePosition(int x, int y) = 0;
 
+	/**
+	 * Frame time statistics, or nullptr when not enabled. updateScreen()
+	 * times the drawing stages, the sub-class presenting the frame is
+	 * responsible for timing that and calling FrameProfiler::endFrame().
+	 */
+	FrameProfiler *_profiler;
+
 private:
 	/**
 	 * Create a texture with the specified pixel format.
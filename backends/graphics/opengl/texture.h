@@ -84,6 +84,11 @@ public:
 	void flagDirty() { _allDirty = true; }
 	bool isDirty() const { return _allDirty || !_dirtyArea.isEmpty(); }
 
+	/**
+	 * @return The area which will be uploaded on the next draw.
+	 */
+	Common::Rect getDirtyArea() const;
+
 	uint getWidth() const { return _userPixelData.w; }
 	uint getHeight() const { return _userPixelData.h; }
 
@@ -123,7 +128,6 @@ public:
 protected:
 	virtual void updateTexture();
 
-	Common::Rect getDirtyArea() const;
 private:
 	const GLenum _glIntFormat;
 	const GLenum _glFormat;
@@ -21,6 +21,7 @@
  */
 
 #include "backends/graphics/openglsdl/openglsdl-graphics.h"
+#include "backends/graphics/frameprofiler.h"
 
 #include "common/textconsole.h"
 #include "common/config-manager.h"
@@ -201,7 +202,15 @@ void OpenGLSdlGraphicsManager::updateScreen() {
 	OpenGLGraphicsManager::updateScreen();
 
 	// Swap OpenGL buffers
+	if (_profiler)
+		_profiler->beginStage(FrameProfiler::kStageUpdate);
 	SDL_GL_SwapBuffers();
+	if (_profiler) {
+		_profiler->endStage(FrameProfiler::kStageUpdate);
+
+		if (_profiler->endFrame() && _profiler->showOnOSD())
+			displayMessageOnOSD(_profiler->getSummary().c_str());
+	}
 }
 
 void OpenGLSdlGraphicsManager::notifyVideoExpose() {
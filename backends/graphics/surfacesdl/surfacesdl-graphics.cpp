@@ -25,6 +25,8 @@
 #if defined(SDL_BACKEND)
 
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
+#include "backends/graphics/frameprofiler.h"
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/platform/sdl/sdl.h"
 #include "common/config-manager.h"
@@ -129,7 +131,9 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #endif
 	_overlayVisible(false),
 	_overlayscreen(0), _tmpscreen2(0),
-	_scalerProc(0), _screenChangeCount(0),
+	_scalerProc(0), _scalerProc32(0), _scalerProcReentrant(true), _scalerPool(0), _profiler(0), _screenChangeCount(0),
+	_dirtyRegion(NUM_DIRTY_RECT - 1, DIRTY_RECT_MAX_WASTE), _numDirtyRects(0),
+	_numFullUpdates(0), _dirtyStatsFullUpdates(0),
 	_mouseVisible(false), _mouseNeedsRedraw(false), _mouseData(0), _mouseSurface(0),
 	_mouseOrigSurface(0), _cursorDontScale(false), _cursorPaletteDisabled(true),
 	_currentShakePos(0), _newShakePos(0),
@@ -149,6 +153,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_mouseBackup.x = _mouseBackup.y = _mouseBackup.w = _mouseBackup.h = 0;
 
 	memset(&_mouseCurState, 0, sizeof(_mouseCurState));
+	memset(&_dirtyStats, 0, sizeof(_dirtyStats));
 
 	_graphicsMutex = g_system->createMutex();
 
@@ -157,6 +162,11 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 		_enableFocusRectDebugCode = ConfMan.getBool("use_sdl_debug_focusrect");
 #endif
 
+	if (ConfMan.hasKey("scaler_threads") && ConfMan.getInt("scaler_threads") > 0)
+		_scalerPool = new SdlScalerPool(ConfMan.getInt("scaler_threads"));
+
+	_profiler = FrameProfiler::createFromConfig();
+
 	memset(&_oldVideoMode, 0, sizeof(_oldVideoMode));
 	memset(&_videoMode, 0, sizeof(_videoMode));
 	memset(&_transactionDetails, 0, sizeof(_transactionDetails));
@@ -167,11 +177,13 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_videoMode.aspectRatioCorrection = ConfMan.getBool("aspect_ratio");
 	_videoMode.desiredAspectRatio = getDesiredAspectRatio();
 	_scalerProc = Normal2x;
+	_scalerProc32 = Normal2x_32;
 #else // for small screen platforms
 	_videoMode.mode = GFX_NORMAL;
 	_videoMode.scaleFactor = 1;
 	_videoMode.aspectRatioCorrection = false;
 	_scalerProc = Normal1x;
+	_scalerProc32 = Normal1x_32;
 #endif
 	_scalerType = 0;
 
@@ -183,6 +195,8 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 }
 
 SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
+	delete _scalerPool;
+	delete _profiler;
 	unloadGFXMode();
 	if (_mouseSurface)
 		SDL_FreeSurface(_mouseSurface);
@@ -557,47 +571,69 @@ bool SurfaceSdlGraphicsManager::setGraphicsMode(int mode) {
 void SurfaceSdlGraphicsManager::setGraphicsModeIntern() {
 	Common::StackLock lock(_graphicsMutex);
 	ScalerProc *newScalerProc = 0;
+	ScalerProc *newScalerProc32 = 0;
+	bool newScalerProcReentrant = true;
 
 	switch (_videoMode.mode) {
 	case GFX_NORMAL:
 		newScalerProc = Normal1x;
+		newScalerProc32 = Normal1x_32;
 		break;
 #ifdef USE_SCALERS
 	case GFX_DOUBLESIZE:
 		newScalerProc = Normal2x;
+		newScalerProc32 = Normal2x_32;
 		break;
 	case GFX_TRIPLESIZE:
 		newScalerProc = Normal3x;
+		newScalerProc32 = Normal3x_32;
 		break;
 
 	case GFX_2XSAI:
 		newScalerProc = _2xSaI;
+		newScalerProc32 = _2xSaI_32;
 		break;
 	case GFX_SUPER2XSAI:
 		newScalerProc = Super2xSaI;
+		newScalerProc32 = Super2xSaI_32;
 		break;
 	case GFX_SUPEREAGLE:
 		newScalerProc = SuperEagle;
+		newScalerProc32 = SuperEagle_32;
 		break;
 	case GFX_ADVMAME2X:
 		newScalerProc = AdvMame2x;
+		newScalerProc32 = AdvMame2x_32;
 		break;
 	case GFX_ADVMAME3X:
 		newScalerProc = AdvMame3x;
+		newScalerProc32 = AdvMame3x_32;
 		break;
 #ifdef USE_HQ_SCALERS
 	case GFX_HQ2X:
 		newScalerProc = HQ2x;
+		newScalerProc32 = HQ2x_32;
+#ifdef USE_NASM
+		// The assembly version keeps its loop state in globals
+		newScalerProcReentrant = false;
+#endif
 		break;
 	case GFX_HQ3X:
 		newScalerProc = HQ3x;
+		newScalerProc32 = HQ3x_32;
+#ifdef USE_NASM
+		// The assembly version keeps its loop state in globals
+		newScalerProcReentrant = false;
+#endif
 		break;
 #endif
 	case GFX_TV2X:
 		newScalerProc = TV2x;
+		newScalerProc32 = TV2x_32;
 		break;
 	case GFX_DOTMATRIX:
 		newScalerProc = DotMatrix;
+		newScalerProc32 = DotMatrix_32;
 		break;
 #endif // USE_SCALERS
 
@@ -606,6 +642,8 @@ void SurfaceSdlGraphicsManager::setGraphicsModeIntern() {
 	}
 
 	_scalerProc = newScalerProc;
+	_scalerProc32 = newScalerProc32;
+	_scalerProcReentrant = newScalerProcReentrant;
 
 	if (_videoMode.mode != GFX_NORMAL) {
 		for (int i = 0; i < ARRAYSIZE(s_gfxModeSwitchTable); i++) {
@@ -759,7 +797,8 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	SDL_SetColors(_screen, _currentPalette, 0, 256);
 
 	//
-	// Create the surface that contains the scaled graphics in 16 bit mode
+	// Create the surface that contains the scaled graphics in 16 bit mode,
+	// or in 32 bit mode for games using a 32 bit screen format
 	//
 
 	if (_videoMode.fullscreen) {
@@ -775,9 +814,27 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	} else
 #endif
 		{
-		_hwscreen = SDL_SetVideoMode(_videoMode.hardwareWidth, _videoMode.hardwareHeight, 16,
+		int hwBitsPerPixel = 16;
+
+		// The DINGUX, GPH and Linuxmoto backends use their own 16 bit only
+		// update code, so only allow a 32 bit screen on the other platforms.
+#if defined(USE_RGB_COLOR) && !defined(DINGUX) && !defined(GPH_DEVICE) && !defined(LINUXMOTO)
+		if (_screenFormat.bytesPerPixel == 4)
+			hwBitsPerPixel = 32;
+#endif
+
+		_hwscreen = SDL_SetVideoMode(_videoMode.hardwareWidth, _videoMode.hardwareHeight, hwBitsPerPixel,
 			_videoMode.fullscreen ? (SDL_FULLSCREEN|SDL_SWSURFACE) : SDL_SWSURFACE
 			);
+
+		// The 32 bit scalers expect 8 bits per channel with the top byte
+		// unused. Fall back to 16 bit for any other layout.
+		if (_hwscreen && _hwscreen->format->BitsPerPixel == 32 &&
+			(_hwscreen->format->Gmask != 0xFF00 || (_hwscreen->format->Rmask | _hwscreen->format->Bmask) != 0xFF00FF)) {
+			_hwscreen = SDL_SetVideoMode(_videoMode.hardwareWidth, _videoMode.hardwareHeight, 16,
+				_videoMode.fullscreen ? (SDL_FULLSCREEN|SDL_SWSURFACE) : SDL_SWSURFACE
+				);
+		}
 	}
 
 #ifdef USE_RGB_COLOR
@@ -797,12 +854,20 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	}
 
 	//
-	// Create the surface used for the graphics in 16 bit before scaling, and also the overlay
+	// Create the surface used for the graphics before scaling, and also the
+	// overlay. The overlay, OSD and mouse cursor always use 16 bit; when the
+	// hardware surface is 32 bit they use RGB565 and SDL converts them while
+	// blitting.
 	//
+	const bool hwscreen32 = (_hwscreen->format->BytesPerPixel == 4);
+	const uint32 rMask16 = hwscreen32 ? 0xF800 : _hwscreen->format->Rmask;
+	const uint32 gMask16 = hwscreen32 ? 0x07E0 : _hwscreen->format->Gmask;
+	const uint32 bMask16 = hwscreen32 ? 0x001F : _hwscreen->format->Bmask;
+	const uint32 aMask16 = hwscreen32 ? 0 : _hwscreen->format->Amask;
 
 	// Need some extra bytes around when using 2xSaI
 	_tmpscreen = SDL_CreateRGBSurface(SDL_SWSURFACE, _videoMode.screenWidth + 3, _videoMode.screenHeight + 3,
-						16,
+						_hwscreen->format->BitsPerPixel,
 						_hwscreen->format->Rmask,
 						_hwscreen->format->Gmask,
 						_hwscreen->format->Bmask,
@@ -812,11 +877,7 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 		error("allocating _tmpscreen failed");
 
 	_overlayscreen = SDL_CreateRGBSurface(SDL_SWSURFACE, _videoMode.overlayWidth, _videoMode.overlayHeight,
-						16,
-						_hwscreen->format->Rmask,
-						_hwscreen->format->Gmask,
-						_hwscreen->format->Bmask,
-						_hwscreen->format->Amask);
+						16, rMask16, gMask16, bMask16, aMask16);
 
 	if (_overlayscreen == NULL)
 		error("allocating _overlayscreen failed");
@@ -834,7 +895,7 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	_overlayFormat.aShift = _overlayscreen->format->Ashift;
 
 	_tmpscreen2 = SDL_CreateRGBSurface(SDL_SWSURFACE, _videoMode.overlayWidth + 3, _videoMode.overlayHeight + 3,
-						16,
+						_hwscreen->format->BitsPerPixel,
 						_hwscreen->format->Rmask,
 						_hwscreen->format->Gmask,
 						_hwscreen->format->Bmask,
@@ -847,11 +908,7 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 	_osdSurface = SDL_CreateRGBSurface(SDL_SWSURFACE | SDL_RLEACCEL | SDL_SRCCOLORKEY | SDL_SRCALPHA,
 						_hwscreen->w,
 						_hwscreen->h,
-						16,
-						_hwscreen->format->Rmask,
-						_hwscreen->format->Gmask,
-						_hwscreen->format->Bmask,
-						_hwscreen->format->Amask);
+						16, rMask16, gMask16, bMask16, aMask16);
 	if (_osdSurface == NULL)
 		error("allocating _osdSurface failed");
 	SDL_SetColorKey(_osdSurface, SDL_RLEACCEL | SDL_SRCCOLORKEY | SDL_SRCALPHA, kOSDColorKey);
@@ -862,7 +919,7 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 		effectiveScreenHeight() - 1);
 
 	// Distinguish 555 and 565 mode
-	if (_hwscreen->format->Rmask == 0x7C00)
+	if (_overlayscreen->format->Rmask == 0x7C00)
 		InitScalers(555);
 	else
 		InitScalers(565);
@@ -960,16 +1017,27 @@ bool SurfaceSdlGraphicsManager::hotswapGFXMode() {
 void SurfaceSdlGraphicsManager::updateScreen() {
 	assert(_transactionMode == kTransactionNone);
 
-	Common::StackLock lock(_graphicsMutex);	// Lock the mutex until this function ends
+	{
+		Common::StackLock lock(_graphicsMutex);	// Lock the mutex until the screen is updated
 
-	internUpdateScreen();
+		internUpdateScreen();
+	}
+
+	if (_profiler && _profiler->endFrame()) {
+#ifdef USE_OSD
+		if (_profiler->showOnOSD())
+			displayMessageOnOSD(_profiler->getSummary().c_str());
+#endif
+	}
 }
 
 void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	SDL_Surface *srcSurf, *origSurf;
 	int height, width;
 	ScalerProc *scalerProc;
+	bool scalerReentrant;
 	int scale1;
+	const int hwBytesPerPixel = _hwscreen->format->BytesPerPixel;
 
 	// definitions not available for non-DEBUG here. (needed this to compile in SYMBIAN32 & linux?)
 #if defined(DEBUG) && !defined(WIN32) && !defined(_WIN32_WCE)
@@ -1029,14 +1097,16 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		srcSurf = _tmpscreen;
 		width = _videoMode.screenWidth;
 		height = _videoMode.screenHeight;
-		scalerProc = _scalerProc;
+		scalerProc = hwBytesPerPixel == 4 ? _scalerProc32 : _scalerProc;
+		scalerReentrant = hwBytesPerPixel == 4 || _scalerProcReentrant;
 		scale1 = _videoMode.scaleFactor;
 	} else {
 		origSurf = _overlayscreen;
 		srcSurf = _tmpscreen2;
 		width = _videoMode.overlayWidth;
 		height = _videoMode.overlayHeight;
-		scalerProc = Normal1x;
+		scalerProc = hwBytesPerPixel == 4 ? Normal1x_32 : Normal1x;
+		scalerReentrant = true;
 
 		scale1 = 1;
 	}
@@ -1046,6 +1116,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	if (_mouseNeedsRedraw)
 		undrawMouse();
 
+	flushDirtyRegion();
+
 	// Force a full redraw if requested
 	if (_forceFull) {
 		_numDirtyRects = 1;
@@ -1062,6 +1134,12 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		uint32 srcPitch, dstPitch;
 		SDL_Rect *lastRect = _dirtyRectList + _numDirtyRects;
 
+		if (_profiler) {
+			_profiler->beginStage(FrameProfiler::kStageScale);
+			for (r = _dirtyRectList; r != lastRect; ++r)
+				_profiler->addDirtyPixels(r->w * r->h);
+		}
+
 		for (r = _dirtyRectList; r != lastRect; ++r) {
 			dst = *r;
 			dst.x++;	// Shift rect by one since 2xSai needs to access the data around
@@ -1099,8 +1177,12 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				const byte *srcPtr = (const byte *)srcSurf->pixels + (r->x + 1) * hwBytesPerPixel + (r->y + 1) * srcPitch;
+				byte *dstPtr = (byte *)_hwscreen->pixels + rx1 * hwBytesPerPixel + dst_y * dstPitch;
+				if (_scalerPool && scalerReentrant)
+					_scalerPool->scale(scalerProc, srcPtr, srcPitch, dstPtr, dstPitch, r->w, dst_h, scale1);
+				else
+					scalerProc(srcPtr, srcPitch, dstPtr, dstPitch, r->w, dst_h);
 			}
 
 			r->x = rx1;
@@ -1109,13 +1191,20 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 			r->h = dst_h * scale1;
 
 #ifdef USE_SCALERS
-			if (_videoMode.aspectRatioCorrection && orig_dst_y < height && !_overlayVisible)
-				r->h = stretch200To240((uint8 *) _hwscreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
+			if (_videoMode.aspectRatioCorrection && orig_dst_y < height && !_overlayVisible) {
+				if (hwBytesPerPixel == 4)
+					r->h = stretch200To240_32((uint8 *) _hwscreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
+				else
+					r->h = stretch200To240((uint8 *) _hwscreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
+			}
 #endif
 		}
 		SDL_UnlockSurface(srcSurf);
 		SDL_UnlockSurface(_hwscreen);
 
+		if (_profiler)
+			_profiler->endStage(FrameProfiler::kStageScale);
+
 		// Readjust the dirty rect list in case we are doing a full update.
 		// This is necessary if shaking is active.
 		if (_forceFull) {
@@ -1123,7 +1212,11 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 			_dirtyRectList[0].h = effectiveScreenHeight();
 		}
 
+		if (_profiler)
+			_profiler->beginStage(FrameProfiler::kStageCursor);
 		drawMouse();
+		if (_profiler)
+			_profiler->endStage(FrameProfiler::kStageCursor);
 
 #ifdef USE_OSD
 		if (_osdAlpha != SDL_ALPHA_TRANSPARENT) {
@@ -1205,7 +1298,11 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 
 		// Finally, blit all our changes to the screen
 		if (!_displayDisabled) {
+			if (_profiler)
+				_profiler->beginStage(FrameProfiler::kStageUpdate);
 			SDL_UpdateRects(_hwscreen, _numDirtyRects, _dirtyRectList);
+			if (_profiler)
+				_profiler->endStage(FrameProfiler::kStageUpdate);
 		}
 	}
 
@@ -1256,6 +1353,9 @@ void SurfaceSdlGraphicsManager::copyRectToScreen(const void *buf, int pitch, int
 
 	Common::StackLock lock(_graphicsMutex);	// Lock the mutex until this function ends
 
+	if (_profiler)
+		_profiler->beginStage(FrameProfiler::kStageCopyRect);
+
 	assert(x >= 0 && x < _videoMode.screenWidth);
 	assert(y >= 0 && y < _videoMode.screenHeight);
 	assert(h > 0 && y + h <= _videoMode.screenHeight);
@@ -1295,6 +1395,9 @@ void SurfaceSdlGraphicsManager::copyRectToScreen(const void *buf, int pitch, int
 
 	// Unlock the screen surface
 	SDL_UnlockSurface(_screen);
+
+	if (_profiler)
+		_profiler->endStage(FrameProfiler::kStageCopyRect);
 }
 
 Graphics::Surface *SurfaceSdlGraphicsManager::lockScreen() {
@@ -1350,11 +1453,6 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	if (_forceFull)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
-		_forceFull = true;
-		return;
-	}
-
 	int height, width;
 
 	if (!_overlayVisible && !realCoordinates) {
@@ -1404,16 +1502,75 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 		return;
 	}
 
-	if (w > 0 && h > 0) {
+	if (w <= 0 || h <= 0)
+		return;
+
+	if (realCoordinates) {
+		// The mouse is drawn after the dirty region was flushed, directly
+		// in screen coordinates. The region leaves one entry free for it.
+		if (_numDirtyRects == NUM_DIRTY_RECT) {
+			_forceFull = true;
+			return;
+		}
+
 		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
 
 		r->x = x;
 		r->y = y;
 		r->w = w;
 		r->h = h;
+	} else {
+		_dirtyRegion.addRect(Common::Rect(x, y, x + w, y + h));
 	}
 }
 
+void SurfaceSdlGraphicsManager::flushDirtyRegion() {
+	assert(_dirtyRegion.size() < NUM_DIRTY_RECT);
+
+	_numDirtyRects = _dirtyRegion.size();
+	for (int i = 0; i < _numDirtyRects; ++i) {
+		const Common::Rect &rect = _dirtyRegion[i];
+		SDL_Rect *r = &_dirtyRectList[i];
+
+		r->x = rect.left;
+		r->y = rect.top;
+		r->w = rect.width();
+		r->h = rect.height();
+	}
+
+	_dirtyRegion.clear();
+	if (_forceFull)
+		++_numFullUpdates;
+
+	// Keep the stats of the last complete period around for the OSD
+	if (_dirtyRegion.getStats().frames >= DIRTY_STATS_FRAMES) {
+		_dirtyStats = _dirtyRegion.getStats();
+		_dirtyStatsFullUpdates = _numFullUpdates;
+		_dirtyRegion.resetStats();
+		_numFullUpdates = 0;
+
+		debug(2, "%s", getDirtyRectStats().c_str());
+	}
+}
+
+Common::String SurfaceSdlGraphicsManager::getDirtyRectStats() const {
+	Graphics::DirtyRegion::Stats stats = _dirtyStats;
+	uint32 fullUpdates = _dirtyStatsFullUpdates;
+	if (!stats.frames) {
+		stats = _dirtyRegion.getStats();
+		fullUpdates = _numFullUpdates;
+	}
+
+	const int areaPercent = stats.areaAdded ? (int)(100.0 * stats.areaOutput / stats.areaAdded) : 0;
+
+	return Common::String::format("Dirty rects in %u updates (%u full):\n"
+		"%u added, %u drawn, %d%% of the area\n"
+		"%u merges, %u forced merges",
+		stats.frames, fullUpdates,
+		stats.rectsAdded, stats.rectsOutput, areaPercent,
+		stats.merges, stats.forcedMerges);
+}
+
 int16 SurfaceSdlGraphicsManager::getHeight() {
 	return _videoMode.screenHeight;
 }
@@ -1597,18 +1754,40 @@ void SurfaceSdlGraphicsManager::clearOverlay() {
 	if (SDL_BlitSurface(_screen, &src, _tmpscreen, &dst) != 0)
 		error("SDL_BlitSurface failed: %s", SDL_GetError());
 
-	SDL_LockSurface(_tmpscreen);
-	SDL_LockSurface(_overlayscreen);
-	_scalerProc((byte *)(_tmpscreen->pixels) + _tmpscreen->pitch + 2, _tmpscreen->pitch,
-	(byte *)_overlayscreen->pixels, _overlayscreen->pitch, _videoMode.screenWidth, _videoMode.screenHeight);
+	if (_tmpscreen->format->BytesPerPixel == 4) {
+		// The overlay is 16 bit, so scale into the 32 bit _tmpscreen2 and
+		// let SDL convert the result.
+		SDL_LockSurface(_tmpscreen);
+		SDL_LockSurface(_tmpscreen2);
+		_scalerProc32((byte *)(_tmpscreen->pixels) + _tmpscreen->pitch + 4, _tmpscreen->pitch,
+		(byte *)_tmpscreen2->pixels, _tmpscreen2->pitch, _videoMode.screenWidth, _videoMode.screenHeight);
 
 #ifdef USE_SCALERS
-	if (_videoMode.aspectRatioCorrection)
-		stretch200To240((uint8 *)_overlayscreen->pixels, _overlayscreen->pitch,
-						_videoMode.overlayWidth, _videoMode.screenHeight * _videoMode.scaleFactor, 0, 0, 0);
+		if (_videoMode.aspectRatioCorrection)
+			stretch200To240_32((uint8 *)_tmpscreen2->pixels, _tmpscreen2->pitch,
+							_videoMode.overlayWidth, _videoMode.screenHeight * _videoMode.scaleFactor, 0, 0, 0);
 #endif
-	SDL_UnlockSurface(_tmpscreen);
-	SDL_UnlockSurface(_overlayscreen);
+		SDL_UnlockSurface(_tmpscreen);
+		SDL_UnlockSurface(_tmpscreen2);
+
+		src.w = _videoMode.overlayWidth;
+		src.h = _videoMode.overlayHeight;
+		if (SDL_BlitSurface(_tmpscreen2, &src, _overlayscreen, NULL) != 0)
+			error("SDL_BlitSurface failed: %s", SDL_GetError());
+	} else {
+		SDL_LockSurface(_tmpscreen);
+		SDL_LockSurface(_overlayscreen);
+		_scalerProc((byte *)(_tmpscreen->pixels) + _tmpscreen->pitch + 2, _tmpscreen->pitch,
+		(byte *)_overlayscreen->pixels, _overlayscreen->pitch, _videoMode.screenWidth, _videoMode.screenHeight);
+
+#ifdef USE_SCALERS
+		if (_videoMode.aspectRatioCorrection)
+			stretch200To240((uint8 *)_overlayscreen->pixels, _overlayscreen->pitch,
+							_videoMode.overlayWidth, _videoMode.screenHeight * _videoMode.scaleFactor, 0, 0, 0);
+#endif
+		SDL_UnlockSurface(_tmpscreen);
+		SDL_UnlockSurface(_overlayscreen);
+	}
 
 	_forceFull = true;
 }
@@ -1770,10 +1949,10 @@ void SurfaceSdlGraphicsManager::setMouseCursor(const void *buf, uint w, uint h,
 						_mouseCurState.w + 2,
 						_mouseCurState.h + 2,
 						16,
-						_hwscreen->format->Rmask,
-						_hwscreen->format->Gmask,
-						_hwscreen->format->Bmask,
-						_hwscreen->format->Amask);
+						_overlayscreen->format->Rmask,
+						_overlayscreen->format->Gmask,
+						_overlayscreen->format->Bmask,
+						_overlayscreen->format->Amask);
 
 		if (_mouseOrigSurface == NULL)
 			error("allocating _mouseOrigSurface failed");
@@ -1907,10 +2086,10 @@ void SurfaceSdlGraphicsManager::blitCursor() {
 						_mouseCurState.rW,
 						_mouseCurState.rH,
 						16,
-						_hwscreen->format->Rmask,
-						_hwscreen->format->Gmask,
-						_hwscreen->format->Bmask,
-						_hwscreen->format->Amask);
+						_overlayscreen->format->Rmask,
+						_overlayscreen->format->Gmask,
+						_overlayscreen->format->Bmask,
+						_overlayscreen->format->Amask);
 
 		if (_mouseSurface == NULL)
 			error("allocating _mouseSurface failed");
@@ -2136,6 +2315,14 @@ void SurfaceSdlGraphicsManager::displayMessageOnOSD(const char *msg) {
 
 bool SurfaceSdlGraphicsManager::handleScalerHotkeys(Common::KeyCode key) {
 
+#ifdef USE_OSD
+	// Ctrl-Alt-r shows the dirty rect statistics
+	if (key == 'r') {
+		displayMessageOnOSD(getDirtyRectStats().c_str());
+		return true;
+	}
+#endif
+
 	// Ctrl-Alt-a toggles aspect ratio correction
 	if (key == 'a') {
 		beginGFXTransaction();
@@ -2235,6 +2422,10 @@ bool SurfaceSdlGraphicsManager::isScalerHotkey(const Common::Event &event) {
 			if (keyValue >= ARRAYSIZE(s_gfxModeSwitchTable))
 				return false;
 		}
+#ifdef USE_OSD
+		if (event.kbd.keycode == 'r')
+			return true;
+#endif
 		return (isScaleKey || event.kbd.keycode == 'a');
 	}
 	return false;
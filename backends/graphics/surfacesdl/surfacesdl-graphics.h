@@ -25,6 +25,7 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "graphics/dirtyregion.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "common/events.h"
@@ -60,6 +61,9 @@ enum {
 };
 
 
+class FrameProfiler;
+class SdlScalerPool;
+
 class AspectRatio {
 	int _kw, _kh;
 public:
@@ -229,7 +233,24 @@ protected:
 	bool _forceFull;
 
 	ScalerProc *_scalerProc;
+	/** Variant of _scalerProc used for the game screen when _hwscreen is 32 bit */
+	ScalerProc *_scalerProc32;
+	/**
+	 * False if _scalerProc keeps state in globals and thus must not be run
+	 * on several bands at once. This is the case for the NASM HQ scalers.
+	 */
+	bool _scalerProcReentrant;
 	int _scalerType;
+
+	/**
+	 * Worker threads used to scale large dirty rects in bands, or 0 to scale
+	 * on the calling thread only. See the "scaler_threads" config key.
+	 */
+	SdlScalerPool *_scalerPool;
+
+	/** Frame time statistics, or 0 when not enabled. See FrameProfiler. */
+	FrameProfiler *_profiler;
+
 	int _transactionMode;
 
 	// Indicates whether it is needed to free _hwsurface in destructor
@@ -242,13 +263,26 @@ protected:
 
 	enum {
 		NUM_DIRTY_RECT = 100,
-		MAX_SCALING = 3
+		MAX_SCALING = 3,
+		/** Max. number of clean pixels redrawn to merge two dirty rects */
+		DIRTY_RECT_MAX_WASTE = 256,
+		/** Number of screen updates over which the dirty rect stats are collected */
+		DIRTY_STATS_FRAMES = 300
 	};
 
-	// Dirty rect management
+	// Dirty rect management. Rects are collected in _dirtyRegion, which
+	// merges them, and are copied to _dirtyRectList by flushDirtyRegion()
+	// when the screen is updated.
+	Graphics::DirtyRegion _dirtyRegion;
 	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
 	int _numDirtyRects;
 
+	/** Number of full screen updates since the dirty region stats were reset */
+	uint32 _numFullUpdates;
+	/** Dirty region stats of the last completed sampling period */
+	Graphics::DirtyRegion::Stats _dirtyStats;
+	uint32 _dirtyStatsFullUpdates;
+
 	struct MousePos {
 		// The mouse position, using either virtual (game) or real
 		// (overlay) coordinates.
@@ -332,6 +366,14 @@ protected:
 
 	virtual int effectiveScreenHeight() const;
 
+	/**
+	 * Move the rects of the dirty region to _dirtyRectList. Has to be called
+	 * by internUpdateScreen() once the mouse has been undrawn, before a full
+	 * redraw is set up.
+	 */
+	void flushDirtyRegion();
+	Common::String getDirtyRectStats() const;
+
 	virtual void setGraphicsModeIntern();
 
 	virtual bool handleScalerHotkeys(Common::KeyCode key);
@@ -0,0 +1,148 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+SdlScalerPool::SdlScalerPool(uint numThreads)
+	:
+	_mutex(0), _workCond(0), _doneCond(0), _quit(false),
+	_scalerProc(0), _srcPtr(0), _srcPitch(0), _dstPtr(0), _dstPitch(0),
+	_width(0), _height(0), _scaleFactor(0), _bandHeight(0),
+	_numBands(0), _nextBand(0), _bandsDone(0) {
+
+	_mutex = SDL_CreateMutex();
+	_workCond = SDL_CreateCond();
+	_doneCond = SDL_CreateCond();
+
+	for (uint i = 0; i < numThreads; ++i) {
+		SDL_Thread *thread = SDL_CreateThread(workerThreadEntry, this);
+		if (!thread) {
+			warning("Could not create scaler thread: %s", SDL_GetError());
+			break;
+		}
+		_threads.push_back(thread);
+	}
+}
+
+SdlScalerPool::~SdlScalerPool() {
+	// Tell the threads to quit, and wait for them to actually finish
+	SDL_LockMutex(_mutex);
+	_quit = true;
+	SDL_CondBroadcast(_workCond);
+	SDL_UnlockMutex(_mutex);
+
+	for (uint i = 0; i < _threads.size(); ++i)
+		SDL_WaitThread(_threads[i], NULL);
+
+	SDL_DestroyCond(_doneCond);
+	SDL_DestroyCond(_workCond);
+	SDL_DestroyMutex(_mutex);
+}
+
+void SdlScalerPool::scale(ScalerProc *scalerProc, const uint8 *srcPtr, uint32 srcPitch,
+                          uint8 *dstPtr, uint32 dstPitch, int width, int height, int scaleFactor) {
+	// Use one band per thread, including the calling one, as long as the
+	// bands do not get too small
+	int numBands = MIN<int>(_threads.size() + 1, height / kMinBandHeight);
+	if (numBands <= 1) {
+		scalerProc(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+	// Bands start at even rows, see the class description
+	int bandHeight = (height + numBands - 1) / numBands;
+	bandHeight += bandHeight & 1;
+	numBands = (height + bandHeight - 1) / bandHeight;
+
+	SDL_LockMutex(_mutex);
+	_scalerProc = scalerProc;
+	_srcPtr = srcPtr;
+	_srcPitch = srcPitch;
+	_dstPtr = dstPtr;
+	_dstPitch = dstPitch;
+	_width = width;
+	_height = height;
+	_scaleFactor = scaleFactor;
+	_bandHeight = bandHeight;
+	_numBands = numBands;
+	_nextBand = 0;
+	_bandsDone = 0;
+	SDL_CondBroadcast(_workCond);
+
+	// Help with the bands, then wait for the ones the threads took
+	while (_nextBand < _numBands) {
+		const int band = _nextBand++;
+		SDL_UnlockMutex(_mutex);
+		scaleBand(band);
+		SDL_LockMutex(_mutex);
+		++_bandsDone;
+	}
+
+	while (_bandsDone < _numBands)
+		SDL_CondWait(_doneCond, _mutex);
+
+	_numBands = 0;
+	SDL_UnlockMutex(_mutex);
+}
+
+void SdlScalerPool::scaleBand(int band) {
+	const int y = band * _bandHeight;
+	const int height = MIN(_bandHeight, _height - y);
+
+	_scalerProc(_srcPtr + y * _srcPitch, _srcPitch,
+	            _dstPtr + y * _scaleFactor * _dstPitch, _dstPitch, _width, height);
+}
+
+void SdlScalerPool::workerThread() {
+	SDL_LockMutex(_mutex);
+	while (true) {
+		while (!_quit && _nextBand >= _numBands)
+			SDL_CondWait(_workCond, _mutex);
+
+		if (_quit)
+			break;
+
+		const int band = _nextBand++;
+		SDL_UnlockMutex(_mutex);
+		scaleBand(band);
+		SDL_LockMutex(_mutex);
+
+		if (++_bandsDone == _numBands)
+			SDL_CondSignal(_doneCond);
+	}
+	SDL_UnlockMutex(_mutex);
+}
+
+int SDLCALL SdlScalerPool::workerThreadEntry(void *arg) {
+	SdlScalerPool *pool = (SdlScalerPool *)arg;
+	assert(pool);
+	pool->workerThread();
+	return 0;
+}
+
+#endif
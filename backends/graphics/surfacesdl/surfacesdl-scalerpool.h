@@ -0,0 +1,95 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+#define BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+
+#include "backends/platform/sdl/sdl-sys.h"
+#include "graphics/scaler.h"
+#include "common/array.h"
+
+/**
+ * A small set of persistent worker threads, which scale a rectangle by
+ * splitting it into horizontal bands and scaling them in parallel.
+ *
+ * Every output row only depends on the source rows around it, which the
+ * scalers read from the shared source surface, so each band gets the one
+ * pixel border the HQ and 2xSaI scalers need without any copying. The
+ * bands start at even rows relative to the rectangle, which keeps the
+ * DotMatrix pattern in place. The result is thus the same as when scaling
+ * the whole rectangle in one call.
+ */
+class SdlScalerPool {
+public:
+	/**
+	 * Create a pool with the given number of worker threads. The thread
+	 * calling scale() works on the bands as well.
+	 */
+	SdlScalerPool(uint numThreads);
+	~SdlScalerPool();
+
+	uint getThreadCount() const { return _threads.size(); }
+
+	/**
+	 * Scale a rectangle using all threads. The parameters are the same as
+	 * for ScalerProc, plus the scale factor of the scaler. Returns when the
+	 * whole rectangle has been scaled.
+	 */
+	void scale(ScalerProc *scalerProc, const uint8 *srcPtr, uint32 srcPitch,
+	           uint8 *dstPtr, uint32 dstPitch, int width, int height, int scaleFactor);
+
+private:
+	enum {
+		/** Rectangles with fewer rows per band are not split any further */
+		kMinBandHeight = 16
+	};
+
+	SDL_mutex *_mutex;
+	/** Signalled when new bands are available or the threads should quit */
+	SDL_cond *_workCond;
+	/** Signalled when the last band of the current rectangle is done */
+	SDL_cond *_doneCond;
+	Common::Array<SDL_Thread *> _threads;
+	bool _quit;
+
+	// The rectangle currently being scaled, guarded by _mutex
+	ScalerProc *_scalerProc;
+	const uint8 *_srcPtr;
+	uint32 _srcPitch;
+	uint8 *_dstPtr;
+	uint32 _dstPitch;
+	int _width;
+	int _height;
+	int _scaleFactor;
+	int _bandHeight;
+	int _numBands;
+	int _nextBand;
+	int _bandsDone;
+
+	/** Scale the band with the given index of the current rectangle. */
+	void scaleBand(int band);
+
+	void workerThread();
+	static int SDLCALL workerThreadEntry(void *arg);
+};
+
+#endif
@@ -27,6 +27,7 @@
 
 #include <limits.h>
 
+#include "engines/detectioncache.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
 #include "base/plugins.h"
@@ -68,6 +69,7 @@ static const char HELP_STRING[] =
 	"  -z, --list-games         Display list of supported games and exit\n"
 	"  -t, --list-targets       Display list of configured targets and exit\n"
 	"  --list-saves=TARGET      Display a list of saved games for the game (TARGET) specified\n"
+	"  --clear-detection-cache  Forget the file checksums remembered by game detection\n"
 #if defined(WIN32) && !defined(_WIN32_WCE) && !defined(__SYMBIAN32__)
 	"  --console                Enable the console window (default:enabled)\n"
 #endif
@@ -115,9 +117,12 @@ static const char HELP_STRING[] =
 	"  --enable-gs              Enable Roland GS mode for MIDI playback\n"
 	"  --output-rate=RATE       Select output sample rate in Hz (e.g. 22050)\n"
 	"  --opl-driver=DRIVER      Select AdLib (OPL) emulator (db, mame)\n"
+	"  --resampler=MODE         Select audio resampler (linear, sinc)\n"
 	"  --aspect-ratio           Enable aspect ratio correction\n"
 	"  --render-mode=MODE       Enable additional render modes (cga, ega, hercGreen,\n"
 	"                           hercAmber, amiga)\n"
+	"  --frame-profile          Show frame time statistics on the on-screen display\n"
+	"  --frame-profile-csv=FILE Write the time spent on every frame to FILE\n"
 #ifdef ENABLE_EVENTRECORDER
 	"  --record-mode=MODE       Specify record mode for event recorder (record, playback,\n"
 	"                           passthrough [default])\n"
@@ -194,6 +199,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("native_mt32", false);
 	ConfMan.registerDefault("enable_gs", false);
 	ConfMan.registerDefault("midi_gain", 100);
+	ConfMan.registerDefault("resampler", "linear");
 
 	ConfMan.registerDefault("music_driver", "auto");
 	ConfMan.registerDefault("mt32_device", "null");
@@ -399,6 +405,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			END_COMMAND
 #endif
 
+			DO_LONG_COMMAND("clear-detection-cache")
+			END_COMMAND
+
 			DO_LONG_OPTION("list-saves")
 				// FIXME: Need to document this.
 				// TODO: Make the argument optional. If no argument is given, list all saved games
@@ -444,6 +453,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION("opl-driver")
 			END_OPTION
 
+			DO_LONG_OPTION("resampler")
+			END_OPTION
+
 			DO_OPTION('g', "gfx-mode")
 			END_OPTION
 
@@ -520,6 +532,12 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION_BOOL("aspect-ratio")
 			END_OPTION
 
+			DO_LONG_OPTION_BOOL("frame-profile")
+			END_OPTION
+
+			DO_LONG_OPTION("frame-profile-csv")
+			END_OPTION
+
 			DO_LONG_OPTION("render-mode")
 				int renderMode = Common::parseRenderMode(option);
 				if (renderMode == Common::kRenderDefault)
@@ -656,6 +674,16 @@ static void listTargets() {
 		printf("%s\n", i->c_str());
 }
 
+/** Remove all file checksums remembered by game detection. */
+static void clearDetectionCache() {
+	// The cache is stored through the savefile manager, which the backend
+	// only sets up in initBackend(). Same FIXME HACK as in listSaves().
+	g_system->initBackend();
+
+	DetectionCacheMan.clear();
+	printf("Detection cache cleared\n");
+}
+
 /** List all saves states for the given target. */
 static Common::Error listSaves(const char *target) {
 	Common::Error result = Common::kNoError;
@@ -961,6 +989,9 @@ bool processSettings(Common::String &command, Common::StringMap &settings, Commo
 	} else if (command == "list-themes") {
 		listThemes();
 		return true;
+	} else if (command == "clear-detection-cache") {
+		clearDetectionCache();
+		return true;
 	} else if (command == "list-audio-devices") {
 		listAudioDevices();
 		return true;
@@ -0,0 +1,150 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ *  \file atomic.h
+ *  Minimal set of atomic operations on 32 bit words and pointers.
+ *
+ *  All operations imply a full memory barrier, which is what code sharing
+ *  state between e.g. the audio thread and the engine thread without a
+ *  mutex needs. On compilers without support for atomic builtins, the
+ *  fallback only relies on volatile accesses, which is sufficient for the
+ *  uniprocessor targets using them.
+ */
+
+namespace Common {
+
+#if defined(__GNUC__) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+
+/** Full memory barrier. */
+FORCEINLINE void atomicFence() {
+	__sync_synchronize();
+}
+
+/** Atomically replace the value at p by v, returning the previous value. */
+FORCEINLINE int32 atomicExchange(volatile int32 *p, int32 v) {
+	// __sync_lock_test_and_set is only an acquire barrier
+	__sync_synchronize();
+	return __sync_lock_test_and_set(p, v);
+}
+
+/** Atomically increment the value at p, returning the new value. */
+FORCEINLINE int32 atomicIncrement(volatile int32 *p) {
+	return __sync_add_and_fetch(p, 1);
+}
+
+/** Atomically replace the pointer at p by v, returning the previous pointer. */
+template<class T>
+FORCEINLINE T *atomicExchange(T *volatile *p, T *v) {
+	__sync_synchronize();
+	return __sync_lock_test_and_set(p, v);
+}
+
+#elif defined(_MSC_VER)
+
+FORCEINLINE void atomicFence() {
+	// Any interlocked operation is a full barrier
+	long dummy = 0;
+	_InterlockedExchange(&dummy, 0);
+}
+
+FORCEINLINE int32 atomicExchange(volatile int32 *p, int32 v) {
+	return _InterlockedExchange((volatile long *)p, v);
+}
+
+FORCEINLINE int32 atomicIncrement(volatile int32 *p) {
+	return _InterlockedIncrement((volatile long *)p);
+}
+
+template<class T>
+FORCEINLINE T *atomicExchange(T *volatile *p, T *v) {
+#ifdef _WIN64
+	return (T *)_InterlockedExchange64((volatile __int64 *)p, (__int64)v);
+#else
+	return (T *)_InterlockedExchange((volatile long *)p, (long)v);
+#endif
+}
+
+#else
+
+FORCEINLINE void atomicFence() {
+}
+
+FORCEINLINE int32 atomicExchange(volatile int32 *p, int32 v) {
+	int32 old = *p;
+	*p = v;
+	return old;
+}
+
+FORCEINLINE int32 atomicIncrement(volatile int32 *p) {
+	return ++*p;
+}
+
+template<class T>
+FORCEINLINE T *atomicExchange(T *volatile *p, T *v) {
+	T *old = *p;
+	*p = v;
+	return old;
+}
+
+#endif
+
+/** Read the value at p. Later memory accesses are not moved before it. */
+FORCEINLINE int32 atomicLoad(const volatile int32 *p) {
+	int32 v = *p;
+	atomicFence();
+	return v;
+}
+
+/** Read the pointer at p. Later memory accesses are not moved before it. */
+template<class T>
+FORCEINLINE T *atomicLoad(T *const volatile *p) {
+	T *v = *p;
+	atomicFence();
+	return v;
+}
+
+/** Write v to p. Earlier memory accesses are not moved after it. */
+FORCEINLINE void atomicStore(volatile int32 *p, int32 v) {
+	atomicFence();
+	*p = v;
+}
+
+/** Write the pointer v to p. Earlier memory accesses are not moved after it. */
+template<class T>
+FORCEINLINE void atomicStore(T *volatile *p, T *v) {
+	atomicFence();
+	*p = v;
+}
+
+} // End of namespace Common
+
+#endif
@@ -141,6 +141,12 @@ uint32 File::read(void *ptr, uint32 len) {
 	return _handle->read(ptr, len);
 }
 
+const byte *File::getBackingPointer() const {
+	if (!_handle)
+		return 0;
+	return _handle->getBackingPointer();
+}
+
 
 DumpFile::DumpFile() : _handle(0) {
 }
@@ -206,6 +206,15 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Returns the time the object referred by this node was last modified,
+	 * in seconds since a backend specific epoch. This is only meant for
+	 * noticing that a file changed, by comparing it with a previous value.
+	 *
+	 * @return the modification time, or 0 if the backend can't tell
+	 */
+	uint32 getModificationTime() const;
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -215,6 +224,20 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStream() const;
 
+	/**
+	 * Creates a SeekableReadStream instance corresponding to the file
+	 * referred by this node, like createReadStream(). Where the backend
+	 * supports it, the file is mapped into memory, so that its whole
+	 * contents are available through getBackingPointer().
+	 *
+	 * Only use this for game data which does not change while it is open.
+	 * Depending on the system, a mapped file being truncated by someone
+	 * else makes reading from it crash instead of failing.
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	SeekableReadStream *createMappedReadStream() const;
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -371,6 +371,18 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Returns a pointer to the complete contents of the stream, if the
+	 * stream is directly backed by memory (for example a memory buffer or
+	 * a memory mapped file). This allows client code to access the data
+	 * without copying it. The memory must not be modified and is only
+	 * valid as long as the stream exists.
+	 *
+	 * @return a pointer to the stream data, or 0 if the stream is not
+	 *         backed by memory
+	 */
+	virtual const byte *getBackingPointer() const { return 0; }
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
@@ -77,6 +77,11 @@ public:
 	virtual int32 size() const { return _end - _begin; }
 
 	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+	virtual const byte *getBackingPointer() const {
+		const byte *parentData = _parentStream->getBackingPointer();
+		return parentData ? parentData + _begin : 0;
+	}
 };
 
 /**
@@ -105,10 +105,143 @@ typedef struct {
 
 #include "common/fs.h"
 #include "common/unzip.h"
-#include "common/memstream.h"
+#include "common/substream.h"
+#include "common/textconsole.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
+#include "common/noncopyable.h"
+#include "common/system.h"
+
+namespace Common {
+
+/**
+ * The file of a ZIP archive, shared by the archive and the streams of its
+ * members. Members may be read from several threads at once, e.g. when a
+ * sound from the archive is played while other files are loaded from it,
+ * so the file is only ever seeked and read with the mutex locked (there is
+ * none when the archive is used without an OSystem, e.g. by tools). It is
+ * deleted together with the last ZipFileView referring to it, so member
+ * streams may outlive their archive.
+ */
+class ZipSharedFile : NonCopyable {
+	SeekableReadStream *_stream;
+	OSystem::MutexRef _mutex;
+	int _refCount;
+	int32 _size;
+
+	~ZipSharedFile() {
+		delete _stream;
+		if (_mutex)
+			g_system->deleteMutex(_mutex);
+	}
+
+	void lock() {
+		if (_mutex)
+			g_system->lockMutex(_mutex);
+	}
+
+	void unlock() {
+		if (_mutex)
+			g_system->unlockMutex(_mutex);
+	}
+
+public:
+	ZipSharedFile(SeekableReadStream *stream) : _stream(stream), _mutex(0), _refCount(0) {
+		if (g_system)
+			_mutex = g_system->createMutex();
+		_size = _stream->size();
+	}
+
+	void incRef() {
+		lock();
+		_refCount++;
+		unlock();
+	}
+
+	void decRef() {
+		lock();
+		bool last = (--_refCount == 0);
+		unlock();
+		if (last)
+			delete this;
+	}
+
+	int32 size() const { return _size; }
+
+	/**
+	 * Reads from the given position of the file.
+	 * @return the number of bytes read, or -1 on errors
+	 */
+	int32 readAt(int32 pos, void *dataPtr, uint32 dataSize) {
+		lock();
+		int32 bytesRead = -1;
+		if (_stream->seek(pos, SEEK_SET) && !_stream->err()) {
+			uint32 count = _stream->read(dataPtr, dataSize);
+			if (!_stream->err())
+				bytesRead = count;
+		}
+		_stream->clearErr();
+		unlock();
+		return bytesRead;
+	}
+};
+
+/**
+ * Stream over a ZipSharedFile with a read position of its own. Each user of
+ * the archive file gets its own view, so they don't disturb each other.
+ */
+class ZipFileView : public SeekableReadStream {
+	ZipSharedFile *_file;
+	int32 _pos;
+	bool _eos;
+	bool _err;
+
+public:
+	ZipFileView(ZipSharedFile *file) : _file(file), _pos(0), _eos(false), _err(false) {
+		_file->incRef();
+	}
+	~ZipFileView() { _file->decRef(); }
+
+	/** Creates another view of the same file. */
+	ZipFileView *clone() const { return new ZipFileView(_file); }
+
+	bool err() const { return _err; }
+	void clearErr() { _eos = false; _err = false; }
+	bool eos() const { return _eos; }
+	int32 pos() const { return _pos; }
+	int32 size() const { return _file->size(); }
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		int32 bytesRead = _file->readAt(_pos, dataPtr, dataSize);
+		if (bytesRead < 0) {
+			_err = true;
+			return 0;
+		}
+		_pos += bytesRead;
+		if ((uint32)bytesRead < dataSize)
+			_eos = true;
+		return bytesRead;
+	}
+
+	bool seek(int32 offset, int whence = SEEK_SET) {
+		int32 newPos = offset;
+		if (whence == SEEK_CUR)
+			newPos += _pos;
+		else if (whence == SEEK_END)
+			newPos += size();
+
+		if (newPos < 0 || newPos > size()) {
+			_err = true;
+			return false;
+		}
+		_pos = newPos;
+		_eos = false;
+		return true;
+	}
+};
+
+} // End of namespace Common
 
 #if defined(STRICTUNZIP) || defined(STRICTZIPUNZIP)
 /* like the STRICT of WIN32, we define a pointer that cannot be converted
@@ -381,7 +514,7 @@ typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_H
 /* unz_s contain internal information about the zipfile
 */
 typedef struct {
-	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::ZipFileView *_stream;				/* io structore of the zipfile */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -517,6 +650,77 @@ static uLong unzlocal_SearchCentralDir(Common::SeekableReadStream &fin) {
 	return uPosFound;
 }
 
+static void unzlocal_DosDateToTmuDate(uLong ulDosDate, tm_unz* ptm);
+
+/*
+  Read the whole central directory into memory and store the information
+  about every file in it in the file name hash of the zipfile.
+*/
+static int unzlocal_BuildCentralDirIndex(unz_s *s) {
+	byte *buf;
+	uLong pos=0;
+	uLong i;
+	int err=UNZ_OK;
+
+	if (s->size_central_dir==0)
+		return UNZ_OK;
+
+	buf = (byte *)malloc(s->size_central_dir);
+	if (buf==NULL)
+		return UNZ_INTERNALERROR;
+
+	s->_stream->seek(s->offset_central_dir+s->byte_before_the_zipfile, SEEK_SET);
+	if (s->_stream->err() || s->_stream->read(buf,s->size_central_dir)!=s->size_central_dir) {
+		free(buf);
+		return UNZ_ERRNO;
+	}
+
+	for (i=0; i<s->gi.number_entry; i++) {
+		const byte *item = buf+pos;
+		cached_file_in_zip fe;
+		unz_file_info &file_info = fe.cur_file_info;
+
+		if ((pos+SIZECENTRALDIRITEM>s->size_central_dir) || (READ_LE_UINT32(item)!=0x02014b50)) {
+			err=UNZ_BADZIPFILE;
+			break;
+		}
+
+		file_info.version = READ_LE_UINT16(item+4);
+		file_info.version_needed = READ_LE_UINT16(item+6);
+		file_info.flag = READ_LE_UINT16(item+8);
+		file_info.compression_method = READ_LE_UINT16(item+10);
+		file_info.dosDate = READ_LE_UINT32(item+12);
+		file_info.crc = READ_LE_UINT32(item+16);
+		file_info.compressed_size = READ_LE_UINT32(item+20);
+		file_info.uncompressed_size = READ_LE_UINT32(item+24);
+		file_info.size_filename = READ_LE_UINT16(item+28);
+		file_info.size_file_extra = READ_LE_UINT16(item+30);
+		file_info.size_file_comment = READ_LE_UINT16(item+32);
+		file_info.disk_num_start = READ_LE_UINT16(item+34);
+		file_info.internal_fa = READ_LE_UINT16(item+36);
+		file_info.external_fa = READ_LE_UINT32(item+38);
+		fe.cur_file_info_internal.offset_curfile = READ_LE_UINT32(item+42);
+		unzlocal_DosDateToTmuDate(file_info.dosDate,&file_info.tmu_date);
+
+		if (pos+SIZECENTRALDIRITEM+file_info.size_filename>s->size_central_dir) {
+			err=UNZ_BADZIPFILE;
+			break;
+		}
+
+		fe.num_file = i;
+		fe.pos_in_central_dir = s->offset_central_dir+pos;
+		fe.current_file_ok = 1;
+
+		s->_hash[Common::String((const char *)item+SIZECENTRALDIRITEM, file_info.size_filename)] = fe;
+
+		pos += SIZECENTRALDIRITEM + file_info.size_filename +
+				file_info.size_file_extra + file_info.size_file_comment;
+	}
+
+	free(buf);
+	return err;
+}
+
 /*
   Open a Zip file. path contain the full pathname (by example,
      on a Windows NT computer "c:\\test\\zlib109.zip" or on an Unix computer
@@ -543,7 +747,9 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 
 	int err=UNZ_OK;
 
-	us->_stream = stream;
+	// The archive and its members read the file through views, see
+	// ZipSharedFile
+	us->_stream = new Common::ZipFileView(new Common::ZipSharedFile(stream));
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -605,27 +811,11 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	us->central_pos = central_pos;
 	us->pfile_in_zip_read = NULL;
 
-	err = unzGoToFirstFile((unzFile)us);
+	// Index the central directory once, so that files can be located
+	// without walking it. A damaged directory leaves a partial index.
+	unzlocal_BuildCentralDirIndex(us);
 
-	while (err == UNZ_OK) {
-		// Get the file details
-		char szCurrentFileName[UNZ_MAXFILENAMEINZIP+1];
-		unzGetCurrentFileInfo(us, NULL, szCurrentFileName, sizeof(szCurrentFileName) - 1,
-							NULL, 0, NULL, 0);
-
-		// Save details into the hash
-		cached_file_in_zip fe;
-		fe.num_file = us->num_file;
-		fe.pos_in_central_dir = us->pos_in_central_dir;
-		fe.current_file_ok = us->current_file_ok;
-		fe.cur_file_info = us->cur_file_info;
-		fe.cur_file_info_internal = us->cur_file_info_internal;
-
-		us->_hash[Common::String(szCurrentFileName)] = fe;
-
-		// Move to the next file
-		err = unzGoToNextFile((unzFile)us);
-	}
+	unzGoToFirstFile((unzFile)us);
 	return (unzFile)us;
 }
 
@@ -951,7 +1141,11 @@ int unzLocateFile(unzFile file, const char *szFileName, int iCaseSensitivity) {
   store in *piSizeVar the size of extra info in local header
         (filename and size of extra field data)
 */
-static int unzlocal_CheckCurrentFileCoherencyHeader(unz_s* s, uInt* piSizeVar,
+static int unzlocal_CheckCurrentFileCoherencyHeader(Common::SeekableReadStream *stream,
+													uLong byte_before_the_zipfile,
+													const unz_file_info *pfile_info,
+													const unz_file_info_internal *pfile_info_internal,
+													uInt* piSizeVar,
 													uLong *poffset_local_extrafield,
 													uInt  *psize_local_extrafield) {
 	uLong uMagic,uData,uFlags;
@@ -963,69 +1157,69 @@ static int unzlocal_CheckCurrentFileCoherencyHeader(unz_s* s, uInt* piSizeVar,
 	*poffset_local_extrafield = 0;
 	*psize_local_extrafield = 0;
 
-	s->_stream->seek(s->cur_file_info_internal.offset_curfile +
-								s->byte_before_the_zipfile, SEEK_SET);
-	if (s->_stream->err())
+	stream->seek(pfile_info_internal->offset_curfile +
+								byte_before_the_zipfile, SEEK_SET);
+	if (stream->err())
 		return UNZ_ERRNO;
 
 
 	if (err==UNZ_OK) {
-		if (unzlocal_getLong(s->_stream,&uMagic) != UNZ_OK)
+		if (unzlocal_getLong(stream,&uMagic) != UNZ_OK)
 			err=UNZ_ERRNO;
 		else if (uMagic!=0x04034b50)
 			err=UNZ_BADZIPFILE;
 	}
 
-	if (unzlocal_getShort(s->_stream,&uData) != UNZ_OK)
+	if (unzlocal_getShort(stream,&uData) != UNZ_OK)
 		err=UNZ_ERRNO;
 /*
-	else if ((err==UNZ_OK) && (uData!=s->cur_file_info.wVersion))
+	else if ((err==UNZ_OK) && (uData!=pfile_info->wVersion))
 		err=UNZ_BADZIPFILE;
 */
-	if (unzlocal_getShort(s->_stream,&uFlags) != UNZ_OK)
+	if (unzlocal_getShort(stream,&uFlags) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getShort(s->_stream,&uData) != UNZ_OK)
+	if (unzlocal_getShort(stream,&uData) != UNZ_OK)
 		err=UNZ_ERRNO;
-	else if ((err==UNZ_OK) && (uData!=s->cur_file_info.compression_method))
+	else if ((err==UNZ_OK) && (uData!=pfile_info->compression_method))
 		err=UNZ_BADZIPFILE;
 
-	if ((err==UNZ_OK) && (s->cur_file_info.compression_method!=0) &&
-	                     (s->cur_file_info.compression_method!=Z_DEFLATED))
+	if ((err==UNZ_OK) && (pfile_info->compression_method!=0) &&
+	                     (pfile_info->compression_method!=Z_DEFLATED))
 		err=UNZ_BADZIPFILE;
 
-	if (unzlocal_getLong(s->_stream,&uData) != UNZ_OK) /* date/time */
+	if (unzlocal_getLong(stream,&uData) != UNZ_OK) /* date/time */
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getLong(s->_stream,&uData) != UNZ_OK) /* crc */
+	if (unzlocal_getLong(stream,&uData) != UNZ_OK) /* crc */
 		err=UNZ_ERRNO;
-	else if ((err==UNZ_OK) && (uData!=s->cur_file_info.crc) &&
+	else if ((err==UNZ_OK) && (uData!=pfile_info->crc) &&
 		                      ((uFlags & 8)==0))
 		err=UNZ_BADZIPFILE;
 
-	if (unzlocal_getLong(s->_stream,&uData) != UNZ_OK) /* size compr */
+	if (unzlocal_getLong(stream,&uData) != UNZ_OK) /* size compr */
 		err=UNZ_ERRNO;
-	else if ((err==UNZ_OK) && (uData!=s->cur_file_info.compressed_size) &&
+	else if ((err==UNZ_OK) && (uData!=pfile_info->compressed_size) &&
 							  ((uFlags & 8)==0))
 		err=UNZ_BADZIPFILE;
 
-	if (unzlocal_getLong(s->_stream,&uData) != UNZ_OK) /* size uncompr */
+	if (unzlocal_getLong(stream,&uData) != UNZ_OK) /* size uncompr */
 		err=UNZ_ERRNO;
-	else if ((err==UNZ_OK) && (uData!=s->cur_file_info.uncompressed_size) &&
+	else if ((err==UNZ_OK) && (uData!=pfile_info->uncompressed_size) &&
 							  ((uFlags & 8)==0))
 		err=UNZ_BADZIPFILE;
 
 
-	if (unzlocal_getShort(s->_stream,&size_filename) != UNZ_OK)
+	if (unzlocal_getShort(stream,&size_filename) != UNZ_OK)
 		err=UNZ_ERRNO;
-	else if ((err==UNZ_OK) && (size_filename!=s->cur_file_info.size_filename))
+	else if ((err==UNZ_OK) && (size_filename!=pfile_info->size_filename))
 		err=UNZ_BADZIPFILE;
 
 	*piSizeVar += (uInt)size_filename;
 
-	if (unzlocal_getShort(s->_stream,&size_extra_field) != UNZ_OK)
+	if (unzlocal_getShort(stream,&size_extra_field) != UNZ_OK)
 		err=UNZ_ERRNO;
-	*poffset_local_extrafield= s->cur_file_info_internal.offset_curfile +
+	*poffset_local_extrafield= pfile_info_internal->offset_curfile +
 									SIZEZIPLOCALHEADER + size_filename;
 	*psize_local_extrafield = (uInt)size_extra_field;
 
@@ -1035,28 +1229,24 @@ static int unzlocal_CheckCurrentFileCoherencyHeader(unz_s* s, uInt* piSizeVar,
 }
 
 /*
-  Open for reading data the current file in the zipfile.
+  Open for reading data the file described by pfile_info in the zipfile.
+  The read state is returned in *ppfile_in_zip_read and does not depend on
+  the current file of the zipfile, so several files can be read at once.
   If there is no error and the file is opened, the return value is UNZ_OK.
 */
-int unzOpenCurrentFile (unzFile file) {
+static int unzlocal_OpenFileInZip(Common::SeekableReadStream *stream,
+								  uLong byte_before_the_zipfile,
+								  const unz_file_info *pfile_info,
+								  const unz_file_info_internal *pfile_info_internal,
+								  file_in_zip_read_info_s **ppfile_in_zip_read) {
 	int err=UNZ_OK;
 	int Store;
 	uInt iSizeVar;
-	unz_s* s;
 	file_in_zip_read_info_s* pfile_in_zip_read_info;
 	uLong offset_local_extrafield;  /* offset of the local extra field */
 	uInt  size_local_extrafield;    /* size of the local extra field */
 
-	if (file==NULL)
-		return UNZ_PARAMERROR;
-	s=(unz_s*)file;
-	if (!s->current_file_ok)
-		return UNZ_PARAMERROR;
-
-	if (s->pfile_in_zip_read != NULL)
-		unzCloseCurrentFile(file);
-
-	if (unzlocal_CheckCurrentFileCoherencyHeader(s,&iSizeVar,
+	if (unzlocal_CheckCurrentFileCoherencyHeader(stream,byte_before_the_zipfile,pfile_info,pfile_info_internal,&iSizeVar,
 				&offset_local_extrafield,&size_local_extrafield)!=UNZ_OK)
 		return UNZ_BADZIPFILE;
 
@@ -1078,16 +1268,16 @@ int unzOpenCurrentFile (unzFile file) {
 
 	pfile_in_zip_read_info->stream_initialized=0;
 
-	if ((s->cur_file_info.compression_method!=0) &&
-	    (s->cur_file_info.compression_method!=Z_DEFLATED))
+	if ((pfile_info->compression_method!=0) &&
+	    (pfile_info->compression_method!=Z_DEFLATED))
 		err=UNZ_BADZIPFILE;
-	Store = s->cur_file_info.compression_method==0;
+	Store = pfile_info->compression_method==0;
 
-	pfile_in_zip_read_info->crc32_wait=s->cur_file_info.crc;
+	pfile_in_zip_read_info->crc32_wait=pfile_info->crc;
 	pfile_in_zip_read_info->crc32_data=0;
-	pfile_in_zip_read_info->compression_method = s->cur_file_info.compression_method;
-	pfile_in_zip_read_info->_stream=s->_stream;
-	pfile_in_zip_read_info->byte_before_the_zipfile=s->byte_before_the_zipfile;
+	pfile_in_zip_read_info->compression_method = pfile_info->compression_method;
+	pfile_in_zip_read_info->_stream=stream;
+	pfile_in_zip_read_info->byte_before_the_zipfile=byte_before_the_zipfile;
 
 	pfile_in_zip_read_info->stream.total_out = 0;
 
@@ -1111,20 +1301,41 @@ int unzOpenCurrentFile (unzFile file) {
 		err=UNZ_BADZIPFILE;
 #endif
 	}
-	pfile_in_zip_read_info->rest_read_compressed = s->cur_file_info.compressed_size;
-	pfile_in_zip_read_info->rest_read_uncompressed = s->cur_file_info.uncompressed_size;
+	pfile_in_zip_read_info->rest_read_compressed = pfile_info->compressed_size;
+	pfile_in_zip_read_info->rest_read_uncompressed = pfile_info->uncompressed_size;
 
 
 	pfile_in_zip_read_info->pos_in_zipfile =
-		s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar;
+		pfile_info_internal->offset_curfile + SIZEZIPLOCALHEADER + iSizeVar;
 
 	pfile_in_zip_read_info->stream.avail_in = (uInt)0;
 
-	s->pfile_in_zip_read = pfile_in_zip_read_info;
+	*ppfile_in_zip_read = pfile_in_zip_read_info;
 	return err;
 }
 
 
+/*
+  Open for reading data the current file in the zipfile.
+  If there is no error and the file is opened, the return value is UNZ_OK.
+*/
+int unzOpenCurrentFile (unzFile file) {
+	unz_s* s;
+
+	if (file==NULL)
+		return UNZ_PARAMERROR;
+	s=(unz_s*)file;
+	if (!s->current_file_ok)
+		return UNZ_PARAMERROR;
+
+	if (s->pfile_in_zip_read != NULL)
+		unzCloseCurrentFile(file);
+
+	return unzlocal_OpenFileInZip(s->_stream,s->byte_before_the_zipfile,&s->cur_file_info,&s->cur_file_info_internal,
+								  &s->pfile_in_zip_read);
+}
+
+
 /*
   Read bytes from the current file.
   buf contain buffer where data must be copied
@@ -1135,20 +1346,14 @@ int unzOpenCurrentFile (unzFile file) {
   return <0 with error code if there is an error
     (UNZ_ERRNO for IO error, or zLib error for uncompress error)
 */
-int unzReadCurrentFile(unzFile file, voidp buf, unsigned len) {
+static int unzlocal_ReadFileInZip(file_in_zip_read_info_s* pfile_in_zip_read_info,
+								  voidp buf, unsigned len) {
 	int err=UNZ_OK;
 	uInt iRead = 0;
-	unz_s* s;
-	file_in_zip_read_info_s* pfile_in_zip_read_info;
-	if (file==NULL)
-		return UNZ_PARAMERROR;
-	s=(unz_s*)file;
-	pfile_in_zip_read_info=s->pfile_in_zip_read;
 
 	if (pfile_in_zip_read_info==NULL)
 		return UNZ_PARAMERROR;
 
-
 	if (pfile_in_zip_read_info->read_buffer == NULL)
 		return UNZ_END_OF_LIST_OF_FILE;
 	if (len==0)
@@ -1251,6 +1456,15 @@ int unzReadCurrentFile(unzFile file, voidp buf, unsigned len) {
 	return err;
 }
 
+int unzReadCurrentFile(unzFile file, voidp buf, unsigned len) {
+	unz_s* s;
+	if (file==NULL)
+		return UNZ_PARAMERROR;
+	s=(unz_s*)file;
+
+	return unzlocal_ReadFileInZip(s->pfile_in_zip_read,buf,len);
+}
+
 
 /*
   Give the current position in uncompressed data
@@ -1347,16 +1561,9 @@ int unzGetLocalExtrafield(unzFile file, voidp buf, unsigned len) {
   Close the file in zip opened with unzipOpenCurrentFile
   Return UNZ_CRCERROR if all the file was read but the CRC is not good
 */
-int unzCloseCurrentFile(unzFile file) {
+static int unzlocal_CloseFileInZip(file_in_zip_read_info_s* pfile_in_zip_read_info) {
 	int err=UNZ_OK;
 
-	unz_s* s;
-	file_in_zip_read_info_s* pfile_in_zip_read_info;
-	if (file == NULL)
-		return UNZ_PARAMERROR;
-	s = (unz_s*)file;
-	pfile_in_zip_read_info = s->pfile_in_zip_read;
-
 	if (pfile_in_zip_read_info == NULL)
 		return UNZ_PARAMERROR;
 
@@ -1379,7 +1586,20 @@ int unzCloseCurrentFile(unzFile file) {
 	pfile_in_zip_read_info->stream_initialized = 0;
 	free(pfile_in_zip_read_info);
 
-	s->pfile_in_zip_read=NULL;
+	return err;
+}
+
+int unzCloseCurrentFile(unzFile file) {
+	int err;
+
+	unz_s* s;
+	if (file == NULL)
+		return UNZ_PARAMERROR;
+	s = (unz_s*)file;
+
+	err = unzlocal_CloseFileInZip(s->pfile_in_zip_read);
+	if (err != UNZ_PARAMERROR)
+		s->pfile_in_zip_read=NULL;
 
 	return err;
 }
@@ -1431,6 +1651,7 @@ public:
 
 	virtual bool hasFile(const String &name) const;
 	virtual int listMembers(ArchiveMemberList &list) const;
+	virtual int listMatchingMembers(ArchiveMemberList &list, const String &pattern) const;
 	virtual const ArchiveMemberPtr getMember(const String &name) const;
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
 };
@@ -1453,6 +1674,114 @@ public:
 };
 */
 
+/**
+ * Stream which inflates a single compressed member of a ZIP archive on the
+ * fly. Every stream keeps its own read state, so several members (or the same
+ * member several times) can be read independently of each other.
+ *
+ * The stream reads the archive file through a view of its own, so it may be
+ * used from another thread than the archive and may outlive it.
+ */
+class ZipInflateReadStream : public SeekableReadStream {
+	ZipFileView *_file;
+	uLong _byteBeforeTheZipfile;
+	unz_file_info _fileInfo;
+	unz_file_info_internal _fileInfoInternal;
+	file_in_zip_read_info_s *_readInfo;
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+
+public:
+	ZipInflateReadStream(ZipFileView *file, uLong byteBeforeTheZipfile,
+	                     const unz_file_info &fileInfo,
+	                     const unz_file_info_internal &fileInfoInternal,
+	                     file_in_zip_read_info_s *readInfo)
+		: _file(file), _byteBeforeTheZipfile(byteBeforeTheZipfile),
+		  _fileInfo(fileInfo), _fileInfoInternal(fileInfoInternal),
+		  _readInfo(readInfo), _pos(0), _eos(false), _err(false) {
+		assert(_file);
+		assert(_readInfo);
+	}
+
+	~ZipInflateReadStream() {
+		if (_readInfo)
+			unzlocal_CloseFileInZip(_readInfo);
+		delete _file;
+	}
+
+	bool err() const { return _err; }
+	void clearErr() { _eos = false; _err = false; }
+
+	bool eos() const { return _eos; }
+	int32 pos() const { return _pos; }
+	int32 size() const { return _fileInfo.uncompressed_size; }
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		if (_err || !_readInfo)
+			return 0;
+
+		int bytesRead = unzlocal_ReadFileInZip(_readInfo, dataPtr, dataSize);
+		if (bytesRead < 0) {
+			_err = true;
+			return 0;
+		}
+
+		_pos += bytesRead;
+#ifdef USE_ZLIB
+		if (_readInfo->rest_read_uncompressed == 0 && _readInfo->crc32_data != _readInfo->crc32_wait) {
+			warning("ZipInflateReadStream: CRC mismatch");
+			_err = true;
+		}
+#endif
+		if ((uint32)bytesRead < dataSize)
+			_eos = true;
+
+		return bytesRead;
+	}
+
+	bool seek(int32 offset, int whence = SEEK_SET) {
+		int32 newPos = 0;
+		switch (whence) {
+		case SEEK_SET:
+			newPos = offset;
+			break;
+		case SEEK_CUR:
+			newPos = _pos + offset;
+			break;
+		case SEEK_END:
+			newPos = size() + offset;
+			break;
+		}
+
+		if (newPos < 0 || newPos > size())
+			return false;
+
+		if ((uint32)newPos < _pos) {
+			// Deflate data can only be decoded forward, so restart from the
+			// beginning of the member.
+			unzlocal_CloseFileInZip(_readInfo);
+			_readInfo = 0;
+			_pos = 0;
+			_err = false;
+			if (unzlocal_OpenFileInZip(_file, _byteBeforeTheZipfile, &_fileInfo, &_fileInfoInternal, &_readInfo) != UNZ_OK) {
+				_err = true;
+				return false;
+			}
+		}
+
+		byte tmpBuf[1024];
+		while (!_err && _pos < (uint32)newPos) {
+			uint32 bytesToSkip = MIN<uint32>(sizeof(tmpBuf), newPos - _pos);
+			if (read(tmpBuf, bytesToSkip) != bytesToSkip)
+				break;
+		}
+
+		_eos = false;
+		return !_err;
+	}
+};
+
 ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
 	assert(_zipFile);
 }
@@ -1462,7 +1791,8 @@ ZipArchive::~ZipArchive() {
 }
 
 bool ZipArchive::hasFile(const String &name) const {
-	return (unzLocateFile(_zipFile, name.c_str(), 2) == UNZ_OK);
+	const unz_s *const archive = (const unz_s *)_zipFile;
+	return archive->_hash.contains(name);
 }
 
 int ZipArchive::listMembers(ArchiveMemberList &list) const {
@@ -1478,6 +1808,21 @@ int ZipArchive::listMembers(ArchiveMemberList &list) const {
 	return members;
 }
 
+int ZipArchive::listMatchingMembers(ArchiveMemberList &list, const String &pattern) const {
+	int matches = 0;
+
+	const unz_s *const archive = (const unz_s *)_zipFile;
+	for (ZipHash::const_iterator i = archive->_hash.begin(), end = archive->_hash.end();
+	     i != end; ++i) {
+		if (i->_key.matchString(pattern, true, true)) {
+			list.push_back(ArchiveMemberList::value_type(new GenericArchiveMember(i->_key, this)));
+			++matches;
+		}
+	}
+
+	return matches;
+}
+
 const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 	if (!hasFile(name))
 		return ArchiveMemberPtr();
@@ -1486,35 +1831,41 @@ const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 }
 
 SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
-	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
-		return 0;
-
-	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
-		return 0;
-
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
+	unz_s *s = (unz_s *)_zipFile;
+	ZipHash::const_iterator i = s->_hash.find(name);
+	if (i == s->_hash.end())
 		return 0;
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
-	assert(buffer);
+	const unz_file_info &fileInfo = i->_value.cur_file_info;
+	const unz_file_info_internal &fileInfoInternal = i->_value.cur_file_info_internal;
+
+	// Every member stream gets a view of its own of the archive file.
+	ZipFileView *file = s->_stream->clone();
+
+	if (fileInfo.compression_method == 0) {
+		// Stored members are served straight from the archive file.
+		uInt iSizeVar;
+		uLong offsetLocalExtrafield;
+		uInt sizeLocalExtrafield;
+		if (unzlocal_CheckCurrentFileCoherencyHeader(file, s->byte_before_the_zipfile, &fileInfo, &fileInfoInternal,
+				&iSizeVar, &offsetLocalExtrafield, &sizeLocalExtrafield) != UNZ_OK) {
+			delete file;
+			return 0;
+		}
 
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
-		free(buffer);
-		return 0;
+		uint32 begin = fileInfoInternal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar + s->byte_before_the_zipfile;
+		return new SafeSeekableSubReadStream(file, begin, begin + fileInfo.uncompressed_size, DisposeAfterUse::YES);
 	}
 
-	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
-		free(buffer);
+	file_in_zip_read_info_s *readInfo = 0;
+	if (unzlocal_OpenFileInZip(file, s->byte_before_the_zipfile, &fileInfo, &fileInfoInternal, &readInfo) != UNZ_OK) {
+		if (readInfo)
+			unzlocal_CloseFileInZip(readInfo);
+		delete file;
 		return 0;
 	}
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	return new ZipInflateReadStream(file, s->byte_before_the_zipfile, fileInfo, fileInfoInternal, readInfo);
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -0,0 +1,236 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/md5.h"
+#include "common/savefile.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "engines/detectioncache.h"
+
+namespace Common {
+DECLARE_SINGLETON(DetectionCache);
+}
+
+#define DETECTIONCACHE_FILENAME "detection.cache"
+#define DETECTIONCACHE_MAGIC MKTAG('D', 'C', 'H', 'E')
+#define DETECTIONCACHE_VERSION 2
+
+DetectionCache::DetectionCache() : _mutex(0), _loaded(false), _dirty(false), _batchDepth(0), _hits(0), _misses(0) {
+}
+
+DetectionCache::~DetectionCache() {
+	delete _mutex;
+}
+
+bool DetectionCache::isAvailable() {
+	// Command line tools may run detection before the backend is set up, so
+	// the cache is only enabled once the savefile manager exists.
+	if (!_mutex && g_system && g_system->getSavefileManager())
+		_mutex = new Common::Mutex();
+	return _mutex != 0;
+}
+
+Common::String DetectionCache::makeKey(const Common::String &path, uint32 md5Bytes) {
+	return Common::String::format("%u:", md5Bytes) + path;
+}
+
+Common::String DetectionCache::getKeyPath(const Common::String &key) {
+	const char *colon = strchr(key.c_str(), ':');
+	return colon ? Common::String(colon + 1) : Common::String();
+}
+
+Common::String DetectionCache::getMD5(Common::SeekableReadStream &stream, const Common::FSNode &node, uint32 md5Bytes) {
+	// Without a modification time, changes to a file of the same size would
+	// go unnoticed
+	const uint32 modificationTime = node.getModificationTime();
+	if (!modificationTime || !isAvailable())
+		return Common::computeStreamMD5AsString(stream, md5Bytes);
+
+	const Common::String key = makeKey(node.getPath(), md5Bytes);
+	const int32 size = stream.size();
+
+	{
+		Common::StackLock lock(*_mutex);
+		load();
+
+		EntryMap::const_iterator i = _entries.find(key);
+		if (i != _entries.end() && i->_value.size == size && i->_value.modificationTime == modificationTime) {
+			_hits++;
+			return i->_value.md5;
+		}
+		_misses++;
+	}
+
+	// Hash outside of the lock, so that concurrent detection passes do not
+	// wait for each other's I/O.
+	Entry entry;
+	entry.size = size;
+	entry.modificationTime = modificationTime;
+	entry.md5 = Common::computeStreamMD5AsString(stream, md5Bytes);
+	if (entry.md5.size() != 32)
+		return entry.md5;
+
+	Common::StackLock lock(*_mutex);
+	_entries[key] = entry;
+	_dirty = true;
+	return entry.md5;
+}
+
+void DetectionCache::endPass() {
+	if (!isAvailable())
+		return;
+
+	debug(2, "DetectionCache: %u hits, %u misses", _hits, _misses);
+
+	bool doSave;
+	{
+		Common::StackLock lock(*_mutex);
+		doSave = (_batchDepth == 0);
+	}
+	if (doSave)
+		save();
+}
+
+void DetectionCache::beginBatch() {
+	if (!isAvailable())
+		return;
+
+	Common::StackLock lock(*_mutex);
+	_batchDepth++;
+}
+
+void DetectionCache::endBatch() {
+	if (!isAvailable())
+		return;
+
+	{
+		Common::StackLock lock(*_mutex);
+		// The batch may have begun before the cache was available
+		if (_batchDepth == 0 || --_batchDepth > 0)
+			return;
+	}
+
+	debug(1, "DetectionCache: %u hits, %u misses", _hits, _misses);
+	save();
+}
+
+void DetectionCache::load() {
+	// Called with _mutex held
+	if (_loaded)
+		return;
+	_loaded = true;
+
+	Common::InSaveFile *file = g_system->getSavefileManager()->openForLoading(DETECTIONCACHE_FILENAME);
+	if (!file)
+		return;
+
+	if (file->readUint32BE() != DETECTIONCACHE_MAGIC || file->readUint32BE() != DETECTIONCACHE_VERSION) {
+		debug(1, "DetectionCache: Ignoring incompatible cache file");
+		delete file;
+		return;
+	}
+
+	uint32 count = file->readUint32LE();
+	for (uint32 i = 0; i < count && !file->eos() && !file->err(); i++) {
+		uint32 keyLength = file->readUint32LE();
+		Common::String key;
+		for (uint32 j = 0; j < keyLength && !file->eos(); j++)
+			key += (char)file->readByte();
+
+		Entry entry;
+		entry.size = file->readSint32LE();
+		entry.modificationTime = file->readUint32LE();
+		for (uint32 j = 0; j < 32 && !file->eos(); j++)
+			entry.md5 += (char)file->readByte();
+
+		if (file->eos() || file->err())
+			break;
+
+		if (entry.modificationTime)
+			_entries[key] = entry;
+	}
+	delete file;
+
+	// Drop the entries of files which are gone, so the cache doesn't keep
+	// growing as games get moved or deleted. A file usually has entries for
+	// several sizes, so remember which paths were checked already.
+	Common::HashMap<Common::String, bool> exists;
+	for (EntryMap::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		const Common::String path = getKeyPath(i->_key);
+		if (!exists.contains(path))
+			exists[path] = !path.empty() && Common::FSNode(path).exists();
+		if (!exists[path]) {
+			_entries.erase(i);
+			_dirty = true;
+		}
+	}
+
+	debug(1, "DetectionCache: Loaded %u entries", _entries.size());
+}
+
+void DetectionCache::save() {
+	if (!isAvailable())
+		return;
+
+	Common::StackLock lock(*_mutex);
+	if (!_dirty)
+		return;
+
+	Common::OutSaveFile *file = g_system->getSavefileManager()->openForSaving(DETECTIONCACHE_FILENAME);
+	if (!file) {
+		warning("DetectionCache: Could not open '%s' for writing", DETECTIONCACHE_FILENAME);
+		return;
+	}
+
+	file->writeUint32BE(DETECTIONCACHE_MAGIC);
+	file->writeUint32BE(DETECTIONCACHE_VERSION);
+	file->writeUint32LE(_entries.size());
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		file->writeUint32LE(i->_key.size());
+		file->writeString(i->_key);
+		file->writeSint32LE(i->_value.size);
+		file->writeUint32LE(i->_value.modificationTime);
+		file->write(i->_value.md5.c_str(), 32);
+	}
+
+	file->finalize();
+	if (file->err())
+		warning("DetectionCache: Could not write '%s'", DETECTIONCACHE_FILENAME);
+	else
+		_dirty = false;
+	delete file;
+}
+
+void DetectionCache::clear() {
+	if (!isAvailable())
+		return;
+
+	Common::StackLock lock(*_mutex);
+	_entries.clear();
+	_loaded = true;
+	_dirty = false;
+	g_system->getSavefileManager()->removeSavefile(DETECTIONCACHE_FILENAME);
+}
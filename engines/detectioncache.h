@@ -0,0 +1,121 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_DETECTIONCACHE_H
+#define ENGINES_DETECTIONCACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+namespace Common {
+class FSNode;
+class SeekableReadStream;
+}
+
+/**
+ * Cache for the partial MD5 sums computed during game detection.
+ *
+ * Every engine plugin hashes the start of all files it knows about, so the
+ * same file gets hashed by many engines in a single detection pass, and
+ * again every time a directory is (re)scanned. The cache keeps the MD5 sums
+ * keyed by file path and number of hashed bytes, and validates them against
+ * the file size and modification time. Files whose modification time the
+ * backend can't tell are not cached. The cache is shared by all engines and
+ * persisted in the file "detection.cache" managed by the savefile manager,
+ * so it is reused between runs. Entries of files which no longer exist are
+ * dropped when the cache is loaded.
+ *
+ * The cache needs the savefile manager and does nothing until the backend
+ * has been initialized. It is set up by the first call after that, which
+ * must not race with other calls. From then on it is thread safe.
+ */
+class DetectionCache : public Common::Singleton<DetectionCache> {
+public:
+	/**
+	 * Returns the MD5 sum of the first md5Bytes bytes (or of the whole
+	 * stream if md5Bytes is 0) of the given file, whose contents are
+	 * provided by stream. The stream is only read if there is no matching
+	 * cache entry.
+	 */
+	Common::String getMD5(Common::SeekableReadStream &stream, const Common::FSNode &node, uint32 md5Bytes);
+
+	/**
+	 * Marks the end of a detection pass over one directory. The cache is
+	 * written to disk, unless a batch is in progress.
+	 */
+	void endPass();
+
+	/**
+	 * Starts a batch of detection passes, e.g. when scanning many
+	 * directories in a row. The cache is only written when the batch ends.
+	 */
+	void beginBatch();
+	void endBatch();
+
+	/** Writes the cache to disk, if it has been modified. */
+	void save();
+
+	/** Removes all entries from the cache, including the ones on disk. */
+	void clear();
+
+	uint32 getHits() const { return _hits; }
+	uint32 getMisses() const { return _misses; }
+	void resetStatistics() { _hits = _misses = 0; }
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DetectionCache();
+	~DetectionCache();
+
+	struct Entry {
+		int32 size;
+		uint32 modificationTime;
+		Common::String md5;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	/**
+	 * Returns whether the savefile manager is available yet, and sets up
+	 * the cache the first time it is.
+	 */
+	bool isAvailable();
+	void load();
+	static Common::String makeKey(const Common::String &path, uint32 md5Bytes);
+	static Common::String getKeyPath(const Common::String &key);
+
+	EntryMap _entries;
+	Common::Mutex *_mutex;
+	bool _loaded;
+	bool _dirty;
+	int _batchDepth;
+	uint32 _hits;
+	uint32 _misses;
+};
+
+/** Shortcut for accessing the detection cache. */
+#define DetectionCacheMan DetectionCache::instance()
+
+#endif
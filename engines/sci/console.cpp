@@ -81,6 +81,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	// Variables
 	registerVar("sleeptime_factor",	&g_debug_sleeptime_factor);
 	registerVar("gc_interval",		&engine->_gamestate->scriptGCInterval);
+	registerVar("gc_step_size",		&engine->_gamestate->scriptGCStepSize);
 	registerVar("simulated_key",		&g_debug_simulated_key);
 	registerVar("track_mouse_clicks",	&g_debug_track_mouse_clicks);
 	// FIXME: This actually passes an enum type instead of an integer but no
@@ -95,6 +96,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("opcodes",			WRAP_METHOD(Console, cmdOpcodes));
 	registerCmd("selector",			WRAP_METHOD(Console, cmdSelector));
 	registerCmd("selectors",			WRAP_METHOD(Console, cmdSelectors));
+	registerCmd("selector_cache",		WRAP_METHOD(Console, cmdSelectorCache));
 	registerCmd("functions",			WRAP_METHOD(Console, cmdKernelFunctions));
 	registerCmd("class_table",		WRAP_METHOD(Console, cmdClassTable));
 	// Parser
@@ -141,6 +143,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("pi",                 WRAP_METHOD(Console, cmdPlaneItemList));	// alias
 	registerCmd("saved_bits",         WRAP_METHOD(Console, cmdSavedBits));
 	registerCmd("show_saved_bits",    WRAP_METHOD(Console, cmdShowSavedBits));
+	registerCmd("gfx_cache",          WRAP_METHOD(Console, cmdGfxCache));
 	// Segments
 	registerCmd("segment_table",		WRAP_METHOD(Console, cmdPrintSegmentTable));
 	registerCmd("segtable",			WRAP_METHOD(Console, cmdPrintSegmentTable));	// alias
@@ -154,6 +157,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	registerCmd("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	registerCmd("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	registerCmd("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
 	// Music/SFX
 	registerCmd("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	registerCmd("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -315,6 +319,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("---------\n");
 	debugPrintf("sleeptime_factor: Factor to multiply with wait times in kWait()\n");
 	debugPrintf("gc_interval: Number of kernel calls in between garbage collections\n");
+	debugPrintf("gc_step_size: Number of objects marked per incremental garbage collection step, 0 disables incremental collection\n");
 	debugPrintf("simulated_key: Add a key with the specified scan code to the event list\n");
 	debugPrintf("track_mouse_clicks: Toggles mouse click tracking to the console\n");
 	debugPrintf("weak_validations: Turns some validation errors into warnings\n");
@@ -332,6 +337,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" opcodes - Lists the opcode names\n");
 	debugPrintf(" selectors - Lists the selector names\n");
 	debugPrintf(" selector - Attempts to find the requested selector by name\n");
+	debugPrintf(" selector_cache - Shows the hit rate of the selector lookup cache\n");
 	debugPrintf(" functions - Lists the kernel functions\n");
 	debugPrintf(" class_table - Shows the available classes\n");
 	debugPrintf("\n");
@@ -378,6 +384,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" plane_items / pi - Shows a list of all items for a plane (SCI2+)\n");
 	debugPrintf(" saved_bits - List saved bits on the hunk\n");
 	debugPrintf(" show_saved_bits - Display saved bits\n");
+	debugPrintf(" gfx_cache - Shows the memory use and hit rate of the view and font caches\n");
 	debugPrintf("\n");
 	debugPrintf("Segments:\n");
 	debugPrintf(" segment_table / segtable - Lists all segments\n");
@@ -390,6 +397,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	debugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	debugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	debugPrintf(" gc_stats - Shows the pause times of the garbage collector\n");
 	debugPrintf("\n");
 	debugPrintf("Music/SFX:\n");
 	debugPrintf(" songlib - Shows the song library\n");
@@ -545,6 +553,29 @@ bool Console::cmdSelector(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdSelectorCache(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		debugPrintf("Shows the statistics of the selector lookup cache.\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		debugPrintf("With \"reset\", the hit and miss counters are set to 0.\n");
+		return true;
+	}
+
+	SelectorLookupCache &cache = _engine->_gamestate->_segMan->getSelectorLookupCache();
+	uint32 lookups = cache.getHits() + cache.getMisses();
+
+	debugPrintf("Cached lookups: %u\n", cache.getSize());
+	debugPrintf("Hits: %u, misses: %u", cache.getHits(), cache.getMisses());
+	if (lookups)
+		debugPrintf(", hit rate: %.1f%%", cache.getHits() * 100.0 / lookups);
+	debugPrintf("\n");
+
+	if (argc == 2)
+		cache.resetStats();
+
+	return true;
+}
+
 bool Console::cmdSelectors(int argc, const char **argv) {
 	debugPrintf("Selector names in numeric order:\n");
 	Common::String selectorName;
@@ -1861,6 +1892,43 @@ bool Console::cmdShowSavedBits(int argc, const char **argv) {
 	return true;
 }
 
+template<class T>
+static void printGfxCacheStats(Console *con, const char *name, const GfxObjectCache<T> &cache) {
+	uint32 lookups = cache.getHits() + cache.getMisses();
+
+	con->debugPrintf("%s: %u cached, %u of %u KB used\n", name, cache.getSize(), cache.getMemoryUsed() / 1024, cache.getMaxMemory() / 1024);
+	con->debugPrintf(" Hits: %u, misses: %u", cache.getHits(), cache.getMisses());
+	if (lookups)
+		con->debugPrintf(", hit rate: %.1f%%", cache.getHits() * 100.0 / lookups);
+	con->debugPrintf(", evictions: %u\n", cache.getEvictions());
+}
+
+bool Console::cmdGfxCache(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		debugPrintf("Shows the memory use and hit rate of the view and font caches.\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		debugPrintf("With \"reset\", the hit, miss and eviction counters are set to 0.\n");
+		debugPrintf("The budgets are set by the view_cache_size and font_cache_size config keys, in KB.\n");
+		return true;
+	}
+
+	GfxCache *cache = _engine->_gfxCache;
+	if (!cache) {
+		debugPrintf("The graphics cache is not available\n");
+		return true;
+	}
+
+	printGfxCacheStats(this, "Views", cache->getViewCache());
+	printGfxCacheStats(this, "Fonts", cache->getFontCache());
+
+	if (argc == 2) {
+		cache->getViewCache().resetStats();
+		cache->getFontCache().resetStats();
+	}
+
+	return true;
+}
+
 
 bool Console::cmdParseGrammar(int argc, const char **argv) {
 	debugPrintf("Parse grammar, in strict GNF:\n");
@@ -2363,6 +2431,30 @@ bool Console::cmdGCNormalize(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		debugPrintf("Shows the pause times of the garbage collector.\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		debugPrintf("With \"reset\", all statistics are set to 0.\n");
+		return true;
+	}
+
+	GCStats &stats = _engine->_gamestate->_gc->getStats();
+
+	debugPrintf("Incremental cycles: %u (%u steps), full collections: %u\n", stats.cycles, stats.steps, stats.fullCollections);
+	debugPrintf("Cycle in progress: %s\n", _engine->_gamestate->_segMan->isGCMarking() ? "yes" : "no");
+	debugPrintf("Pauses: %u, last: %u ms, max: %u ms, total: %u ms", stats.pauses, stats.lastPause, stats.maxPause, stats.totalPause);
+	if (stats.pauses)
+		debugPrintf(", average: %.2f ms", (double)stats.totalPause / stats.pauses);
+	debugPrintf("\n");
+	debugPrintf("Objects freed: %u\n", stats.freed);
+
+	if (argc == 2)
+		stats.reset();
+
+	return true;
+}
+
 bool Console::cmdVMVarlist(int argc, const char **argv) {
 	EngineState *s = _engine->_gamestate;
 	const char *varnames[] = {"global", "local", "temp", "param"};
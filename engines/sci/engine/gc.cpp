@@ -21,7 +21,9 @@
  */
 
 #include "sci/engine/gc.h"
+#include "common/algorithm.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 namespace Sci {
@@ -80,25 +82,77 @@ static AddrSet *normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_
 	return normal_map;
 }
 
-static void processWorkList(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap) {
+/**
+ * Checks whether an address queued for scanning still refers to something
+ * the segment can report outgoing references for. Table entries may have been
+ * freed by the scripts in between incremental marking steps.
+ */
+static bool isScannable(SegmentObj *mobj, reg_t reg) {
+	switch (mobj->getType()) {
+	case SEG_TYPE_CLONES:
+	case SEG_TYPE_LISTS:
+	case SEG_TYPE_NODES:
+	case SEG_TYPE_ARRAY:
+		return mobj->isValidOffset(reg.getOffset());
+	default:
+		return true;
+	}
+}
+
+/**
+ * Scans objects on the worklist for outgoing references.
+ * @param maxObjects	the maximum number of objects to scan, or 0 to empty the worklist
+ */
+static void processWorkList(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap, uint maxObjects = 0) {
 	SegmentId stackSegment = segMan->findSegmentByType(SEG_TYPE_STACK);
+	uint scanned = 0;
 	while (!wm._worklist.empty()) {
+		if (maxObjects && scanned >= maxObjects)
+			break;
+
 		reg_t reg = wm._worklist.back();
 		wm._worklist.pop_back();
 		if (reg.getSegment() != stackSegment) { // No need to repeat this one
 			debugC(kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
-			if (reg.getSegment() < heap.size() && heap[reg.getSegment()]) {
+			if (reg.getSegment() < heap.size() && heap[reg.getSegment()] && isScannable(heap[reg.getSegment()], reg)) {
 				// Valid heap object? Find its outgoing references!
 				wm.pushArray(heap[reg.getSegment()]->listAllOutgoingReferences(reg));
+				scanned++;
 			}
 		}
 	}
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
-	assert(!s->_executionStack.empty());
+/**
+ * Takes the objects recorded by the SegManager barriers since the last step.
+ * Objects freed during a cycle may have been marked already, so the marks in
+ * reallocated segments are dropped, and newly allocated objects are always
+ * scanned.
+ */
+static void pushBarrierReferences(SegManager *segMan, WorklistManager &wm) {
+	Common::Array<SegmentId> &allocatedSegments = segMan->getGCAllocatedSegments();
+	if (!allocatedSegments.empty()) {
+		for (AddrSet::iterator i = wm._map.begin(); i != wm._map.end(); ++i) {
+			if (Common::find(allocatedSegments.begin(), allocatedSegments.end(), i->_key.getSegment()) != allocatedSegments.end())
+				wm._map.erase(i);
+		}
+		allocatedSegments.clear();
+	}
 
-	WorklistManager wm;
+	Common::Array<reg_t> &allocatedRefs = segMan->getGCAllocatedReferences();
+	for (Common::Array<reg_t>::const_iterator it = allocatedRefs.begin(); it != allocatedRefs.end(); ++it) {
+		wm._map.erase(*it);
+		wm.push(*it);
+	}
+	allocatedRefs.clear();
+
+	Common::Array<reg_t> &shadedRefs = segMan->getGCShadedReferences();
+	wm.pushArray(shadedRefs);
+	shadedRefs.clear();
+}
+
+static void pushRootSet(EngineState *s, WorklistManager &wm) {
+	assert(!s->_executionStack.empty());
 
 	// Initialize registers
 	wm.push(s->r_acc);
@@ -151,8 +205,14 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	}
 
 	debugC(kDebugLevelGC, "[GC] -- Finished explicitly loaded scripts, done with root set");
+}
 
-	processWorkList(s->_segMan, wm, heap);
+AddrSet *findAllActiveReferences(EngineState *s) {
+	WorklistManager wm;
+
+	pushRootSet(s, wm);
+
+	processWorkList(s->_segMan, wm, s->_segMan->getSegments());
 
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
@@ -160,11 +220,14 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	return normalizeAddresses(s->_segMan, wm._map);
 }
 
-void run_gc(EngineState *s) {
-	SegManager *segMan = s->_segMan;
+/**
+ * Frees everything in the heap which isn't in the given set of references.
+ * @return the number of objects freed
+ */
+static uint sweep(SegManager *segMan, const AddrSet &activeRefs) {
+	uint freed = 0;
 
 	// Some debug stuff
-	debugC(kDebugLevelGC, "[GC] Running...");
 #ifdef GC_DEBUG_CODE
 	const char *segnames[SEG_TYPE_MAX + 1];
 	int segcount[SEG_TYPE_MAX + 1];
@@ -172,9 +235,6 @@ void run_gc(EngineState *s) {
 	memset(segcount, 0, sizeof(segcount));
 #endif
 
-	// Compute the set of all segments references currently in use.
-	AddrSet *activeRefs = findAllActiveReferences(s);
-
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
 	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
@@ -192,10 +252,11 @@ void run_gc(EngineState *s) {
 			const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(seg);
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
-				if (!activeRefs->contains(addr)) {
+				if (!activeRefs.contains(addr)) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					freed++;
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
 #endif
@@ -205,8 +266,6 @@ void run_gc(EngineState *s) {
 		}
 	}
 
-	delete activeRefs;
-
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -214,6 +273,105 @@ void run_gc(EngineState *s) {
 		if (segcount[i])
 			debugC(kDebugLevelGC, "\t%d\t* %s", segcount[i], segnames[i]);
 #endif
+
+	return freed;
+}
+
+void run_gc(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+	uint32 startTime = g_system->getMillis();
+
+	debugC(kDebugLevelGC, "[GC] Running...");
+
+	// A full collection makes any incremental marking obsolete
+	s->_gc->cancelCycle(segMan);
+
+	// Compute the set of all segments references currently in use.
+	AddrSet *activeRefs = findAllActiveReferences(s);
+
+	GCStats &stats = s->_gc->getStats();
+	stats.freed += sweep(segMan, *activeRefs);
+	stats.fullCollections++;
+	stats.addPause(g_system->getMillis() - startTime);
+
+	delete activeRefs;
+}
+
+void GCStats::reset() {
+	fullCollections = 0;
+	cycles = 0;
+	steps = 0;
+	pauses = 0;
+	lastPause = 0;
+	maxPause = 0;
+	totalPause = 0;
+	freed = 0;
+}
+
+void GCStats::addPause(uint32 duration) {
+	pauses++;
+	lastPause = duration;
+	maxPause = MAX(maxPause, duration);
+	totalPause += duration;
+}
+
+void GarbageCollector::step(EngineState *s) {
+	if (s->scriptGCStepSize <= 0) {
+		run_gc(s);
+		return;
+	}
+
+	SegManager *segMan = s->_segMan;
+	uint32 startTime = g_system->getMillis();
+
+	if (!segMan->isGCMarking()) {
+		debugC(kDebugLevelGC, "[GC] Starting incremental cycle");
+		_wm._worklist.clear();
+		_wm._map.clear();
+		segMan->setGCMarking(true);
+		pushRootSet(s, _wm);
+	}
+
+	// Mark everything stored into the heap or allocated since the last step
+	pushBarrierReferences(segMan, _wm);
+
+	processWorkList(segMan, _wm, segMan->getSegments(), s->scriptGCStepSize);
+	_stats.steps++;
+
+	if (_wm._worklist.empty())
+		finishCycle(s);
+
+	_stats.addPause(g_system->getMillis() - startTime);
+}
+
+void GarbageCollector::finishCycle(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+
+	debugC(kDebugLevelGC, "[GC] Finishing incremental cycle");
+
+	// The registers and the stacks aren't covered by the write barrier, so
+	// their current contents have to be marked as well. Anything already
+	// marked is skipped, so this is usually quick.
+	pushRootSet(s, _wm);
+	pushBarrierReferences(segMan, _wm);
+	processWorkList(segMan, _wm, segMan->getSegments());
+
+	if (g_sci->_gfxPorts)
+		g_sci->_gfxPorts->processEngineHunkList(_wm);
+
+	AddrSet *activeRefs = normalizeAddresses(segMan, _wm._map);
+	cancelCycle(segMan);
+
+	_stats.freed += sweep(segMan, *activeRefs);
+	_stats.cycles++;
+
+	delete activeRefs;
+}
+
+void GarbageCollector::cancelCycle(SegManager *segMan) {
+	segMan->setGCMarking(false);
+	_wm._worklist.clear();
+	_wm._map.clear();
 }
 
 } // End of namespace Sci
@@ -63,6 +63,58 @@ struct WorklistManager {
 	void pushArray(const Common::Array<reg_t> &tmp);
 };
 
+/**
+ * Pause statistics of the garbage collector. Durations are in milliseconds.
+ */
+struct GCStats {
+	uint32 fullCollections; ///< Number of full (non-incremental) collections
+	uint32 cycles;          ///< Number of completed incremental cycles
+	uint32 steps;           ///< Number of incremental marking steps
+	uint32 pauses;          ///< Number of times the VM was paused for the gc
+	uint32 lastPause;
+	uint32 maxPause;
+	uint32 totalPause;
+	uint32 freed;           ///< Number of objects freed
+
+	GCStats() { reset(); }
+	void reset();
+	void addPause(uint32 duration);
+};
+
+/**
+ * Incremental garbage collector. Instead of marking the whole heap at once,
+ * marking is spread over many kernel calls, scanning a bounded number of
+ * objects each time. While a cycle is in progress, SegManager::writeBarrier()
+ * records all references stored into the heap as well as newly allocated
+ * objects, which are then marked as reachable. Once nothing is left to scan,
+ * the roots are scanned again and all unmarked objects are freed.
+ */
+class GarbageCollector {
+public:
+	/**
+	 * Performs one incremental collection step: starts a new cycle if none is
+	 * in progress, and scans at most EngineState::scriptGCStepSize objects of
+	 * the current one. If that empties the worklist, the cycle is finished.
+	 * A step size of 0 or less runs a full collection instead.
+	 * @param s The state in which we should gc
+	 */
+	void step(EngineState *s);
+
+	/**
+	 * Drops the collection cycle in progress, if any.
+	 */
+	void cancelCycle(SegManager *segMan);
+
+	const GCStats &getStats() const { return _stats; }
+	GCStats &getStats() { return _stats; }
+
+private:
+	void finishCycle(EngineState *s);
+
+	WorklistManager _wm;
+	GCStats _stats;
+};
+
 
 } // End of namespace Sci
 
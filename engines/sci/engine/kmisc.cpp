@@ -191,6 +191,7 @@ reg_t kMemorySegment(EngineState *s, int argc, reg_t *argv) {
 reg_t kFlushResources(EngineState *s, int argc, reg_t *argv) {
 	run_gc(s);
 	debugC(kDebugLevelRoom, "Entering room number %d", argv[0].toUint16());
+	g_sci->getResMan()->prefetchRoom(argv[0].toUint16());
 	return s->r_acc;
 }
 
@@ -334,6 +335,8 @@ reg_t kMemory(EngineState *s, int argc, reg_t *argv) {
 			return s->r_acc;
 		}
 
+		s->_segMan->invalidateScriptCode(argv[1]);
+
 		if (ref.isRaw) {
 			if (argv[2].getSegment()) {
 				error("Attempt to poke memory reference %04x:%04x to %04x:%04x", PRINT_REG(argv[2]), PRINT_REG(argv[1]));
@@ -344,6 +347,7 @@ reg_t kMemory(EngineState *s, int argc, reg_t *argv) {
 			if (ref.skipByte)
 				error("Attempt to poke memory at odd offset %04X:%04X", PRINT_REG(argv[1]));
 			*(ref.reg) = argv[2];
+			s->_segMan->writeBarrier(argv[2]);
 		}
 		break;
 	}
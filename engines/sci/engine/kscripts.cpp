@@ -206,6 +206,12 @@ reg_t kScriptID(EngineState *s, int argc, reg_t *argv) {
 	if (argv[0].getSegment())
 		return argv[0];
 
+	// Loading a new script is usually the first step of setting up a room,
+	// so have the resources of the room with the same number prepared
+	// meanwhile
+	if (!s->_segMan->getScriptSegment(script))
+		g_sci->getResMan()->prefetchRoom(script);
+
 	SegmentId scriptSeg = s->_segMan->getScriptSegment(script, SCRIPT_GET_LOAD);
 
 	if (!scriptSeg)
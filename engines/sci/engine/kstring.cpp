@@ -112,8 +112,10 @@ reg_t kStrAt(EngineState *s, int argc, reg_t *argv) {
 	// FIXME: Move this to segman
 	if (dest_r.isRaw) {
 		value = dest_r.raw[offset];
-		if (argc > 2) /* Request to modify this char */
+		if (argc > 2) { /* Request to modify this char */
 			dest_r.raw[offset] = newvalue;
+			s->_segMan->invalidateScriptCode(argv[0]);
+		}
 	} else {
 		if (dest_r.skipByte)
 			offset++;
@@ -64,6 +64,8 @@ void Script::freeScript() {
 	_lockers = 1;
 	_markedAsDeleted = false;
 	_objects.clear();
+
+	invalidateInstructions();
 }
 
 void Script::load(int script_nr, ResourceManager *resMan, ScriptPatcher *scriptPatcher) {
@@ -467,6 +469,34 @@ void Script::mcpyInOut(int dst, const void *src, size_t n) {
 	}
 }
 
+const PMachineInstruction &Script::getInstruction(uint32 offset) {
+	if (_instructionIndex.empty())
+		_instructionIndex.resize(_bufSize);
+
+	uint16 index = _instructionIndex[offset];
+	if (index)
+		return _instructions[index - 1];
+
+	PMachineInstruction instruction;
+	instruction.size = readPMachineInstruction(_buf + offset, instruction.extOpcode, instruction.params);
+
+	// The index can't address more instructions than this, so any further
+	// ones are decoded each time they are executed
+	if (_instructions.size() >= 0xFFFF) {
+		_uncachedInstruction = instruction;
+		return _uncachedInstruction;
+	}
+
+	_instructions.push_back(instruction);
+	_instructionIndex[offset] = _instructions.size();
+	return _instructions.back();
+}
+
+void Script::invalidateInstructions() {
+	_instructionIndex.clear();
+	_instructions.clear();
+}
+
 bool Script::isValidOffset(uint16 offset) const {
 	return offset < _bufSize;
 }
@@ -49,6 +49,15 @@ enum ScriptObjectTypes {
 
 typedef Common::HashMap<uint16, Object> ObjMap;
 
+/**
+ * A decoded PMachine instruction, as returned by readPMachineInstruction().
+ */
+struct PMachineInstruction {
+	byte extOpcode;   /**< Extended opcode, the lowest bit selects byte operands */
+	uint16 size;      /**< Size of the instruction in bytes */
+	int16 params[4];  /**< Operands of the instruction */
+};
+
 class Script : public SegmentObj {
 private:
 	int _nr; /**< Script number */
@@ -75,6 +84,14 @@ private:
 
 	ObjMap _objects;	/**< Table for objects, contains property variables */
 
+	/**
+	 * Index + 1 into _instructions of the instruction decoded at each offset
+	 * of the buffer, or 0 if the offset hasn't been executed yet
+	 */
+	Common::Array<uint16> _instructionIndex;
+	Common::Array<PMachineInstruction> _instructions;
+	PMachineInstruction _uncachedInstruction;
+
 public:
 	int getLocalsOffset() const { return _localsOffset; }
 	uint16 getLocalsCount() const { return _localsCount; }
@@ -92,6 +109,19 @@ public:
 	const ObjMap &getObjectMap() const { return _objects; }
 	bool offsetIsObject(uint16 offset) const;
 
+	/**
+	 * Returns the instruction at the given offset of the buffer. Instructions
+	 * are decoded when they are first executed, and kept until the script is
+	 * freed or its buffer is written to.
+	 * @param offset	Offset of the instruction within the buffer
+	 * @return			The decoded instruction. The reference is only valid
+	 * 					until the next call.
+	 */
+	const PMachineInstruction &getInstruction(uint32 offset);
+
+	/** Discards all decoded instructions, see SegManager::invalidateScriptCode(). */
+	void invalidateInstructions();
+
 public:
 	Script();
 	~Script();
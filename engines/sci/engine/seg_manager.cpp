@@ -40,6 +40,8 @@ SegManager::SegManager(ResourceManager *resMan, ScriptPatcher *scriptPatcher)
 	_saveDirPtr = NULL_REG;
 	_parserPtr = NULL_REG;
 
+	_gcMarking = false;
+
 #ifdef ENABLE_SCI32
 	_arraysSegId = 0;
 	_stringSegId = 0;
@@ -74,11 +76,21 @@ void SegManager::resetSegMan() {
 	_stringSegId = 0;
 #endif
 
+	// Any collection cycle in progress refers to the old heap
+	setGCMarking(false);
+
 	// Reinitialize class table
 	_classTable.clear();
 	createClassTable();
 }
 
+void SegManager::setGCMarking(bool marking) {
+	_gcMarking = marking;
+	_gcShadedRefs.clear();
+	_gcAllocatedRefs.clear();
+	_gcAllocatedSegments.clear();
+}
+
 void SegManager::initSysStrings() {
 	if (getSciVersion() <= SCI_VERSION_1_1) {
 		// We need to allocate system strings in one segment, for compatibility reasons
@@ -124,6 +136,11 @@ SegmentObj *SegManager::allocSegment(SegmentObj *mem, SegmentId *segid) {
 	}
 	_heap[id] = mem;
 
+	// The ID may have belonged to a segment freed during the current
+	// collection cycle, whose marks don't apply to the new one
+	if (_gcMarking)
+		_gcAllocatedSegments.push_back(id);
+
 	return mem;
 }
 
@@ -155,6 +172,7 @@ void SegManager::deallocate(SegmentId seg) {
 	if (mobj->getType() == SEG_TYPE_SCRIPT) {
 		Script *scr = (Script *)mobj;
 		_scriptSegMap.erase(scr->getScriptNumber());
+		_selectorLookupCache.clear();
 		if (scr->getLocalsSegment()) {
 			// Check if the locals segment has already been deallocated.
 			// If the locals block has been stored in a segment with an ID
@@ -398,6 +416,8 @@ reg_t SegManager::allocateHunkEntry(const char *hunk_type, int size) {
 	h->size = size;
 	h->type = hunk_type;
 
+	allocBarrier(addr);
+
 	return addr;
 }
 
@@ -424,6 +444,7 @@ Clone *SegManager::allocateClone(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_clonesSegId, offset);
+	allocBarrier(*addr);
 	return &(table->_table[offset]);
 }
 
@@ -438,6 +459,7 @@ List *SegManager::allocateList(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_listsSegId, offset);
+	allocBarrier(*addr);
 	return &(table->_table[offset]);
 }
 
@@ -452,6 +474,7 @@ Node *SegManager::allocateNode(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_nodesSegId, offset);
+	allocBarrier(*addr);
 	return &(table->_table[offset]);
 }
 
@@ -598,6 +621,12 @@ static inline void setChar(const SegmentRef &ref, uint offset, byte value) {
 		val->setOffset((val->getOffset() & 0xff00) | value);
 }
 
+void SegManager::invalidateScriptCode(reg_t addr) {
+	Script *scr = getScriptIfLoaded(addr.getSegment());
+	if (scr)
+		scr->invalidateInstructions();
+}
+
 // TODO: memcpy, strcpy and strncpy could maybe be folded into a single function
 void SegManager::strncpy(reg_t dest, const char* src, size_t n) {
 	SegmentRef dest_r = dereference(dest);
@@ -606,6 +635,7 @@ void SegManager::strncpy(reg_t dest, const char* src, size_t n) {
 		return;
 	}
 
+	invalidateScriptCode(dest);
 
 	if (dest_r.isRaw) {
 		// raw -> raw
@@ -651,6 +681,7 @@ void SegManager::strncpy(reg_t dest, reg_t src, size_t n) {
 		return;
 	}
 
+	invalidateScriptCode(dest);
 
 	if (src_r.isRaw) {
 		// raw -> *
@@ -693,6 +724,8 @@ void SegManager::memcpy(reg_t dest, const byte* src, size_t n) {
 		return;
 	}
 
+	invalidateScriptCode(dest);
+
 	if (dest_r.isRaw) {
 		// raw -> raw
 		::memcpy((char *)dest_r.raw, src, n);
@@ -723,6 +756,8 @@ void SegManager::memcpy(reg_t dest, reg_t src, size_t n) {
 		return;
 	}
 
+	invalidateScriptCode(dest);
+
 	if (src_r.isRaw) {
 		// raw -> *
 		memcpy(dest, src_r.raw, n);
@@ -817,6 +852,7 @@ byte *SegManager::allocDynmem(int size, const char *descr, reg_t *addr) {
 	SegmentId seg;
 	SegmentObj *mobj = allocSegment(new DynMem(), &seg);
 	*addr = make_reg(seg, 0);
+	allocBarrier(*addr);
 
 	DynMem &d = *(DynMem *)mobj;
 
@@ -855,6 +891,7 @@ SciArray<reg_t> *SegManager::allocateArray(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_arraysSegId, offset);
+	allocBarrier(*addr);
 	return &(table->_table[offset]);
 }
 
@@ -895,6 +932,7 @@ SciString *SegManager::allocateString(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_stringSegId, offset);
+	allocBarrier(*addr);
 	return &(table->_table[offset]);
 }
 
@@ -982,6 +1020,7 @@ int SegManager::instantiateScript(int scriptNum) {
 		scr = allocateScript(scriptNum, &segmentId);
 	}
 
+	_selectorLookupCache.clear();
 	scr->load(scriptNum, _resMan, _scriptPatcher);
 	scr->initializeLocals(this);
 	scr->initializeClasses(this);
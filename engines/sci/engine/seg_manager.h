@@ -26,6 +26,7 @@
 #include "common/scummsys.h"
 #include "common/serializer.h"
 #include "sci/engine/script.h"
+#include "sci/engine/selector.h"
 #include "sci/engine/vm.h"
 #include "sci/engine/vm_types.h"
 #include "sci/engine/segment.h"
@@ -307,6 +308,14 @@ public:
 	 */
 	Common::String getString(reg_t pointer, int entries = 0);
 
+	/**
+	 * Discards the decoded instructions of the script the given address
+	 * points into, if any. Must be called whenever memory is written to
+	 * through a pointer which may refer to a script, as scripts may modify
+	 * their own code.
+	 * @param addr	the address being written to
+	 */
+	void invalidateScriptCode(reg_t addr);
 
 	/**
 	 * Copies a string from src to dest.
@@ -426,6 +435,48 @@ public:
 	void setClassOffset(int index, reg_t offset) { _classTable[index].reg = offset;	}
 	void resizeClassTable(uint32 size) { _classTable.resize(size); }
 
+	/** Cache of lookupSelector() results, cleared when scripts are loaded or freed */
+	SelectorLookupCache &getSelectorLookupCache() { return _selectorLookupCache; }
+
+	/**
+	 * Write barrier for the incremental garbage collector. Must be called for
+	 * every reference stored into heap memory (object variables, locals, list
+	 * nodes, arrays), so that objects which only become reachable through an
+	 * already scanned object aren't freed at the end of the collection cycle.
+	 * @param value		the reference being stored
+	 */
+	void writeBarrier(reg_t value) {
+		if (_gcMarking && value.getSegment())
+			_gcShadedRefs.push_back(value);
+	}
+
+	/**
+	 * Allocation barrier for the incremental garbage collector. Must be
+	 * called for every newly allocated table entry or segment. Unlike
+	 * references passed to writeBarrier(), the new object is scanned even if
+	 * its address has already been marked in the current cycle, as it may
+	 * reuse the address of an object freed since then.
+	 * @param addr		the address of the new object
+	 */
+	void allocBarrier(reg_t addr) {
+		if (_gcMarking)
+			_gcAllocatedRefs.push_back(addr);
+	}
+
+	/**
+	 * Starts or stops recording references for the garbage collector.
+	 * Either way, previously recorded references are dropped.
+	 */
+	void setGCMarking(bool marking);
+	bool isGCMarking() const { return _gcMarking; }
+
+	/** References recorded by the write barrier since the collector last took them */
+	Common::Array<reg_t> &getGCShadedReferences() { return _gcShadedRefs; }
+	/** Objects allocated since the collector last took them, see allocBarrier() */
+	Common::Array<reg_t> &getGCAllocatedReferences() { return _gcAllocatedRefs; }
+	/** Segments allocated since the collector last took them */
+	Common::Array<SegmentId> &getGCAllocatedSegments() { return _gcAllocatedSegments; }
+
 	reg_t getSaveDirPtr() const { return _saveDirPtr; }
 	reg_t getParserPtr() const { return _parserPtr; }
 
@@ -450,6 +501,13 @@ private:
 	ResourceManager *_resMan;
 	ScriptPatcher *_scriptPatcher;
 
+	SelectorLookupCache _selectorLookupCache;
+
+	bool _gcMarking; ///< Whether an incremental collection cycle is in progress
+	Common::Array<reg_t> _gcShadedRefs;
+	Common::Array<reg_t> _gcAllocatedRefs;
+	Common::Array<SegmentId> _gcAllocatedSegments;
+
 	SegmentId _clonesSegId; ///< ID of the (a) clones segment
 	SegmentId _listsSegId; ///< ID of the (a) list segment
 	SegmentId _nodesSegId; ///< ID of the (a) node segment
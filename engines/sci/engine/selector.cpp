@@ -211,8 +211,10 @@ void writeSelector(SegManager *segMan, reg_t object, Selector selectorId, reg_t
 	if (lookupSelector(segMan, object, selectorId, &address, NULL) != kSelectorVariable)
 		error("Selector '%s' of object at %04x:%04x could not be"
 		         " written to", g_sci->getKernel()->getSelectorName(selectorId).c_str(), PRINT_REG(object));
-	else
+	else {
 		*address.getPointer(segMan) = value;
+		segMan->writeBarrier(value);
+	}
 }
 
 void invokeSelector(EngineState *s, reg_t object, int selectorId,
@@ -250,38 +252,46 @@ void invokeSelector(EngineState *s, reg_t object, int selectorId,
 	run_vm(s); // Start a new vm
 }
 
-SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector selectorId, ObjVarRef *varp, reg_t *fptr) {
-	const Object *obj = segMan->getObject(obj_location);
-	int index;
-	bool oldScriptHeader = (getSciVersion() == SCI_VERSION_0_EARLY);
-
-	// Early SCI versions used the LSB in the selector ID as a read/write
-	// toggle, meaning that we must remove it for selector lookup.
-	if (oldScriptHeader)
-		selectorId &= ~1;
+bool SelectorLookupCache::makeKey(const Object *obj, Selector selectorId, Key &key) {
+	key.baseObj = obj->getBaseObject();
+	key.superClass = obj->getSuperClassSelector();
+	key.selectorId = selectorId;
+	key.isClass = obj->isClass();
+	return key.baseObj != NULL;
+}
 
-	if (!obj) {
-		error("lookupSelector(): Attempt to send to non-object or invalid script. Address was %04x:%04x",
-				PRINT_REG(obj_location));
+const SelectorLookupCache::Result *SelectorLookupCache::find(const Object *obj, Selector selectorId) {
+	Key key;
+	if (makeKey(obj, selectorId, key)) {
+		Common::HashMap<Key, Result, KeyHash, KeyEqual>::const_iterator i = _results.find(key);
+		if (i != _results.end()) {
+			++_hits;
+			return &i->_value;
+		}
 	}
 
-	index = obj->locateVarSelector(segMan, selectorId);
+	++_misses;
+	return NULL;
+}
+
+void SelectorLookupCache::add(const Object *obj, Selector selectorId, const Result &result) {
+	Key key;
+	if (makeKey(obj, selectorId, key))
+		_results[key] = result;
+}
 
-	if (index >= 0) {
+static SelectorType lookupSelectorUncached(SegManager *segMan, const Object *obj, Selector selectorId, int &varIndex, reg_t &funcPtr) {
+	varIndex = obj->locateVarSelector(segMan, selectorId);
+
+	if (varIndex >= 0) {
 		// Found it as a variable
-		if (varp) {
-			varp->obj = obj_location;
-			varp->varindex = index;
-		}
 		return kSelectorVariable;
 	} else {
 		// Check if it's a method, with recursive lookup in superclasses
 		while (obj) {
-			index = obj->funcSelectorPosition(selectorId);
+			int index = obj->funcSelectorPosition(selectorId);
 			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
+				funcPtr = obj->getFunction(index);
 				return kSelectorMethod;
 			} else {
 				obj = segMan->getObject(obj->getSuperClassSelector());
@@ -290,9 +300,42 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 
 		return kSelectorNone;
 	}
+}
+
+SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector selectorId, ObjVarRef *varp, reg_t *fptr) {
+	const Object *obj = segMan->getObject(obj_location);
+	bool oldScriptHeader = (getSciVersion() == SCI_VERSION_0_EARLY);
+
+	// Early SCI versions used the LSB in the selector ID as a read/write
+	// toggle, meaning that we must remove it for selector lookup.
+	if (oldScriptHeader)
+		selectorId &= ~1;
+
+	if (!obj) {
+		error("lookupSelector(): Attempt to send to non-object or invalid script. Address was %04x:%04x",
+				PRINT_REG(obj_location));
+	}
 
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+	SelectorLookupCache::Result result;
+	const SelectorLookupCache::Result *cached = cache.find(obj, selectorId);
+	if (cached) {
+		result = *cached;
+	} else {
+		result.varIndex = -1;
+		result.funcPtr = NULL_REG;
+		result.type = lookupSelectorUncached(segMan, obj, selectorId, result.varIndex, result.funcPtr);
+		cache.add(obj, selectorId, result);
+	}
+
+	if (result.type == kSelectorVariable && varp) {
+		varp->obj = obj_location;
+		varp->varindex = result.varIndex;
+	} else if (result.type == kSelectorMethod && fptr) {
+		*fptr = result.funcPtr;
+	}
 
-//	return _lookupSelector_function(segMan, obj, selectorId, fptr);
+	return result.type;
 }
 
 } // End of namespace Sci
@@ -24,12 +24,15 @@
 #define SCI_ENGINE_SELECTOR_H
 
 #include "common/scummsys.h"
+#include "common/hashmap.h"
 
 #include "sci/engine/vm_types.h"	// for reg_t
 #include "sci/engine/vm.h"
 
 namespace Sci {
 
+class Object;
+
 /** Contains selector IDs for a few selected selectors */
 struct SelectorCache {
 	SelectorCache() {
@@ -185,6 +188,69 @@ reg_t readSelector(SegManager *segMan, reg_t object, Selector selectorId);
 void writeSelector(SegManager *segMan, reg_t object, Selector selectorId, reg_t value);
 #define writeSelectorValue(segMan, _obj_, _slc_, _val_) writeSelector(segMan, _obj_, _slc_, make_reg(0, _val_))
 
+/**
+ * Caches the results of lookupSelector(). The result only depends on the
+ * definition of the object in its script, on its superclass and on the
+ * selector, so it is shared by all clones of an object. The cache must be
+ * cleared whenever a script is loaded or freed.
+ */
+class SelectorLookupCache {
+public:
+	struct Result {
+		SelectorType type;
+		int varIndex;   ///< Index of the variable, for kSelectorVariable
+		reg_t funcPtr;  ///< Address of the method, for kSelectorMethod
+	};
+
+	SelectorLookupCache() : _hits(0), _misses(0) {}
+
+	/**
+	 * Finds the cached result of looking up a selector.
+	 * @param obj			The object the selector is looked up in
+	 * @param selectorId	The selector
+	 * @return				The result, or NULL if it isn't cached
+	 */
+	const Result *find(const Object *obj, Selector selectorId);
+
+	/** Stores the result of looking up a selector. */
+	void add(const Object *obj, Selector selectorId, const Result &result);
+
+	void clear() { _results.clear(); }
+
+	uint getSize() const { return _results.size(); }
+	uint32 getHits() const { return _hits; }
+	uint32 getMisses() const { return _misses; }
+	void resetStats() { _hits = _misses = 0; }
+
+private:
+	struct Key {
+		const byte *baseObj;
+		reg_t superClass;
+		Selector selectorId;
+		bool isClass;
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const {
+			return (uint)(size_t)key.baseObj ^ (key.superClass.getSegment() << 20) ^
+			       (key.superClass.getOffset() << 4) ^ (key.selectorId * 2654435761U) ^ key.isClass;
+		}
+	};
+
+	struct KeyEqual {
+		bool operator()(const Key &a, const Key &b) const {
+			return a.baseObj == b.baseObj && a.superClass == b.superClass &&
+			       a.selectorId == b.selectorId && a.isClass == b.isClass;
+		}
+	};
+
+	static bool makeKey(const Object *obj, Selector selectorId, Key &key);
+
+	Common::HashMap<Key, Result, KeyHash, KeyEqual> _results;
+	uint32 _hits;
+	uint32 _misses;
+};
+
 /**
  * Invokes a selector from an object.
  */
@@ -27,6 +27,7 @@
 #include "sci/event.h"
 
 #include "sci/engine/file.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/kernel.h"
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
@@ -75,10 +76,12 @@ EngineState::EngineState(SegManager *segMan)
 #endif
 	_dirseeker() {
 
+	_gc = new GarbageCollector();
 	reset(false);
 }
 
 EngineState::~EngineState() {
+	delete _gc;
 	delete _msgState;
 #ifdef ENABLE_SCI32
 	delete _virtualIndexFile;
@@ -119,6 +122,7 @@ void EngineState::reset(bool isRestoring) {
 
 	scriptStepCounter = 0;
 	scriptGCInterval = GC_INTERVAL;
+	scriptGCStepSize = GC_STEP_SIZE;
 
 	_videoState.reset();
 	_syncedAudioOptions = false;
@@ -46,6 +46,7 @@ namespace Sci {
 class FileHandle;
 class DirSeeker;
 class EventManager;
+class GarbageCollector;
 class MessageState;
 class SoundCommandParser;
 class VirtualIndexFile;
@@ -168,6 +169,7 @@ public:
 
 	int scriptStepCounter; // Counts the number of steps executed
 	int scriptGCInterval; // Number of steps in between gcs
+	int scriptGCStepSize; // Number of objects scanned per incremental gc step
 
 	uint16 currentRoomNumber() const;
 	void setRoomNumber(uint16 roomNumber);
@@ -184,6 +186,7 @@ public:
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	GarbageCollector *_gc;
 
 	MessageState *_msgState;
 
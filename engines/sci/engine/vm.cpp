@@ -46,6 +46,18 @@ const reg_t TRUE_REG = {0, 1};
 // to an infinite loop). Aids in detecting script bugs such as #3040722.
 //#define ABORT_ON_INFINITE_LOOP
 
+// Compilers supporting labels as values (GCC and Clang) jump straight to the
+// code of an opcode through a table, instead of going through the switch.
+// __extension__ keeps -pedantic from warning about it.
+#if defined(__GNUC__)
+#define SCI_VM_COMPUTED_GOTO
+#define OPCODE(op) case op: opcode_##op
+#define OPCODE_LABEL(op) __extension__ &&opcode_##op
+#define DISPATCH_OPCODE(opcode) __extension__ ({ goto *opcodeLabels[opcode]; })
+#else
+#define OPCODE(op) case op
+#endif
+
 // validation functionality
 
 static reg_t &validate_property(EngineState *s, Object *obj, int index) {
@@ -187,6 +199,7 @@ static void write_var(EngineState *s, int type, int index, reg_t value) {
 				if (lookupSelector(s->_segMan, stopGroopPos, SELECTOR(client), &varp, NULL) == kSelectorVariable) {
 					reg_t *clientVar = varp.getPointer(s->_segMan);
 					*clientVar = value;
+					s->_segMan->writeBarrier(value);
 				}
 			}
 		}
@@ -200,6 +213,10 @@ static void write_var(EngineState *s, int type, int index, reg_t value) {
 
 		s->variables[type][index] = value;
 
+		// Temps and params live on the stack, which the gc rescans anyway
+		if (type == VAR_GLOBAL || type == VAR_LOCAL)
+			s->_segMan->writeBarrier(value);
+
 		if (type == VAR_GLOBAL && index == 90) {
 			// The game is trying to change its speech/subtitle settings
 			if (!g_sci->getEngineState()->_syncedAudioOptions || s->variables[VAR_GLOBAL][4] == TRUE_REG) {
@@ -257,6 +274,7 @@ static void _exec_varselectors(EngineState *s) {
 			// varselector access?
 			if (xs.argc) { // write?
 				*var = xs.variables_argp[1];
+				s->_segMan->writeBarrier(*var);
 
 			} else // No, read
 				s->r_acc = *var;
@@ -567,6 +585,44 @@ void run_vm(EngineState *s) {
 	byte prevOpcode = 0xFF;
 #endif
 
+#ifdef SCI_VM_COMPUTED_GOTO
+	// Addresses of the code of each opcode, indexed by opcode
+	static const void *const opcodeLabels[128] = {
+		OPCODE_LABEL(op_bnot), OPCODE_LABEL(op_add), OPCODE_LABEL(op_sub), OPCODE_LABEL(op_mul),
+		OPCODE_LABEL(op_div), OPCODE_LABEL(op_mod), OPCODE_LABEL(op_shr), OPCODE_LABEL(op_shl),
+		OPCODE_LABEL(op_xor), OPCODE_LABEL(op_and), OPCODE_LABEL(op_or), OPCODE_LABEL(op_neg),
+		OPCODE_LABEL(op_not), OPCODE_LABEL(op_eq_), OPCODE_LABEL(op_ne_), OPCODE_LABEL(op_gt_),
+		OPCODE_LABEL(op_ge_), OPCODE_LABEL(op_lt_), OPCODE_LABEL(op_le_), OPCODE_LABEL(op_ugt_),
+		OPCODE_LABEL(op_uge_), OPCODE_LABEL(op_ult_), OPCODE_LABEL(op_ule_), OPCODE_LABEL(op_bt),
+		OPCODE_LABEL(op_bnt), OPCODE_LABEL(op_jmp), OPCODE_LABEL(op_ldi), OPCODE_LABEL(op_push),
+		OPCODE_LABEL(op_pushi), OPCODE_LABEL(op_toss), OPCODE_LABEL(op_dup), OPCODE_LABEL(op_link),
+		OPCODE_LABEL(op_call), OPCODE_LABEL(op_callk), OPCODE_LABEL(op_callb), OPCODE_LABEL(op_calle),
+		OPCODE_LABEL(op_ret), OPCODE_LABEL(op_send), OPCODE_LABEL(0x26), OPCODE_LABEL(0x27),
+		OPCODE_LABEL(op_class), OPCODE_LABEL(0x29), OPCODE_LABEL(op_self), OPCODE_LABEL(op_super),
+		OPCODE_LABEL(op_rest), OPCODE_LABEL(op_lea), OPCODE_LABEL(op_selfID), OPCODE_LABEL(0x2f),
+		OPCODE_LABEL(op_pprev), OPCODE_LABEL(op_pToa), OPCODE_LABEL(op_aTop), OPCODE_LABEL(op_pTos),
+		OPCODE_LABEL(op_sTop), OPCODE_LABEL(op_ipToa), OPCODE_LABEL(op_dpToa), OPCODE_LABEL(op_ipTos),
+		OPCODE_LABEL(op_dpTos), OPCODE_LABEL(op_lofsa), OPCODE_LABEL(op_lofss), OPCODE_LABEL(op_push0),
+		OPCODE_LABEL(op_push1), OPCODE_LABEL(op_push2), OPCODE_LABEL(op_pushSelf), OPCODE_LABEL(op_line),
+		OPCODE_LABEL(op_lag), OPCODE_LABEL(op_lal), OPCODE_LABEL(op_lat), OPCODE_LABEL(op_lap),
+		OPCODE_LABEL(op_lsg), OPCODE_LABEL(op_lsl), OPCODE_LABEL(op_lst), OPCODE_LABEL(op_lsp),
+		OPCODE_LABEL(op_lagi), OPCODE_LABEL(op_lali), OPCODE_LABEL(op_lati), OPCODE_LABEL(op_lapi),
+		OPCODE_LABEL(op_lsgi), OPCODE_LABEL(op_lsli), OPCODE_LABEL(op_lsti), OPCODE_LABEL(op_lspi),
+		OPCODE_LABEL(op_sag), OPCODE_LABEL(op_sal), OPCODE_LABEL(op_sat), OPCODE_LABEL(op_sap),
+		OPCODE_LABEL(op_ssg), OPCODE_LABEL(op_ssl), OPCODE_LABEL(op_sst), OPCODE_LABEL(op_ssp),
+		OPCODE_LABEL(op_sagi), OPCODE_LABEL(op_sali), OPCODE_LABEL(op_sati), OPCODE_LABEL(op_sapi),
+		OPCODE_LABEL(op_ssgi), OPCODE_LABEL(op_ssli), OPCODE_LABEL(op_ssti), OPCODE_LABEL(op_sspi),
+		OPCODE_LABEL(op_plusag), OPCODE_LABEL(op_plusal), OPCODE_LABEL(op_plusat), OPCODE_LABEL(op_plusap),
+		OPCODE_LABEL(op_plussg), OPCODE_LABEL(op_plussl), OPCODE_LABEL(op_plusst), OPCODE_LABEL(op_plussp),
+		OPCODE_LABEL(op_plusagi), OPCODE_LABEL(op_plusali), OPCODE_LABEL(op_plusati), OPCODE_LABEL(op_plusapi),
+		OPCODE_LABEL(op_plussgi), OPCODE_LABEL(op_plussli), OPCODE_LABEL(op_plussti), OPCODE_LABEL(op_plusspi),
+		OPCODE_LABEL(op_minusag), OPCODE_LABEL(op_minusal), OPCODE_LABEL(op_minusat), OPCODE_LABEL(op_minusap),
+		OPCODE_LABEL(op_minussg), OPCODE_LABEL(op_minussl), OPCODE_LABEL(op_minusst), OPCODE_LABEL(op_minussp),
+		OPCODE_LABEL(op_minusagi), OPCODE_LABEL(op_minusali), OPCODE_LABEL(op_minusati), OPCODE_LABEL(op_minusapi),
+		OPCODE_LABEL(op_minussgi), OPCODE_LABEL(op_minussli), OPCODE_LABEL(op_minussti), OPCODE_LABEL(op_minusspi)
+	};
+#endif
+
 	while (1) {
 		int var_type; // See description below
 		int var_number;
@@ -597,6 +653,10 @@ void run_vm(EngineState *s) {
 			}
 			s->variables[VAR_TEMP] = s->xs->fp;
 			s->variables[VAR_PARAM] = s->xs->variables_argp;
+
+			// Let the debugger count down to attaching, once per execution
+			// frame rather than for each instruction
+			g_sci->getSciDebugger()->onFrame();
 		}
 
 		if (s->abortScriptProcessing != kAbortNone)
@@ -607,9 +667,10 @@ void run_vm(EngineState *s) {
 		if (g_sci->_debugState.debugging /* sci_debug_flags*/) {
 			g_sci->scriptDebug();
 			g_sci->_debugState.breakpointWasHit = false;
+			// scriptDebug() may have asked the console to attach, which
+			// only happens on the next onFrame() call
+			g_sci->getSciDebugger()->onFrame();
 		}
-		Console *con = g_sci->getSciDebugger();
-		con->onFrame();
 
 		if (s->xs->sp < s->xs->fp)
 			error("run_vm(): stack underflow, sp: %04x:%04x, fp: %04x:%04x",
@@ -621,10 +682,13 @@ void run_vm(EngineState *s) {
 			error("run_vm(): program counter gone astray, addr: %d, code buffer size: %d",
 			s->xs->addr.pc.getOffset(), scr->getBufSize());
 
-		// Get opcode
-		byte extOpcode;
-		s->xs->addr.pc.incOffset(readPMachineInstruction(scr->getBuf(s->xs->addr.pc.getOffset()), extOpcode, opparams));
+		// Get opcode. The operands are copied, as the instruction may be
+		// discarded while it is executed.
+		const PMachineInstruction &instruction = scr->getInstruction(s->xs->addr.pc.getOffset());
+		s->xs->addr.pc.incOffset(instruction.size);
+		const byte extOpcode = instruction.extOpcode;
 		const byte opcode = extOpcode >> 1;
+		memcpy(opparams, instruction.params, sizeof(opparams));
 		//debug("%s: %d, %d, %d, %d, acc = %04x:%04x, script %d, local script %d", opcodeNames[opcode], opparams[0], opparams[1], opparams[2], opparams[3], PRINT_REG(s->r_acc), scr->getScriptNumber(), local_script->getScriptNumber());
 
 #ifdef ABORT_ON_INFINITE_LOOP
@@ -642,121 +706,125 @@ void run_vm(EngineState *s) {
 		prevOpcode = opcode;
 #endif
 
+#ifdef SCI_VM_COMPUTED_GOTO
+		DISPATCH_OPCODE(opcode);
+#endif
+
 		switch (opcode) {
 
-		case op_bnot: // 0x00 (00)
+		OPCODE(op_bnot): // 0x00 (00)
 			// Binary not
 			s->r_acc = make_reg(0, 0xffff ^ s->r_acc.requireUint16());
 			break;
 
-		case op_add: // 0x01 (01)
+		OPCODE(op_add): // 0x01 (01)
 			s->r_acc = POP32() + s->r_acc;
 			break;
 
-		case op_sub: // 0x02 (02)
+		OPCODE(op_sub): // 0x02 (02)
 			s->r_acc = POP32() - s->r_acc;
 			break;
 
-		case op_mul: // 0x03 (03)
+		OPCODE(op_mul): // 0x03 (03)
 			s->r_acc = POP32() * s->r_acc;
 			break;
 
-		case op_div: // 0x04 (04)
+		OPCODE(op_div): // 0x04 (04)
 			// we check for division by 0 inside the custom reg_t division operator
 			s->r_acc = POP32() / s->r_acc;
 			break;
 
-		case op_mod: // 0x05 (05)
+		OPCODE(op_mod): // 0x05 (05)
 			// we check for division by 0 inside the custom reg_t modulo operator
 			s->r_acc = POP32() % s->r_acc;
 			break;
 
-		case op_shr: // 0x06 (06)
+		OPCODE(op_shr): // 0x06 (06)
 			// Shift right logical
 			s->r_acc = POP32() >> s->r_acc;
 			break;
 
-		case op_shl: // 0x07 (07)
+		OPCODE(op_shl): // 0x07 (07)
 			// Shift left logical
 			s->r_acc = POP32() << s->r_acc;
 			break;
 
-		case op_xor: // 0x08 (08)
+		OPCODE(op_xor): // 0x08 (08)
 			s->r_acc = POP32() ^ s->r_acc;
 			break;
 
-		case op_and: // 0x09 (09)
+		OPCODE(op_and): // 0x09 (09)
 			s->r_acc = POP32() & s->r_acc;
 			break;
 
-		case op_or: // 0x0a (10)
+		OPCODE(op_or): // 0x0a (10)
 			s->r_acc = POP32() | s->r_acc;
 			break;
 
-		case op_neg:	// 0x0b (11)
+		OPCODE(op_neg):	// 0x0b (11)
 			s->r_acc = make_reg(0, -s->r_acc.requireSint16());
 			break;
 
-		case op_not: // 0x0c (12)
+		OPCODE(op_not): // 0x0c (12)
 			s->r_acc = make_reg(0, !(s->r_acc.getOffset() || s->r_acc.getSegment()));
 			// Must allow pointers to be negated, as this is used for checking whether objects exist
 			break;
 
-		case op_eq_: // 0x0d (13)
+		OPCODE(op_eq_): // 0x0d (13)
 			s->r_prev = s->r_acc;
 			s->r_acc  = make_reg(0, POP32() == s->r_acc);
 			break;
 
-		case op_ne_: // 0x0e (14)
+		OPCODE(op_ne_): // 0x0e (14)
 			s->r_prev = s->r_acc;
 			s->r_acc  = make_reg(0, POP32() != s->r_acc);
 			break;
 
-		case op_gt_: // 0x0f (15)
+		OPCODE(op_gt_): // 0x0f (15)
 			s->r_prev = s->r_acc;
 			s->r_acc  = make_reg(0, POP32() > s->r_acc);
 			break;
 
-		case op_ge_: // 0x10 (16)
+		OPCODE(op_ge_): // 0x10 (16)
 			s->r_prev = s->r_acc;
 			s->r_acc  = make_reg(0, POP32() >= s->r_acc);
 			break;
 
-		case op_lt_: // 0x11 (17)
+		OPCODE(op_lt_): // 0x11 (17)
 			s->r_prev = s->r_acc;
 			s->r_acc  = make_reg(0, POP32() < s->r_acc);
 			break;
 
-		case op_le_: // 0x12 (18)
+		OPCODE(op_le_): // 0x12 (18)
 			s->r_prev = s->r_acc;
 			s->r_acc  = make_reg(0, POP32() <= s->r_acc);
 			break;
 
-		case op_ugt_: // 0x13 (19)
+		OPCODE(op_ugt_): // 0x13 (19)
 			// > (unsigned)
 			s->r_prev = s->r_acc;
 			s->r_acc  = make_reg(0, POP32().gtU(s->r_acc));
 			break;
 
-		case op_uge_: // 0x14 (20)
+		OPCODE(op_uge_): // 0x14 (20)
 			// >= (unsigned)
 			s->r_prev = s->r_acc;
 			s->r_acc  = make_reg(0, POP32().geU(s->r_acc));
 			break;
 
-		case op_ult_: // 0x15 (21)
+		OPCODE(op_ult_): // 0x15 (21)
 			// < (unsigned)
 			s->r_prev = s->r_acc;
 			s->r_acc  = make_reg(0, POP32().ltU(s->r_acc));
 			break;
 
-		case op_ule_: // 0x16 (22)
+		OPCODE(op_ule_): // 0x16 (22)
 			// <= (unsigned)
 			s->r_prev = s->r_acc;
 			s->r_acc  = make_reg(0, POP32().leU(s->r_acc));
 			break;
 
-		case op_bt: // 0x17 (23)
+		OPCODE(op_bt): // 0x17 (23)
 			// Branch relative if true
 			if (s->r_acc.getOffset() || s->r_acc.getSegment())
 				s->xs->addr.pc.incOffset(opparams[0]);
@@ -766,7 +834,7 @@ void run_vm(EngineState *s) {
 					local_script->getScriptNumber(), s->xs->addr.pc.getOffset(), local_script->getScriptSize());
 			break;
 
-		case op_bnt: // 0x18 (24)
+		OPCODE(op_bnt): // 0x18 (24)
 			// Branch relative if not true
 			if (!(s->r_acc.getOffset() || s->r_acc.getSegment()))
 				s->xs->addr.pc.incOffset(opparams[0]);
@@ -776,7 +844,7 @@ void run_vm(EngineState *s) {
 					local_script->getScriptNumber(), s->xs->addr.pc.getOffset(), local_script->getScriptSize());
 			break;
 
-		case op_jmp: // 0x19 (25)
+		OPCODE(op_jmp): // 0x19 (25)
 			s->xs->addr.pc.incOffset(opparams[0]);
 
 			if (s->xs->addr.pc.getOffset() >= local_script->getScriptSize())
@@ -784,33 +852,33 @@ void run_vm(EngineState *s) {
 					local_script->getScriptNumber(), s->xs->addr.pc.getOffset(), local_script->getScriptSize());
 			break;
 
-		case op_ldi: // 0x1a (26)
+		OPCODE(op_ldi): // 0x1a (26)
 			// Load data immediate
 			s->r_acc = make_reg(0, opparams[0]);
 			break;
 
-		case op_push: // 0x1b (27)
+		OPCODE(op_push): // 0x1b (27)
 			// Push to stack
 			PUSH32(s->r_acc);
 			break;
 
-		case op_pushi: // 0x1c (28)
+		OPCODE(op_pushi): // 0x1c (28)
 			// Push immediate
 			PUSH(opparams[0]);
 			break;
 
-		case op_toss: // 0x1d (29)
+		OPCODE(op_toss): // 0x1d (29)
 			// TOS (Top Of Stack) subtract
 			s->xs->sp--;
 			break;
 
-		case op_dup: // 0x1e (30)
+		OPCODE(op_dup): // 0x1e (30)
 			// Duplicate TOD (Top Of Stack) element
 			r_temp = s->xs->sp[-1];
 			PUSH32(r_temp);
 			break;
 
-		case op_link: // 0x1f (31)
+		OPCODE(op_link): // 0x1f (31)
 			// We shouldn't initialize temp variables at all
 			//  We put special segment 0xFFFF in there, so that uninitialized reads can get detected
 			for (int i = 0; i < opparams[0]; i++)
@@ -819,7 +887,7 @@ void run_vm(EngineState *s) {
 			s->xs->sp += opparams[0];
 			break;
 
-		case op_call: { // 0x20 (32)
+		OPCODE(op_call): { // 0x20 (32)
 			// Call a script subroutine
 			int argc = (opparams[1] >> 1) // Given as offset, but we need count
 			           + 1 + s->r_rest;
@@ -844,11 +912,14 @@ void run_vm(EngineState *s) {
 			break;
 		}
 
-		case op_callk: { // 0x21 (33)
-			// Run the garbage collector, if needed
-			if (s->gcCountDown-- <= 0) {
+		OPCODE(op_callk): { // 0x21 (33)
+			// Run the garbage collector, if needed. Once a cycle has been
+			// started, it advances a little with every kernel call.
+			if (s->_segMan->isGCMarking()) {
+				s->_gc->step(s);
+			} else if (s->gcCountDown-- <= 0) {
 				s->gcCountDown = s->scriptGCInterval;
-				run_gc(s);
+				s->_gc->step(s);
 			}
 
 			// Call kernel function
@@ -881,7 +952,7 @@ void run_vm(EngineState *s) {
 			break;
 		}
 
-		case op_callb: // 0x22 (34)
+		OPCODE(op_callb): // 0x22 (34)
 			// Call base script
 			temp = ((opparams[1] >> 1) + s->r_rest + 1);
 			s_temp = s->xs->sp;
@@ -895,7 +966,7 @@ void run_vm(EngineState *s) {
 				s->_executionStackPosChanged = true;
 			break;
 
-		case op_calle: // 0x23 (35)
+		OPCODE(op_calle): // 0x23 (35)
 			// Call external script
 			temp = ((opparams[2] >> 1) + s->r_rest + 1);
 			s_temp = s->xs->sp;
@@ -909,7 +980,7 @@ void run_vm(EngineState *s) {
 				s->_executionStackPosChanged = true;
 			break;
 
-		case op_ret: // 0x24 (36)
+		OPCODE(op_ret): // 0x24 (36)
 			// Return from an execution loop started by call, calle, callb, send, self or super
 			do {
 				StackPtr old_sp2 = s->xs->sp;
@@ -928,9 +999,10 @@ void run_vm(EngineState *s) {
 				if (old_xs->type == EXEC_STACK_TYPE_VARSELECTOR) {
 					// varselector access?
 					reg_t *var = old_xs->getVarPointer(s->_segMan);
-					if (old_xs->argc) // write?
+					if (old_xs->argc) { // write?
 						*var = old_xs->variables_argp[1];
-					else // No, read
+						s->_segMan->writeBarrier(*var);
+					} else // No, read
 						s->r_acc = *var;
 				}
 
@@ -952,7 +1024,7 @@ void run_vm(EngineState *s) {
 
 			break;
 
-		case op_send: // 0x25 (37)
+		OPCODE(op_send): // 0x25 (37)
 			// Send for one or more selectors
 			s_temp = s->xs->sp;
 			s->xs->sp -= ((opparams[0] >> 1) + s->r_rest); // Adjust stack
@@ -968,8 +1040,8 @@ void run_vm(EngineState *s) {
 
 			break;
 
-		case 0x26: // (38)
-		case 0x27: // (39)
+		OPCODE(0x26): // (38)
+		OPCODE(0x27): // (39)
 			if (getSciVersion() == SCI_VERSION_3) {
 				if (extOpcode == 0x4c)
 					s->r_acc = obj->getInfoSelector();
@@ -985,17 +1057,17 @@ void run_vm(EngineState *s) {
 				error("Dummy opcode 0x%x called", opcode);	// should never happen
 			break;
 
-		case op_class: // 0x28 (40)
+		OPCODE(op_class): // 0x28 (40)
 			// Get class address
 			s->r_acc = s->_segMan->getClassAddress((unsigned)opparams[0], SCRIPT_GET_LOCK,
 											s->xs->addr.pc.getSegment());
 			break;
 
-		case 0x29: // (41)
+		OPCODE(0x29): // (41)
 			error("Dummy opcode 0x%x called", opcode);	// should never happen
 			break;
 
-		case op_self: // 0x2a (42)
+		OPCODE(op_self): // 0x2a (42)
 			// Send to self
 			s_temp = s->xs->sp;
 			s->xs->sp -= ((opparams[0] >> 1) + s->r_rest); // Adjust stack
@@ -1011,7 +1083,7 @@ void run_vm(EngineState *s) {
 			s->r_rest = 0;
 			break;
 
-		case op_super: // 0x2b (43)
+		OPCODE(op_super): // 0x2b (43)
 			// Send to any class
 			r_temp = s->_segMan->getClassAddress(opparams[0], SCRIPT_GET_LOAD, s->xs->addr.pc.getSegment());
 
@@ -1034,7 +1106,7 @@ void run_vm(EngineState *s) {
 
 			break;
 
-		case op_rest: // 0x2c (44)
+		OPCODE(op_rest): // 0x2c (44)
 			// Pushes all or part of the parameter variable list on the stack
 			temp = (uint16) opparams[0]; // First argument
 			s->r_rest = MAX<int16>(s->xs->argc - temp + 1, 0); // +1 because temp counts the paramcount while argc doesn't
@@ -1044,7 +1116,7 @@ void run_vm(EngineState *s) {
 
 			break;
 
-		case op_lea: // 0x2d (45)
+		OPCODE(op_lea): // 0x2d (45)
 			// Load Effective Address
 			temp = (uint16) opparams[0] >> 1;
 			var_number = temp & 0x03; // Get variable type
@@ -1063,45 +1135,48 @@ void run_vm(EngineState *s) {
 			break;
 
 
-		case op_selfID: // 0x2e (46)
+		OPCODE(op_selfID): // 0x2e (46)
 			// Get 'self' identity
 			s->r_acc = s->xs->objp;
 			break;
 
-		case 0x2f: // (47)
+		OPCODE(0x2f): // (47)
 			error("Dummy opcode 0x%x called", opcode);	// should never happen
 			break;
 
-		case op_pprev: // 0x30 (48)
+		OPCODE(op_pprev): // 0x30 (48)
 			// Pushes the value of the prev register, set by the last comparison
 			// bytecode (eq?, lt?, etc.), on the stack
 			PUSH32(s->r_prev);
 			break;
 
-		case op_pToa: // 0x31 (49)
+		OPCODE(op_pToa): // 0x31 (49)
 			// Property To Accumulator
 			s->r_acc = validate_property(s, obj, opparams[0]);
 			break;
 
-		case op_aTop: // 0x32 (50)
+		OPCODE(op_aTop): // 0x32 (50)
 			// Accumulator To Property
 			validate_property(s, obj, opparams[0]) = s->r_acc;
+			s->_segMan->writeBarrier(s->r_acc);
 			break;
 
-		case op_pTos: // 0x33 (51)
+		OPCODE(op_pTos): // 0x33 (51)
 			// Property To Stack
 			PUSH32(validate_property(s, obj, opparams[0]));
 			break;
 
-		case op_sTop: // 0x34 (52)
+		OPCODE(op_sTop): // 0x34 (52)
 			// Stack To Property
-			validate_property(s, obj, opparams[0]) = POP32();
+			r_temp = POP32();
+			validate_property(s, obj, opparams[0]) = r_temp;
+			s->_segMan->writeBarrier(r_temp);
 			break;
 
-		case op_ipToa: // 0x35 (53)
-		case op_dpToa: // 0x36 (54)
-		case op_ipTos: // 0x37 (55)
-		case op_dpTos: // 0x38 (56)
+		OPCODE(op_ipToa): // 0x35 (53)
+		OPCODE(op_dpToa): // 0x36 (54)
+		OPCODE(op_ipTos): // 0x37 (55)
+		OPCODE(op_dpTos): // 0x38 (56)
 			{
 			// Increment/decrement a property and copy to accumulator,
 			// or push to stack
@@ -1110,6 +1185,7 @@ void run_vm(EngineState *s) {
 				opProperty += 1;
 			else
 				opProperty -= 1;
+			s->_segMan->writeBarrier(opProperty);
 
 			if (opcode == op_ipToa || opcode == op_dpToa)
 				s->r_acc = opProperty;
@@ -1118,8 +1194,8 @@ void run_vm(EngineState *s) {
 			break;
 		}
 
-		case op_lofsa: // 0x39 (57)
-		case op_lofss: // 0x3a (58)
+		OPCODE(op_lofsa): // 0x39 (57)
+		OPCODE(op_lofss): // 0x3a (58)
 			// Load offset to accumulator or push to stack
 			r_temp.setSegment(s->xs->addr.pc.getSegment());
 
@@ -1152,19 +1228,19 @@ void run_vm(EngineState *s) {
 				PUSH32(r_temp);
 			break;
 
-		case op_push0: // 0x3b (59)
+		OPCODE(op_push0): // 0x3b (59)
 			PUSH(0);
 			break;
 
-		case op_push1: // 0x3c (60)
+		OPCODE(op_push1): // 0x3c (60)
 			PUSH(1);
 			break;
 
-		case op_push2: // 0x3d (61)
+		OPCODE(op_push2): // 0x3d (61)
 			PUSH(2);
 			break;
 
-		case op_pushSelf: // 0x3e (62)
+		OPCODE(op_pushSelf): // 0x3e (62)
 			// Compensate for a bug in non-Sierra compilers, which seem to generate
 			// pushSelf instructions with the low bit set. This makes the following
 			// heuristic fail and leads to endless loops and crashes. Our
@@ -1178,20 +1254,20 @@ void run_vm(EngineState *s) {
 			}
 			break;
 
-		case op_line: // 0x3f (63)
+		OPCODE(op_line): // 0x3f (63)
 			// Debug opcode (line number)
 			//debug("Script %d, line %d", scr->getScriptNumber(), opparams[0]);
 			break;
 
-		case op_lag: // 0x40 (64)
-		case op_lal: // 0x41 (65)
-		case op_lat: // 0x42 (66)
-		case op_lap: // 0x43 (67)
+		OPCODE(op_lag): // 0x40 (64)
+		OPCODE(op_lal): // 0x41 (65)
+		OPCODE(op_lat): // 0x42 (66)
+		OPCODE(op_lap): // 0x43 (67)
 			// Load global, local, temp or param variable into the accumulator
-		case op_lagi: // 0x48 (72)
-		case op_lali: // 0x49 (73)
-		case op_lati: // 0x4a (74)
-		case op_lapi: // 0x4b (75)
+		OPCODE(op_lagi): // 0x48 (72)
+		OPCODE(op_lali): // 0x49 (73)
+		OPCODE(op_lati): // 0x4a (74)
+		OPCODE(op_lapi): // 0x4b (75)
 			// Same as the 4 ones above, except that the accumulator is used as
 			// an additional index
 			var_type = opcode & 0x3; // Gets the variable type: g, l, t or p
@@ -1199,15 +1275,15 @@ void run_vm(EngineState *s) {
 			s->r_acc = read_var(s, var_type, var_number);
 			break;
 
-		case op_lsg: // 0x44 (68)
-		case op_lsl: // 0x45 (69)
-		case op_lst: // 0x46 (70)
-		case op_lsp: // 0x47 (71)
+		OPCODE(op_lsg): // 0x44 (68)
+		OPCODE(op_lsl): // 0x45 (69)
+		OPCODE(op_lst): // 0x46 (70)
+		OPCODE(op_lsp): // 0x47 (71)
 			// Load global, local, temp or param variable into the stack
-		case op_lsgi: // 0x4c (76)
-		case op_lsli: // 0x4d (77)
-		case op_lsti: // 0x4e (78)
-		case op_lspi: // 0x4f (79)
+		OPCODE(op_lsgi): // 0x4c (76)
+		OPCODE(op_lsli): // 0x4d (77)
+		OPCODE(op_lsti): // 0x4e (78)
+		OPCODE(op_lspi): // 0x4f (79)
 			// Same as the 4 ones above, except that the accumulator is used as
 			// an additional index
 			var_type = opcode & 0x3; // Gets the variable type: g, l, t or p
@@ -1215,15 +1291,15 @@ void run_vm(EngineState *s) {
 			PUSH32(read_var(s, var_type, var_number));
 			break;
 
-		case op_sag: // 0x50 (80)
-		case op_sal: // 0x51 (81)
-		case op_sat: // 0x52 (82)
-		case op_sap: // 0x53 (83)
+		OPCODE(op_sag): // 0x50 (80)
+		OPCODE(op_sal): // 0x51 (81)
+		OPCODE(op_sat): // 0x52 (82)
+		OPCODE(op_sap): // 0x53 (83)
 			// Save the accumulator into the global, local, temp or param variable
-		case op_sagi: // 0x58 (88)
-		case op_sali: // 0x59 (89)
-		case op_sati: // 0x5a (90)
-		case op_sapi: // 0x5b (91)
+		OPCODE(op_sagi): // 0x58 (88)
+		OPCODE(op_sali): // 0x59 (89)
+		OPCODE(op_sati): // 0x5a (90)
+		OPCODE(op_sapi): // 0x5b (91)
 			// Save the accumulator into the global, local, temp or param variable,
 			// using the accumulator as an additional index
 			var_type = opcode & 0x3; // Gets the variable type: g, l, t or p
@@ -1233,15 +1309,15 @@ void run_vm(EngineState *s) {
 			write_var(s, var_type, var_number, s->r_acc);
 			break;
 
-		case op_ssg: // 0x54 (84)
-		case op_ssl: // 0x55 (85)
-		case op_sst: // 0x56 (86)
-		case op_ssp: // 0x57 (87)
+		OPCODE(op_ssg): // 0x54 (84)
+		OPCODE(op_ssl): // 0x55 (85)
+		OPCODE(op_sst): // 0x56 (86)
+		OPCODE(op_ssp): // 0x57 (87)
 			// Save the stack into the global, local, temp or param variable
-		case op_ssgi: // 0x5c (92)
-		case op_ssli: // 0x5d (93)
-		case op_ssti: // 0x5e (94)
-		case op_sspi: // 0x5f (95)
+		OPCODE(op_ssgi): // 0x5c (92)
+		OPCODE(op_ssli): // 0x5d (93)
+		OPCODE(op_ssti): // 0x5e (94)
+		OPCODE(op_sspi): // 0x5f (95)
 			// Same as the 4 ones above, except that the accumulator is used as
 			// an additional index
 			var_type = opcode & 0x3; // Gets the variable type: g, l, t or p
@@ -1249,16 +1325,16 @@ void run_vm(EngineState *s) {
 			write_var(s, var_type, var_number, POP32());
 			break;
 
-		case op_plusag: // 0x60 (96)
-		case op_plusal: // 0x61 (97)
-		case op_plusat: // 0x62 (98)
-		case op_plusap: // 0x63 (99)
+		OPCODE(op_plusag): // 0x60 (96)
+		OPCODE(op_plusal): // 0x61 (97)
+		OPCODE(op_plusat): // 0x62 (98)
+		OPCODE(op_plusap): // 0x63 (99)
 			// Increment the global, local, temp or param variable and save it
 			// to the accumulator
-		case op_plusagi: // 0x68 (104)
-		case op_plusali: // 0x69 (105)
-		case op_plusati: // 0x6a (106)
-		case op_plusapi: // 0x6b (107)
+		OPCODE(op_plusagi): // 0x68 (104)
+		OPCODE(op_plusali): // 0x69 (105)
+		OPCODE(op_plusati): // 0x6a (106)
+		OPCODE(op_plusapi): // 0x6b (107)
 			// Same as the 4 ones above, except that the accumulator is used as
 			// an additional index
 			var_type = opcode & 0x3; // Gets the variable type: g, l, t or p
@@ -1267,16 +1343,16 @@ void run_vm(EngineState *s) {
 			write_var(s, var_type, var_number, s->r_acc);
 			break;
 
-		case op_plussg: // 0x64 (100)
-		case op_plussl: // 0x65 (101)
-		case op_plusst: // 0x66 (102)
-		case op_plussp: // 0x67 (103)
+		OPCODE(op_plussg): // 0x64 (100)
+		OPCODE(op_plussl): // 0x65 (101)
+		OPCODE(op_plusst): // 0x66 (102)
+		OPCODE(op_plussp): // 0x67 (103)
 			// Increment the global, local, temp or param variable and save it
 			// to the stack
-		case op_plussgi: // 0x6c (108)
-		case op_plussli: // 0x6d (109)
-		case op_plussti: // 0x6e (110)
-		case op_plusspi: // 0x6f (111)
+		OPCODE(op_plussgi): // 0x6c (108)
+		OPCODE(op_plussli): // 0x6d (109)
+		OPCODE(op_plussti): // 0x6e (110)
+		OPCODE(op_plusspi): // 0x6f (111)
 			// Same as the 4 ones above, except that the accumulator is used as
 			// an additional index
 			var_type = opcode & 0x3; // Gets the variable type: g, l, t or p
@@ -1286,16 +1362,16 @@ void run_vm(EngineState *s) {
 			write_var(s, var_type, var_number, r_temp);
 			break;
 
-		case op_minusag: // 0x70 (112)
-		case op_minusal: // 0x71 (113)
-		case op_minusat: // 0x72 (114)
-		case op_minusap: // 0x73 (115)
+		OPCODE(op_minusag): // 0x70 (112)
+		OPCODE(op_minusal): // 0x71 (113)
+		OPCODE(op_minusat): // 0x72 (114)
+		OPCODE(op_minusap): // 0x73 (115)
 			// Decrement the global, local, temp or param variable and save it
 			// to the accumulator
-		case op_minusagi: // 0x78 (120)
-		case op_minusali: // 0x79 (121)
-		case op_minusati: // 0x7a (122)
-		case op_minusapi: // 0x7b (123)
+		OPCODE(op_minusagi): // 0x78 (120)
+		OPCODE(op_minusali): // 0x79 (121)
+		OPCODE(op_minusati): // 0x7a (122)
+		OPCODE(op_minusapi): // 0x7b (123)
 			// Same as the 4 ones above, except that the accumulator is used as
 			// an additional index
 			var_type = opcode & 0x3; // Gets the variable type: g, l, t or p
@@ -1304,16 +1380,16 @@ void run_vm(EngineState *s) {
 			write_var(s, var_type, var_number, s->r_acc);
 			break;
 
-		case op_minussg: // 0x74 (116)
-		case op_minussl: // 0x75 (117)
-		case op_minusst: // 0x76 (118)
-		case op_minussp: // 0x77 (119)
+		OPCODE(op_minussg): // 0x74 (116)
+		OPCODE(op_minussl): // 0x75 (117)
+		OPCODE(op_minusst): // 0x76 (118)
+		OPCODE(op_minussp): // 0x77 (119)
 			// Decrement the global, local, temp or param variable and save it
 			// to the stack
-		case op_minussgi: // 0x7c (124)
-		case op_minussli: // 0x7d (125)
-		case op_minussti: // 0x7e (126)
-		case op_minusspi: // 0x7f (127)
+		OPCODE(op_minussgi): // 0x7c (124)
+		OPCODE(op_minussli): // 0x7d (125)
+		OPCODE(op_minussti): // 0x7e (126)
+		OPCODE(op_minusspi): // 0x7f (127)
 			// Same as the 4 ones above, except that the accumulator is used as
 			// an additional index
 			var_type = opcode & 0x3; // Gets the variable type: g, l, t or p
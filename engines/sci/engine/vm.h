@@ -137,6 +137,11 @@ enum {
 	GC_INTERVAL = 0x8000
 };
 
+/** Number of objects scanned per incremental gc step */
+enum {
+	GC_STEP_SIZE = 64
+};
+
 enum SciOpcodes {
 	op_bnot     = 0x00,	// 000
 	op_add      = 0x01,	// 001
@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/stack.h"
 #include "graphics/primitives.h"
@@ -36,54 +37,40 @@ namespace Sci {
 
 GfxCache::GfxCache(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette)
 	: _resMan(resMan), _screen(screen), _palette(palette) {
+	// Budgets are given in KB
+	_cachedFonts.setMaxMemory(ConfMan.getInt("font_cache_size") * 1024);
+	_cachedViews.setMaxMemory(ConfMan.getInt("view_cache_size") * 1024);
 }
 
 GfxCache::~GfxCache() {
-	purgeFontCache();
-	purgeViewCache();
-}
-
-void GfxCache::purgeFontCache() {
-	for (FontCache::iterator iter = _cachedFonts.begin(); iter != _cachedFonts.end(); ++iter) {
-		delete iter->_value;
-		iter->_value = 0;
-	}
-
-	_cachedFonts.clear();
-}
-
-void GfxCache::purgeViewCache() {
-	for (ViewCache::iterator iter = _cachedViews.begin(); iter != _cachedViews.end(); ++iter) {
-		delete iter->_value;
-		iter->_value = 0;
-	}
-
-	_cachedViews.clear();
+	_cachedFonts.purge();
+	_cachedViews.purge();
 }
 
 GfxFont *GfxCache::getFont(GuiResourceId fontId) {
-	if (_cachedFonts.size() >= MAX_CACHED_FONTS)
-		purgeFontCache();
+	GfxFont *font = _cachedFonts.find(fontId);
 
-	if (!_cachedFonts.contains(fontId)) {
+	if (!font) {
 		// Create special SJIS font in japanese games, when font 900 is selected
 		if ((fontId == 900) && (g_sci->getLanguage() == Common::JA_JPN))
-			_cachedFonts[fontId] = new GfxFontSjis(_screen, fontId);
+			font = new GfxFontSjis(_screen, fontId);
 		else
-			_cachedFonts[fontId] = new GfxFontFromResource(_resMan, _screen, fontId);
+			font = new GfxFontFromResource(_resMan, _screen, fontId);
+		_cachedFonts.add(fontId, font);
 	}
 
-	return _cachedFonts[fontId];
+	return font;
 }
 
 GfxView *GfxCache::getView(GuiResourceId viewId) {
-	if (_cachedViews.size() >= MAX_CACHED_VIEWS)
-		purgeViewCache();
+	GfxView *view = _cachedViews.find(viewId);
 
-	if (!_cachedViews.contains(viewId))
-		_cachedViews[viewId] = new GfxView(_resMan, _screen, _palette, viewId);
+	if (!view) {
+		view = new GfxView(_resMan, _screen, _palette, viewId);
+		_cachedViews.add(viewId, view);
+	}
 
-	return _cachedViews[viewId];
+	return view;
 }
 
 int16 GfxCache::kernelViewGetCelWidth(GuiResourceId viewId, int16 loopNo, int16 celNo) {
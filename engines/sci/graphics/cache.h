@@ -24,14 +24,116 @@
 #define SCI_GRAPHICS_CACHE_H
 
 #include "common/hashmap.h"
+#include "common/list.h"
 
 namespace Sci {
 
 class GfxFont;
 class GfxView;
 
-typedef Common::HashMap<int, GfxFont *> FontCache;
-typedef Common::HashMap<int, GfxView *> ViewCache;
+/**
+ * Cache of view or font objects, indexed by resource id. Once the memory held
+ * by the cached objects exceeds the budget, the least recently used ones are
+ * freed. The most recently used object is always kept, so the budget may be
+ * exceeded by a single large object.
+ */
+template<class T>
+class GfxObjectCache {
+public:
+	GfxObjectCache() : _maxMemory(0), _memoryUsed(0), _hits(0), _misses(0), _evictions(0) {}
+	~GfxObjectCache() { purge(); }
+
+	/**
+	 * Looks up a cached object and marks it as most recently used.
+	 * @return the object, or NULL if it isn't cached
+	 */
+	T *find(int id) {
+		typename EntryMap::iterator it = _entries.find(id);
+		if (it == _entries.end()) {
+			_misses++;
+			return 0;
+		}
+
+		_hits++;
+		Entry &entry = it->_value;
+		_lru.erase(entry.lruPos);
+		_lru.push_front(id);
+		entry.lruPos = _lru.begin();
+
+		// The object may have grown since it was last used, e.g. by unpacking
+		// the bitmaps of view cels
+		uint32 size = entry.object->getMemorySize();
+		_memoryUsed += size - entry.size;
+		entry.size = size;
+
+		trim();
+		return entry.object;
+	}
+
+	/** Adds an object to the cache as most recently used, taking ownership of it */
+	void add(int id, T *object) {
+		_lru.push_front(id);
+
+		Entry &entry = _entries[id];
+		entry.object = object;
+		entry.size = object->getMemorySize();
+		entry.lruPos = _lru.begin();
+		_memoryUsed += entry.size;
+
+		trim();
+	}
+
+	/** Frees all cached objects */
+	void purge() {
+		for (typename EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it)
+			delete it->_value.object;
+		_entries.clear();
+		_lru.clear();
+		_memoryUsed = 0;
+	}
+
+	void setMaxMemory(uint32 maxMemory) { _maxMemory = maxMemory; trim(); }
+	uint32 getMaxMemory() const { return _maxMemory; }
+	uint32 getMemoryUsed() const { return _memoryUsed; }
+	uint getSize() const { return _entries.size(); }
+
+	uint32 getHits() const { return _hits; }
+	uint32 getMisses() const { return _misses; }
+	uint32 getEvictions() const { return _evictions; }
+	void resetStats() { _hits = _misses = _evictions = 0; }
+
+private:
+	struct Entry {
+		T *object;
+		uint32 size;
+		Common::List<int>::iterator lruPos;
+	};
+	typedef Common::HashMap<int, Entry> EntryMap;
+
+	void trim() {
+		while (_memoryUsed > _maxMemory && _entries.size() > 1) {
+			typename EntryMap::iterator it = _entries.find(_lru.back());
+			_memoryUsed -= it->_value.size;
+			delete it->_value.object;
+			_entries.erase(it);
+			_lru.pop_back();
+			_evictions++;
+		}
+	}
+
+	EntryMap _entries;
+	Common::List<int> _lru; ///< Cached ids, most recently used first
+
+	uint32 _maxMemory;
+	uint32 _memoryUsed;
+
+	uint32 _hits;
+	uint32 _misses;
+	uint32 _evictions;
+};
+
+typedef GfxObjectCache<GfxFont> FontCache;
+typedef GfxObjectCache<GfxView> ViewCache;
 
 /**
  * Cache class, handles caching of views/fonts
@@ -51,10 +153,10 @@ public:
 
 	byte kernelViewGetColorAtCoordinate(GuiResourceId viewId, int16 loopNo, int16 celNo, int16 x, int16 y);
 
-private:
-	void purgeFontCache();
-	void purgeViewCache();
+	FontCache &getFontCache() { return _cachedFonts; }
+	ViewCache &getViewCache() { return _cachedViews; }
 
+private:
 	ResourceManager *_resMan;
 	GfxScreen *_screen;
 	GfxPalette *_palette;
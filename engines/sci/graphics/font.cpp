@@ -65,6 +65,9 @@ GuiResourceId GfxFontFromResource::getResourceId() {
 byte GfxFontFromResource::getHeight() {
 	return _fontHeight;
 }
+uint32 GfxFontFromResource::getMemorySize() const {
+	return sizeof(GfxFontFromResource) + _resource->size + _numChars * sizeof(Charinfo);
+}
 byte GfxFontFromResource::getCharWidth(uint16 chr) {
 	return chr < _numChars ? _chars[chr].width : 0;
 }
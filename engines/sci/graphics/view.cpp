@@ -31,7 +31,7 @@
 namespace Sci {
 
 GfxView::GfxView(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette, GuiResourceId resourceId)
-	: _resMan(resMan), _screen(screen), _palette(palette), _resourceId(resourceId) {
+	: _resMan(resMan), _screen(screen), _palette(palette), _resourceId(resourceId), _bitmapMemory(0) {
 	assert(resourceId != -1);
 	_coordAdjuster = g_sci->_gfxCoordAdjuster;
 	initData(resourceId);
@@ -704,6 +704,7 @@ const byte *GfxView::getBitmap(int16 loopNo, int16 celNo) {
 	int pixelCount = width * height;
 	_loop[loopNo].cel[celNo].rawBitmap = new byte[pixelCount];
 	byte *pBitmap = _loop[loopNo].cel[celNo].rawBitmap;
+	_bitmapMemory += pixelCount;
 
 	// unpack the actual cel bitmap data
 	unpackCel(loopNo, celNo, pBitmap, pixelCount);
@@ -720,6 +721,16 @@ const byte *GfxView::getBitmap(int16 loopNo, int16 celNo) {
 	return _loop[loopNo].cel[celNo].rawBitmap;
 }
 
+uint32 GfxView::getMemorySize() const {
+	uint32 size = sizeof(GfxView) + _resourceSize + _bitmapMemory;
+
+	size += _loopCount * sizeof(LoopInfo);
+	for (uint16 loopNo = 0; loopNo < _loopCount; loopNo++)
+		size += _loop[loopNo].celCount * sizeof(CelInfo);
+
+	return size;
+}
+
 /**
  * Called after unpacking an EGA cel, this will try to undither (parts) of the
  * cel if the dithering in here matches dithering used by the current picture.
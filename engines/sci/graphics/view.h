@@ -87,6 +87,9 @@ public:
 
 	byte getColorAtCoordinate(int16 loopNo, int16 celNo, int16 x, int16 y);
 
+	/** Returns the memory held by this view, including the cel bitmaps unpacked so far */
+	uint32 getMemorySize() const;
+
 private:
 	void initData(GuiResourceId resourceId);
 	void unpackCel(int16 loopNo, int16 celNo, byte *outPtr, uint32 pixelCount);
@@ -112,6 +115,8 @@ private:
 
 	byte *_EGAmapping;
 
+	uint32 _bitmapMemory; ///< Size of all cel bitmaps unpacked by getBitmap()
+
 	// this is set for sci0early to adjust for the getCelRect() change
 	int16 _adjustForSci0Early;
 
@@ -22,10 +22,13 @@
 
 // Resource library
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
+#include "common/system.h"
 #include "common/textconsole.h"
+#include "common/timer.h"
 
 #include "sci/resource.h"
 #include "sci/resource_intern.h"
@@ -857,12 +860,13 @@ void ResourceManager::freeResourceSources() {
 	_sources.clear();
 }
 
-ResourceManager::ResourceManager() {
+ResourceManager::ResourceManager() : _prefetchedMemory(0), _prefetchTimerInstalled(false), _prefetchPathsScanned(false) {
 }
 
 void ResourceManager::init() {
 	_memoryLocked = 0;
 	_memoryLRU = 0;
+	_maxMemory = MAX_MEMORY;
 	_LRU.clear();
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
@@ -949,6 +953,7 @@ void ResourceManager::initForDetection() {
 
 	_memoryLocked = 0;
 	_memoryLRU = 0;
+	_maxMemory = MAX_MEMORY;
 	_LRU.clear();
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
@@ -961,6 +966,11 @@ void ResourceManager::initForDetection() {
 }
 
 ResourceManager::~ResourceManager() {
+	// Make sure the prefetcher is not running anymore
+	if (_prefetchTimerInstalled)
+		g_system->getTimerManager()->removeTimerProc(&prefetchTimerProc);
+	freePrefetchedResources();
+
 	// freeing resources
 	ResourceMap::iterator itr = _resMap.begin();
 	while (itr != _resMap.end()) {
@@ -1019,7 +1029,7 @@ void ResourceManager::printLRU() {
 }
 
 void ResourceManager::freeOldResources() {
-	while (MAX_MEMORY < _memoryLRU) {
+	while (_maxMemory < _memoryLRU) {
 		assert(!_LRU.empty());
 		Resource *goner = *_LRU.reverse_begin();
 		removeFromLRU(goner);
@@ -1049,9 +1059,10 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
-		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
+	if (retval->_status == kResStatusNoMalloc) {
+		if (!adoptPrefetchedResource(retval))
+			loadResource(retval);
+	} else if (retval->_status == kResStatusEnqueued)
 		removeFromLRU(retval);
 	// Unless an error occurred, the resource is now either
 	// locked or allocated, but never queued or freed.
@@ -1095,6 +1106,177 @@ void ResourceManager::unlockResource(Resource *res) {
 	freeOldResources();
 }
 
+void ResourceManager::setMaxMemory(int maxMemory) {
+	_maxMemory = maxMemory;
+	freeOldResources();
+}
+
+enum {
+	// Interval (in microseconds) at which the prefetcher is invoked. It
+	// decompresses one resource each time.
+	kPrefetchTimerInterval = 10000,
+	// Bigger resources are left to findResource(), so that a single timer
+	// call doesn't hold up the other timer procs for too long
+	kPrefetchMaxResourceSize = 64 * 1024
+};
+
+Common::String ResourceManager::getPrefetchPath(const Common::String &fileName) {
+	if (!_prefetchPathsScanned) {
+		_prefetchPathsScanned = true;
+
+		Common::FSNode gameDataDir(ConfMan.get("path"));
+		Common::FSList files;
+		if (gameDataDir.getChildren(files, Common::FSNode::kListFilesOnly)) {
+			for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file)
+				_prefetchPaths.setVal(file->getName(), file->getPath());
+		}
+	}
+
+	PrefetchPathMap::const_iterator it = _prefetchPaths.find(fileName);
+	if (it == _prefetchPaths.end())
+		return Common::String();
+	return it->_value;
+}
+
+void ResourceManager::prefetchRoom(uint16 number) {
+	static const ResourceType types[] = {
+		kResourceTypeScript, kResourceTypeHeap, kResourceTypePic, kResourceTypeView
+	};
+
+	Common::StackLock lock(_prefetchMutex);
+
+	// Don't let prefetched resources which were never used pile up
+	if (_prefetchedMemory > _maxMemory / 2)
+		freePrefetchedResources();
+
+	for (int i = 0; i < ARRAYSIZE(types); i++) {
+		ResourceId id(types[i], number);
+		Resource *res = testResource(id);
+
+		if (!res || res->_status != kResStatusNoMalloc || _prefetchedResources.contains(id))
+			continue;
+
+		// The prefetcher opens volume files on its own, everything else
+		// needs the resource manager's state to be loaded
+		if (res->_source->getSourceType() != kSourceVolume || res->_source->_resourceFile)
+			continue;
+
+		bool queued = false;
+		for (Common::List<PrefetchRequest>::const_iterator it = _prefetchQueue.begin(); it != _prefetchQueue.end(); ++it) {
+			if (it->id == id) {
+				queued = true;
+				break;
+			}
+		}
+		if (queued)
+			continue;
+
+		// Resolve the volume file here, SearchMan may only be used on the
+		// engine thread
+		Common::String path = getPrefetchPath(res->_source->getLocationName());
+		if (path.empty())
+			continue;
+
+		PrefetchRequest request;
+		request.id = id;
+		// Don't share the string buffer with the engine thread
+		request.path = Common::String(path.c_str());
+		request.fileOffset = res->_fileOffset;
+		_prefetchQueue.push_back(request);
+
+		debugC(kDebugLevelResMan, 2, "[resMan] Queued %s for prefetching", id.toString().c_str());
+	}
+
+	if (!_prefetchTimerInstalled && !_prefetchQueue.empty())
+		_prefetchTimerInstalled = g_system->getTimerManager()->installTimerProc(&prefetchTimerProc, kPrefetchTimerInterval, this, "sciPrefetch");
+}
+
+void ResourceManager::prefetchTimerProc(void *refCon) {
+	((ResourceManager *)refCon)->prefetchNext();
+}
+
+void ResourceManager::prefetchNext() {
+	PrefetchRequest request;
+	{
+		Common::StackLock lock(_prefetchMutex);
+		if (_prefetchQueue.empty())
+			return;
+		request = _prefetchQueue.front();
+		_prefetchQueue.pop_front();
+	}
+
+	// The volume files kept open by getVolumeFile() belong to the engine
+	// thread, so open the file on our own. The path has been resolved by
+	// prefetchRoom(), which keeps SearchMan out of this thread.
+	Common::SeekableReadStream *file = Common::FSNode(request.path).createReadStream();
+	if (!file)
+		return;
+
+	// Check the size first, and leave errors to findResource() to report
+	Resource *res = new Resource(this, request.id);
+	uint32 szPacked = 0;
+	ResourceCompression compression = kCompUnknown;
+	file->seek(request.fileOffset, SEEK_SET);
+	if (res->readResourceInfo(_volVersion, file, szPacked, compression) ||
+	    res->size > kPrefetchMaxResourceSize || szPacked > kPrefetchMaxResourceSize) {
+		delete res;
+		delete file;
+		return;
+	}
+
+	file->seek(request.fileOffset, SEEK_SET);
+	int error = res->decompress(_volVersion, file);
+	delete file;
+	if (error) {
+		delete res;
+		return;
+	}
+
+	Common::StackLock lock(_prefetchMutex);
+	if (_prefetchedResources.contains(request.id)) {
+		delete res;
+		return;
+	}
+	_prefetchedResources.setVal(request.id, res);
+	_prefetchedMemory += res->size;
+}
+
+bool ResourceManager::adoptPrefetchedResource(Resource *res) {
+	Common::StackLock lock(_prefetchMutex);
+
+	ResourceMap::iterator it = _prefetchedResources.find(res->_id);
+	if (it == _prefetchedResources.end()) {
+		// The resource is loaded right away, no need to prefetch it anymore
+		for (Common::List<PrefetchRequest>::iterator req = _prefetchQueue.begin(); req != _prefetchQueue.end(); ++req) {
+			if (req->id == res->_id) {
+				_prefetchQueue.erase(req);
+				break;
+			}
+		}
+		return false;
+	}
+
+	Resource *prefetched = it->_value;
+	_prefetchedResources.erase(it);
+	_prefetchedMemory -= prefetched->size;
+
+	res->data = prefetched->data;
+	res->size = prefetched->size;
+	res->_status = kResStatusAllocated;
+	prefetched->data = NULL;
+	delete prefetched;
+
+	debugC(kDebugLevelResMan, 2, "[resMan] Using prefetched %s", res->_id.toString().c_str());
+	return true;
+}
+
+void ResourceManager::freePrefetchedResources() {
+	for (ResourceMap::iterator it = _prefetchedResources.begin(); it != _prefetchedResources.end(); ++it)
+		delete it->_value;
+	_prefetchedResources.clear();
+	_prefetchedMemory = 0;
+}
+
 const char *ResourceManager::versionDescription(ResVersion version) const {
 	switch (version) {
 	case kResVersionUnknown:
@@ -26,6 +26,7 @@
 #include "common/str.h"
 #include "common/list.h"
 #include "common/hashmap.h"
+#include "common/mutex.h"
 
 #include "sci/graphics/helpers.h"		// for ViewType
 #include "sci/decompressor.h"
@@ -345,6 +346,22 @@ public:
 	 */
 	void unlockResource(Resource *res);
 
+	/**
+	 * Sets the number of bytes unlocked resources may occupy before the least
+	 * recently used ones are freed.
+	 */
+	void setMaxMemory(int maxMemory);
+	int getMaxMemory() const { return _maxMemory; }
+
+	/**
+	 * Starts decompressing the script, heap, pic and view resources with the
+	 * given number in the background, so that they are ready by the time a
+	 * room with that number is entered. findResource() picks them up from
+	 * there. Only resources stored in volume files are prefetched.
+	 * @param number	the room number
+	 */
+	void prefetchRoom(uint16 number);
+
 	/**
 	 * Tests whether a resource exists.
 	 *
@@ -427,13 +444,26 @@ protected:
 	// for resources which are not explicitly locked. However, a warning will be
 	// issued whenever this limit is exceeded.
 	enum {
-		MAX_MEMORY = 256 * 1024	// 256KB
+		MAX_MEMORY = 16 * 1024 * 1024	// 16MB, used unless set by setMaxMemory()
+	};
+
+	/**
+	 * Resource waiting to be decompressed by prefetchNext(). Only copies of
+	 * plain data are passed to the timer thread.
+	 */
+	struct PrefetchRequest {
+		ResourceId id;
+		Common::String path; ///< Full path of the volume file, see getPrefetchPath()
+		int32 fileOffset;
 	};
 
+	typedef Common::HashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> PrefetchPathMap;
+
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	Common::List<ResourceSource *> _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
+	int _maxMemory;		///< Amount of resource bytes allowed under LRU control
 	Common::List<Resource *> _LRU; ///< Last Resource Used list
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
@@ -441,6 +471,22 @@ protected:
 	ResVersion _volVersion; ///< resource.0xx version
 	ResVersion _mapVersion; ///< resource.map version
 
+	/**
+	 * Guards the prefetch queue and results below, which are shared between
+	 * the engine and the timer thread decompressing the resources.
+	 */
+	Common::Mutex _prefetchMutex;
+	Common::List<PrefetchRequest> _prefetchQueue;
+	ResourceMap _prefetchedResources; ///< Decompressed resources not picked up yet
+	int _prefetchedMemory;
+	bool _prefetchTimerInstalled;
+	/**
+	 * Full paths of the files in the game directory, by file name. Only used
+	 * on the engine thread.
+	 */
+	PrefetchPathMap _prefetchPaths;
+	bool _prefetchPathsScanned;
+
 	/**
 	 * Add a path to the resource manager's list of sources.
 	 * @return a pointer to the added source structure, or NULL if an error occurred.
@@ -555,6 +601,30 @@ protected:
 	void addToLRU(Resource *res);
 	void removeFromLRU(Resource *res);
 
+	static void prefetchTimerProc(void *refCon);
+
+	/** Decompresses the next resource in the prefetch queue. Runs on the timer thread. */
+	void prefetchNext();
+
+	/**
+	 * Looks up the full path of a volume file in the game directory, so that
+	 * the timer thread can open it without going through SearchMan.
+	 * @return the path, or an empty string if the file is somewhere else
+	 */
+	Common::String getPrefetchPath(const Common::String &fileName);
+
+	/**
+	 * Moves the data of a prefetched resource over to the given resource.
+	 * @return true if the resource had been prefetched
+	 */
+	bool adoptPrefetchedResource(Resource *res);
+
+	/**
+	 * Frees all prefetched resources which haven't been picked up. Must be
+	 * called with _prefetchMutex locked, or with the timer removed.
+	 */
+	void freePrefetchedResources();
+
 	ResourceCompression getViewCompression();
 	ViewType detectViewType();
 	bool hasSci0Voc999();
@@ -198,11 +198,15 @@ Common::Error SciEngine::run() {
 	ConfMan.registerDefault("native_fb01", "false");
 	ConfMan.registerDefault("windows_cursors", "false");	// Windows cursors for KQ6 Windows
 	ConfMan.registerDefault("silver_cursors", "false");	// Silver cursors for SQ4 CD
+	ConfMan.registerDefault("view_cache_size", 8192);	// Memory budget of the view cache, in KB
+	ConfMan.registerDefault("font_cache_size", 1024);	// Memory budget of the font cache, in KB
+	ConfMan.registerDefault("resource_cache_size", 16384);	// Memory budget for unlocked resources, in KB
 
 	_resMan = new ResourceManager();
 	assert(_resMan);
 	_resMan->addAppropriateSources();
 	_resMan->init();
+	_resMan->setMaxMemory(ConfMan.getInt("resource_cache_size") * 1024);
 
 	// TODO: Add error handling. Check return values of addAppropriateSources
 	// and init. We first have to *add* sensible return values, though ;).
@@ -128,6 +128,7 @@ BaseSurface *BaseSurfaceStorage::addSurface(const Common::String &filename, bool
 		return nullptr;
 	}
 
+	surface->_atlas = &_atlas;
 	if (DID_FAIL(surface->create(filename, defaultCK, ckRed, ckGreen, ckBlue, lifeTime, keepLoaded))) {
 		delete surface;
 		return nullptr;
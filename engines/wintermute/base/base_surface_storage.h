@@ -30,6 +30,7 @@
 #define WINTERMUTE_BASE_SURFACE_STORAGE_H
 
 #include "engines/wintermute/base/base.h"
+#include "engines/wintermute/base/gfx/surface_atlas.h"
 #include "common/array.h"
 
 namespace Wintermute {
@@ -50,6 +51,9 @@ public:
 	virtual ~BaseSurfaceStorage();
 
 	Common::Array<BaseSurface *> _surfaces;
+private:
+	/** Shared pages for the small images of the surfaces above */
+	SurfaceAtlas _atlas;
 };
 
 } // End of namespace Wintermute
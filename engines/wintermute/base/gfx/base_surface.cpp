@@ -35,6 +35,7 @@ namespace Wintermute {
 //////////////////////////////////////////////////////////////////////
 BaseSurface::BaseSurface(BaseGame *inGame) : BaseClass(inGame) {
 	_referenceCount = 0;
+	_atlas = nullptr;
 
 	_width = _height = 0;
 
@@ -36,6 +36,8 @@
 
 namespace Wintermute {
 
+class SurfaceAtlas;
+
 class BaseSurface: public BaseClass {
 public:
 	virtual bool invalidate();
@@ -72,6 +74,8 @@ public:
 	void setSize(int width, int height);
 
 	int _referenceCount;
+	/** Atlas to pack the image into if it is small enough, or nullptr */
+	SurfaceAtlas *_atlas;
 
 	virtual int getWidth() {
 		return _width;
@@ -40,6 +40,10 @@
 #include "common/config-manager.h"
 
 #define DIRTY_RECT_LIMIT 800
+// Pixel bytes kept around for scaled and rotated sprites
+#define TRANSFORM_CACHE_SIZE (8 * 1024 * 1024)
+// Number of released tickets kept for reuse
+#define TICKET_POOL_SIZE 256
 
 namespace Wintermute {
 
@@ -48,10 +52,12 @@ BaseRenderer *makeOSystemRenderer(BaseGame *inGame) {
 }
 
 //////////////////////////////////////////////////////////////////////////
-BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame) {
+BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame), _transformCache(TRANSFORM_CACHE_SIZE) {
 	_renderSurface = new Graphics::Surface();
 	_blankSurface = new Graphics::Surface();
-	_lastFrameIter = _renderQueue.end();
+	_renderQueue = &_queues[0];
+	_lastFrameQueue = &_queues[1];
+	_lastFrameIndex = 0;
 	_needsFlip = true;
 	_skipThisFrame = false;
 
@@ -68,11 +74,9 @@ BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame) {
 
 //////////////////////////////////////////////////////////////////////////
 BaseRenderOSystem::~BaseRenderOSystem() {
-	RenderQueueIterator it = _renderQueue.begin();
-	while (it != _renderQueue.end()) {
-		RenderTicket *ticket = *it;
-		it = _renderQueue.erase(it);
-		delete ticket;
+	clearTickets();
+	for (uint i = 0; i < _ticketPool.size(); i++) {
+		delete _ticketPool[i];
 	}
 
 	delete _dirtyRect;
@@ -159,12 +163,18 @@ bool BaseRenderOSystem::flip() {
 		g_system->updateScreen();
 		_needsFlip = false;
 
-		// Reset ticketing state
-		_lastFrameIter = _renderQueue.end();
-		RenderQueueIterator it;
-		for (it = _renderQueue.begin(); it != _renderQueue.end(); ++it) {
-			(*it)->_wantsDraw = false;
+		// Reset ticketing state, keeping the tickets which weren't drawn again
+		// for the next frame to match
+		for (uint i = 0; i < _lastFrameQueue->size(); i++) {
+			RenderTicket *ticket = (*_lastFrameQueue)[i];
+			if (!ticket->_wantsDraw) {
+				_renderQueue->push_back(ticket);
+			}
 		}
+		for (uint i = 0; i < _renderQueue->size(); i++) {
+			(*_renderQueue)[i]->_wantsDraw = false;
+		}
+		nextFrameQueue();
 
 		addDirtyRect(_renderRect);
 		return true;
@@ -172,18 +182,15 @@ bool BaseRenderOSystem::flip() {
 	if (!_disableDirtyRects) {
 		drawTickets();
 	} else {
-		// Clear the scale-buffered tickets that wasn't reused.
-		RenderQueueIterator it = _renderQueue.begin();
-		while (it != _renderQueue.end()) {
-			if ((*it)->_wantsDraw == false) {
-				RenderTicket *ticket = *it;
-				it = _renderQueue.erase(it);
-				delete ticket;
-			} else {
-				(*it)->_wantsDraw = false;
-				++it;
-			}
+		// Clear the scale-buffered tickets of last frame, tickets are never
+		// reused without dirty rects.
+		for (uint i = 0; i < _lastFrameQueue->size(); i++) {
+			releaseTicket((*_lastFrameQueue)[i]);
 		}
+		for (uint i = 0; i < _renderQueue->size(); i++) {
+			(*_renderQueue)[i]->_wantsDraw = false;
+		}
+		nextFrameQueue();
 	}
 
 	int oldScreenChangeID = _lastScreenChangeID;
@@ -199,7 +206,6 @@ bool BaseRenderOSystem::flip() {
 		_dirtyRect = nullptr;
 		_needsFlip = false;
 	}
-	_lastFrameIter = _renderQueue.end();
 
 	g_system->updateScreen();
 
@@ -271,9 +277,9 @@ Graphics::PixelFormat BaseRenderOSystem::getPixelFormat() const {
 void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct &transform) {
 
 	if (_disableDirtyRects) {
-		RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform);
+		RenderTicket *ticket = newTicket(owner, surf, srcRect, dstRect, transform);
 		ticket->_wantsDraw = true;
-		_renderQueue.push_back(ticket);
+		_renderQueue->push_back(ticket);
 		drawFromSurface(ticket);
 		return;
 	}
@@ -285,32 +291,97 @@ void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::S
 
 	if (owner) { // Fade-tickets are owner-less
 		RenderTicket compare(owner, nullptr, srcRect, dstRect, transform);
-		RenderQueueIterator it = _lastFrameIter;
-		++it;
-		// Avoid calling end() and operator* every time, when potentially going through
-		// LOTS of tickets.
-		RenderQueueIterator endIterator = _renderQueue.end();
-		RenderTicket *compareTicket = nullptr;
-		for (; it != endIterator; ++it) {
-			compareTicket = *it;
-			if (*(compareTicket) == compare && compareTicket->_isValid) {
-				if (_disableDirtyRects) {
-					drawFromSurface(compareTicket);
-				} else {
-					drawFromQueuedTicket(it);
-				}
-				return;
+		RenderTicket *compareTicket = findLastFrameTicket(compare);
+		if (compareTicket) {
+			drawFromQueuedTicket(compareTicket);
+			return;
+		}
+	}
+	drawFromTicket(newTicket(owner, surf, srcRect, dstRect, transform));
+}
+
+RenderTicket *BaseRenderOSystem::newTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct &transform) {
+	RenderTicket *ticket;
+	if (!_ticketPool.empty()) {
+		ticket = _ticketPool.back();
+		_ticketPool.pop_back();
+		ticket->init(owner, surf, srcRect, dstRect, transform, &_transformCache);
+	} else {
+		ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform, &_transformCache);
+	}
+
+	if (owner && !_disableDirtyRects) {
+		RenderTicket *first = _ticketMap.getVal(ticket, nullptr);
+		if (first) {
+			ticket->_nextSame = first->_nextSame;
+			first->_nextSame = ticket;
+		} else {
+			_ticketMap[ticket] = ticket;
+		}
+	}
+	return ticket;
+}
+
+void BaseRenderOSystem::releaseTicket(RenderTicket *ticket) {
+	if (ticket->_owner && !_disableDirtyRects) {
+		RenderTicket *first = _ticketMap.getVal(ticket, nullptr);
+		assert(first);
+		if (first == ticket) {
+			// The ticket is also the key, so the next one has to take over.
+			_ticketMap.erase(ticket);
+			if (ticket->_nextSame) {
+				_ticketMap[ticket->_nextSame] = ticket->_nextSame;
+			}
+		} else {
+			while (first->_nextSame != ticket) {
+				first = first->_nextSame;
+				assert(first);
 			}
+			first->_nextSame = ticket->_nextSame;
 		}
+		ticket->_nextSame = nullptr;
 	}
-	RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform);
-	if (!_disableDirtyRects) {
-		drawFromTicket(ticket);
+
+	if (_ticketPool.size() < TICKET_POOL_SIZE) {
+		_ticketPool.push_back(ticket);
 	} else {
-		ticket->_wantsDraw = true;
-		_renderQueue.push_back(ticket);
-		drawFromSurface(ticket);
+		delete ticket;
+	}
+}
+
+RenderTicket *BaseRenderOSystem::findLastFrameTicket(const RenderTicket &compare) {
+	// Tickets of this frame have _wantsDraw set, so they are skipped here
+	for (RenderTicket *ticket = _ticketMap.getVal(&compare, nullptr); ticket; ticket = ticket->_nextSame) {
+		if (ticket->_isValid && !ticket->_wantsDraw) {
+			return ticket;
+		}
 	}
+	return nullptr;
+}
+
+void BaseRenderOSystem::nextFrameQueue() {
+	RenderQueue *queue = _lastFrameQueue;
+	_lastFrameQueue = _renderQueue;
+	_renderQueue = queue;
+	// Keeps the allocated storage, unlike clear()
+	_renderQueue->resize(0);
+	_lastFrameIndex = 0;
+}
+
+void BaseRenderOSystem::clearTickets() {
+	// Tickets drawn again are in both queues
+	for (uint i = 0; i < _lastFrameQueue->size(); i++) {
+		if (!(*_lastFrameQueue)[i]->_wantsDraw) {
+			delete (*_lastFrameQueue)[i];
+		}
+	}
+	for (uint i = 0; i < _renderQueue->size(); i++) {
+		delete (*_renderQueue)[i];
+	}
+	_lastFrameQueue->resize(0);
+	_renderQueue->resize(0);
+	_lastFrameIndex = 0;
+	_ticketMap.clear();
 }
 
 void BaseRenderOSystem::invalidateTicket(RenderTicket *renderTicket) {
@@ -320,47 +391,43 @@ void BaseRenderOSystem::invalidateTicket(RenderTicket *renderTicket) {
 }
 
 void BaseRenderOSystem::invalidateTicketsFromSurface(BaseSurfaceOSystem *surf) {
-	RenderQueueIterator it;
-	for (it = _renderQueue.begin(); it != _renderQueue.end(); ++it) {
-		if ((*it)->_owner == surf) {
-			invalidateTicket(*it);
+	_transformCache.invalidate(surf);
+
+	for (uint i = 0; i < _lastFrameQueue->size(); i++) {
+		if ((*_lastFrameQueue)[i]->_owner == surf) {
+			invalidateTicket((*_lastFrameQueue)[i]);
+		}
+	}
+	for (uint i = 0; i < _renderQueue->size(); i++) {
+		if ((*_renderQueue)[i]->_owner == surf) {
+			invalidateTicket((*_renderQueue)[i]);
 		}
 	}
 }
 
 void BaseRenderOSystem::drawFromTicket(RenderTicket *renderTicket) {
 	renderTicket->_wantsDraw = true;
-
-	++_lastFrameIter;
-	// In-order
-	if (_renderQueue.empty() || _lastFrameIter == _renderQueue.end()) {
-		_lastFrameIter--;
-		_renderQueue.push_back(renderTicket);
-		++_lastFrameIter;
-		addDirtyRect(renderTicket->_dstRect);
-	} else {
-		// Before something
-		RenderQueueIterator pos = _lastFrameIter;
-		_renderQueue.insert(pos, renderTicket);
-		--_lastFrameIter;
-		addDirtyRect(renderTicket->_dstRect);
-	}
+	_renderQueue->push_back(renderTicket);
+	addDirtyRect(renderTicket->_dstRect);
 }
 
-void BaseRenderOSystem::drawFromQueuedTicket(const RenderQueueIterator &ticket) {
-	RenderTicket *renderTicket = *ticket;
+void BaseRenderOSystem::drawFromQueuedTicket(RenderTicket *renderTicket) {
 	assert(!renderTicket->_wantsDraw);
+
+	// Skip the tickets of last frame which have been drawn again already
+	while (_lastFrameIndex < _lastFrameQueue->size() && (*_lastFrameQueue)[_lastFrameIndex]->_wantsDraw) {
+		++_lastFrameIndex;
+	}
+
 	renderTicket->_wantsDraw = true;
+	_renderQueue->push_back(renderTicket);
 
-	++_lastFrameIter;
 	// Not in the same order?
-	if (*_lastFrameIter != renderTicket) {
-		--_lastFrameIter;
-		// Remove the ticket from the list
-		assert(*_lastFrameIter != renderTicket);
-		_renderQueue.erase(ticket);
-		// Is not in order, so readd it as if it was a new ticket
-		drawFromTicket(renderTicket);
+	if (_lastFrameIndex < _lastFrameQueue->size() && (*_lastFrameQueue)[_lastFrameIndex] == renderTicket) {
+		++_lastFrameIndex;
+	} else {
+		// Is not in order, so redraw it as if it was a new ticket
+		addDirtyRect(renderTicket->_dstRect);
 	}
 }
 
@@ -374,39 +441,34 @@ void BaseRenderOSystem::addDirtyRect(const Common::Rect &rect) {
 }
 
 void BaseRenderOSystem::drawTickets() {
-	RenderQueueIterator it = _renderQueue.begin();
 	// Clean out the old tickets
 	// Note: We draw invalid tickets too, otherwise we wouldn't be honoring
 	// the draw request they obviously made BEFORE becoming invalid, either way
 	// we have a copy of their data, so their invalidness won't affect us.
-	while (it != _renderQueue.end()) {
-		if ((*it)->_wantsDraw == false) {
-			RenderTicket *ticket = *it;
-			addDirtyRect((*it)->_dstRect);
-			it = _renderQueue.erase(it);
-			delete ticket;
-		} else {
-			++it;
+	for (uint i = 0; i < _lastFrameQueue->size(); i++) {
+		RenderTicket *ticket = (*_lastFrameQueue)[i];
+		if (ticket->_wantsDraw == false) {
+			addDirtyRect(ticket->_dstRect);
+			releaseTicket(ticket);
 		}
 	}
+	_lastFrameQueue->resize(0);
+
+	RenderQueue &queue = *_renderQueue;
 	if (!_dirtyRect || _dirtyRect->width() == 0 || _dirtyRect->height() == 0) {
-		it = _renderQueue.begin();
-		while (it != _renderQueue.end()) {
-			RenderTicket *ticket = *it;
-			ticket->_wantsDraw = false;
-			++it;
+		for (uint i = 0; i < queue.size(); i++) {
+			queue[i]->_wantsDraw = false;
 		}
+		nextFrameQueue();
 		return;
 	}
 
-	it = _renderQueue.begin();
-	_lastFrameIter = _renderQueue.end();
 	// A special case: If the screen has one giant OPAQUE rect to be drawn, then we skip filling
 	// the background color. Typical use-case: Fullscreen FMVs.
 	// Caveat: The FPS-counter will invalidate this.
-	if (it != _lastFrameIter && _renderQueue.front() == _renderQueue.back() && (*it)->_transform._alphaDisable == true) {
+	if (queue.size() == 1 && queue[0]->_transform._alphaDisable == true) {
 		// If our single opaque rect fills the dirty rect, we can skip filling.
-		if (*_dirtyRect != (*it)->_dstRect) {
+		if (*_dirtyRect != queue[0]->_dstRect) {
 			// Apply the clear-color to the dirty rect.
 			_renderSurface->fillRect(*_dirtyRect, _clearColor);
 		}
@@ -415,8 +477,8 @@ void BaseRenderOSystem::drawTickets() {
 		// Apply the clear-color to the dirty rect.
 		_renderSurface->fillRect(*_dirtyRect, _clearColor);
 	}
-	for (; it != _renderQueue.end(); ++it) {
-		RenderTicket *ticket = *it;
+	for (uint i = 0; i < queue.size(); i++) {
+		RenderTicket *ticket = queue[i];
 		if (ticket->_dstRect.intersects(*_dirtyRect)) {
 			// dstClip is the area we want redrawn.
 			Common::Rect dstClip(ticket->_dstRect);
@@ -437,19 +499,20 @@ void BaseRenderOSystem::drawTickets() {
 	}
 	g_system->copyRectToScreen((byte *)_renderSurface->getBasePtr(_dirtyRect->left, _dirtyRect->top), _renderSurface->pitch, _dirtyRect->left, _dirtyRect->top, _dirtyRect->width(), _dirtyRect->height());
 
-	it = _renderQueue.begin();
-	// Clean out the old tickets
-	while (it != _renderQueue.end()) {
-		if ((*it)->_isValid == false) {
-			RenderTicket *ticket = *it;
-			addDirtyRect((*it)->_dstRect);
-			it = _renderQueue.erase(it);
-			delete ticket;
+	// Clean out the invalid tickets, keeping the order of the others
+	uint kept = 0;
+	for (uint i = 0; i < queue.size(); i++) {
+		RenderTicket *ticket = queue[i];
+		if (ticket->_isValid == false) {
+			addDirtyRect(ticket->_dstRect);
+			releaseTicket(ticket);
 		} else {
-			++it;
+			queue[kept++] = ticket;
 		}
 	}
+	queue.resize(kept);
 
+	nextFrameQueue();
 }
 
 // Replacement for SDL2's SDL_RenderCopy
@@ -565,16 +628,10 @@ void BaseRenderOSystem::endSaveLoad() {
 	BaseRenderer::endSaveLoad();
 
 	// Clear the scale-buffered tickets as we just loaded.
-	RenderQueueIterator it = _renderQueue.begin();
-	while (it != _renderQueue.end()) {
-		RenderTicket *ticket = *it;
-		it = _renderQueue.erase(it);
-		delete ticket;
-	}
+	clearTickets();
 	// HACK: After a save the buffer will be drawn before the scripts get to update it,
 	// so just skip this single frame.
 	_skipThisFrame = true;
-	_lastFrameIter = _renderQueue.end();
 
 	_renderSurface->fillRect(Common::Rect(0, 0, _renderSurface->h, _renderSurface->w), _renderSurface->format.ARGBToColor(255, 0, 0, 0));
 	g_system->copyRectToScreen((byte *)_renderSurface->getPixels(), _renderSurface->pitch, 0, 0, _renderSurface->w, _renderSurface->h);
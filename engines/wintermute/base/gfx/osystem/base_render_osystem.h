@@ -32,8 +32,11 @@
 #include "engines/wintermute/base/gfx/base_renderer.h"
 #include "common/rect.h"
 #include "graphics/surface.h"
-#include "common/list.h"
+#include "common/array.h"
+#include "common/hashmap.h"
 #include "graphics/transform_struct.h"
+#include "graphics/transform_cache.h"
+#include "engines/wintermute/base/gfx/osystem/render_ticket.h"
 
 namespace Wintermute {
 class BaseSurfaceOSystem;
@@ -62,7 +65,7 @@ public:
 	BaseRenderOSystem(BaseGame *inGame);
 	~BaseRenderOSystem();
 
-	typedef Common::List<RenderTicket *>::iterator RenderQueueIterator;
+	typedef Common::Array<RenderTicket *> RenderQueue;
 
 	Common::String getName() const;
 
@@ -86,11 +89,11 @@ public:
 	 */
 	void drawFromTicket(RenderTicket *renderTicket);
 	/**
-	 * Re-insert an existing ticket into the queue, adding a dirty rect
-	 * out-of-order from last draw from the ticket.
-	 * @param ticket iterator pointing to the ticket to be added.
+	 * Re-insert a ticket from last frame into the queue, adding a dirty rect
+	 * if it is drawn out-of-order from last frame.
+	 * @param renderTicket the ticket to be added.
 	 */
-	void drawFromQueuedTicket(const RenderQueueIterator &ticket);
+	void drawFromQueuedTicket(RenderTicket *renderTicket);
 
 	bool setViewport(int left, int top, int right, int bottom) override;
 	bool setViewport(Rect32 *rect) override { return BaseRenderer::setViewport(rect); }
@@ -126,14 +129,55 @@ private:
 	void drawFromSurface(RenderTicket *ticket);
 	// Dirty-rects:
 	void drawFromSurface(RenderTicket *ticket, Common::Rect *dstRect, Common::Rect *clipRect);
+	/**
+	 * Get a ticket for a draw call, recycling a released one if possible.
+	 */
+	RenderTicket *newTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct &transform);
+	/**
+	 * Give a ticket back to the pool, once it is no longer in any queue.
+	 */
+	void releaseTicket(RenderTicket *ticket);
+	/**
+	 * Find a ticket from last frame, which hasn't been drawn again yet and
+	 * is equal to the given one.
+	 */
+	RenderTicket *findLastFrameTicket(const RenderTicket &compare);
+	/**
+	 * Start a new frame, the tickets just drawn become last frame's tickets.
+	 * Last frame's tickets must have been released or moved already.
+	 */
+	void nextFrameQueue();
+	/** Delete all queued tickets. */
+	void clearTickets();
 	Common::Rect *_dirtyRect;
-	Common::List<RenderTicket *> _renderQueue;
+	/** The tickets of the frame being drawn, in drawing order */
+	RenderQueue *_renderQueue;
+	/**
+	 * The tickets of the previous frame, in drawing order. Tickets which
+	 * have been drawn again are in both queues, and have _wantsDraw set.
+	 */
+	RenderQueue *_lastFrameQueue;
+	RenderQueue _queues[2];
+	/**
+	 * Index of the first ticket in _lastFrameQueue which hasn't been drawn
+	 * again. Drawing that ticket next keeps the order of last frame.
+	 */
+	uint _lastFrameIndex;
+	/**
+	 * Matches the tickets of the queues by their draw arguments. Tickets
+	 * comparing equal are chained through RenderTicket::_nextSame.
+	 * Owner-less tickets are never matched, and thus not in here.
+	 */
+	Common::HashMap<const RenderTicket *, RenderTicket *, RenderTicketHash, RenderTicketEqual> _ticketMap;
+	/** Released tickets, kept to save allocations */
+	Common::Array<RenderTicket *> _ticketPool;
 
 	bool _needsFlip;
-	RenderQueueIterator _lastFrameIter;
 	Common::Rect _renderRect;
 	Graphics::Surface *_renderSurface;
 	Graphics::Surface *_blankSurface;
+	/** Scaled and rotated copies of sprites, reused by new tickets */
+	Graphics::TransformCache _transformCache;
 
 	int _borderLeft;
 	int _borderTop;
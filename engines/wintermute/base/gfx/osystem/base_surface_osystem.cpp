@@ -55,7 +55,7 @@ BaseSurfaceOSystem::BaseSurfaceOSystem(BaseGame *inGame) : BaseSurface(inGame) {
 //////////////////////////////////////////////////////////////////////////
 BaseSurfaceOSystem::~BaseSurfaceOSystem() {
 	if (_surface) {
-		_surface->free();
+		freeSurface();
 		delete _surface;
 		_surface = nullptr;
 	}
@@ -146,7 +146,7 @@ bool BaseSurfaceOSystem::finishLoad() {
 		// FIBITMAP *newImg = FreeImage_ConvertToGreyscale(img); TODO
 	}
 
-	_surface->free();
+	freeSurface();
 	delete _surface;
 
 	bool needsColorKey = false;
@@ -182,6 +182,15 @@ bool BaseSurfaceOSystem::finishLoad() {
 	_alphaType = hasTransparencyType(_surface);
 	_valid = true;
 
+	// Move small images into the shared atlas pages
+	if (_atlas) {
+		Graphics::Surface area;
+		if (_atlas->add(*_surface, _atlasSlot, area)) {
+			_surface->free();
+			*_surface = area;
+		}
+	}
+
 	_gameRef->addMem(_width * _height * 4);
 
 	delete image;
@@ -191,6 +200,16 @@ bool BaseSurfaceOSystem::finishLoad() {
 	return true;
 }
 
+//////////////////////////////////////////////////////////////////////////
+void BaseSurfaceOSystem::freeSurface() {
+	if (_atlasSlot.isValid()) {
+		_atlas->remove(_atlasSlot);
+		*_surface = Graphics::Surface();
+	} else {
+		_surface->free();
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////
 void BaseSurfaceOSystem::genAlphaMask(Graphics::Surface *surface) {
 	warning("BaseSurfaceOSystem::GenAlphaMask - Not ported yet");
@@ -443,6 +462,10 @@ bool BaseSurfaceOSystem::drawSprite(int x, int y, Rect32 *rect, Rect32 *newRect,
 
 bool BaseSurfaceOSystem::putSurface(const Graphics::Surface &surface, bool hasAlpha) {
 	_loaded = true;
+	if (_atlasSlot.isValid()) {
+		// Other images share the page, so get a surface of our own
+		freeSurface();
+	}
 	if (surface.format == _surface->format && surface.pitch == _surface->pitch && surface.h == _surface->h) {
 		const byte *src = (const byte *)surface.getBasePtr(0, 0);
 		byte *dst = (byte *)_surface->getBasePtr(0, 0);
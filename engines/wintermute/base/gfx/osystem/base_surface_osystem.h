@@ -32,6 +32,7 @@
 #include "graphics/surface.h"
 #include "graphics/transparent_surface.h"
 #include "engines/wintermute/base/gfx/base_surface.h"
+#include "engines/wintermute/base/gfx/surface_atlas.h"
 #include "common/list.h"
 
 namespace Wintermute {
@@ -87,6 +88,8 @@ private:
 	Graphics::Surface *_surface;
 	bool _loaded;
 	bool finishLoad();
+	/** Free the pixels of _surface, wherever they are stored. */
+	void freeSurface();
 	bool drawSprite(int x, int y, Rect32 *rect, Rect32 *newRect, Graphics::TransformStruct transformStruct);
 	void genAlphaMask(Graphics::Surface *surface);
 	uint32 getPixelAt(Graphics::Surface *surface, int x, int y);
@@ -96,6 +99,8 @@ private:
 	void *_lockPixels;
 	int _lockPitch;
 	byte *_alphaMask;
+	/** Place of the image in _atlas, if _surface points into it */
+	SurfaceAtlas::Slot _atlasSlot;
 };
 
 } // End of namespace Wintermute
@@ -34,53 +34,101 @@
 
 namespace Wintermute {
 
-RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct transform) :
-	_owner(owner),
-	_srcRect(*srcRect),
-	_dstRect(*dstRect),
-	_isValid(true),
-	_wantsDraw(true),
-	_transform(transform) {
-	if (surf) {
-		_surface = new Graphics::Surface();
-		_surface->create((uint16)srcRect->width(), (uint16)srcRect->height(), surf->format);
-		assert(_surface->format.bytesPerPixel == 4);
-		// Get a clipped copy of the surface
-		for (int i = 0; i < _surface->h; i++) {
-			memcpy(_surface->getBasePtr(0, i), surf->getBasePtr(srcRect->left, srcRect->top + i), srcRect->width() * _surface->format.bytesPerPixel);
-		}
-		// Then scale it if necessary
-		//
-		// NB: The numTimesX/numTimesY properties don't yet mix well with
-		// scaling and rotation, but there is no need for that functionality at
-		// the moment.
-		// NB: Mirroring and rotation are probably done in the wrong order.
-		// (Mirroring should most likely be done before rotation. See also
-		// TransformTools.)
-		if (_transform._angle != Graphics::kDefaultAngle) {
-			Graphics::TransparentSurface src(*_surface, false);
-			Graphics::Surface *temp = src.rotoscale(transform);
-			_surface->free();
-			delete _surface;
-			_surface = temp;
-		} else if ((dstRect->width() != srcRect->width() ||
-					dstRect->height() != srcRect->height()) &&
-					_transform._numTimesX * _transform._numTimesY == 1) {
-			Graphics::TransparentSurface src(*_surface, false);
-			Graphics::Surface *temp = src.scale(dstRect->width(), dstRect->height());
-			_surface->free();
-			delete _surface;
-			_surface = temp;
+RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct transform, Graphics::TransformCache *cache) :
+	_surface(nullptr) {
+	init(owner, surf, srcRect, dstRect, transform, cache);
+}
+
+RenderTicket::~RenderTicket() {
+	freeSurface();
+}
+
+void RenderTicket::init(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct transform, Graphics::TransformCache *cache) {
+	_owner = owner;
+	_nextSame = nullptr;
+	_srcRect = *srcRect;
+	_dstRect = *dstRect;
+	_isValid = true;
+	_wantsDraw = true;
+	_transform = transform;
+
+	if (!surf) {
+		freeSurface();
+		return;
+	}
+
+	bool rotate = _transform._angle != Graphics::kDefaultAngle;
+	bool scale = !rotate &&
+	             (dstRect->width() != srcRect->width() ||
+	              dstRect->height() != srcRect->height()) &&
+	             _transform._numTimesX * _transform._numTimesY == 1;
+
+	// Sprites are usually drawn with the same transform for many frames
+	// in a row, so reuse a previous result instead of redoing the work.
+	// Owner-less tickets draw temporary surfaces and can't be cached.
+	if (!owner || !(rotate || scale)) {
+		cache = nullptr;
+	}
+	if (cache) {
+		const Graphics::Surface *cached = cache->get(owner, *srcRect, _transform, dstRect->width(), dstRect->height());
+		if (cached) {
+			prepareSurface(cached->w, cached->h, cached->format);
+			for (int i = 0; i < _surface->h; i++) {
+				memcpy(_surface->getBasePtr(0, i), cached->getBasePtr(0, i), _surface->w * _surface->format.bytesPerPixel);
+			}
+			return;
 		}
+	}
+
+	prepareSurface(srcRect->width(), srcRect->height(), surf->format);
+	assert(_surface->format.bytesPerPixel == 4);
+	// Get a clipped copy of the surface
+	for (int i = 0; i < _surface->h; i++) {
+		memcpy(_surface->getBasePtr(0, i), surf->getBasePtr(srcRect->left, srcRect->top + i), srcRect->width() * _surface->format.bytesPerPixel);
+	}
+	// Then scale it if necessary
+	//
+	// NB: The numTimesX/numTimesY properties don't yet mix well with
+	// scaling and rotation, but there is no need for that functionality at
+	// the moment.
+	// NB: Mirroring and rotation are probably done in the wrong order.
+	// (Mirroring should most likely be done before rotation. See also
+	// TransformTools.)
+	if (rotate) {
+		Graphics::TransparentSurface src(*_surface, false);
+		Graphics::Surface *temp = src.rotoscale(transform);
+		freeSurface();
+		_surface = temp;
+	} else if (scale) {
+		Graphics::TransparentSurface src(*_surface, false);
+		Graphics::Surface *temp = src.scale(dstRect->width(), dstRect->height());
+		freeSurface();
+		_surface = temp;
+	}
+
+	if (cache) {
+		cache->put(owner, *srcRect, _transform, dstRect->width(), dstRect->height(), *_surface);
+	}
+}
+
+void RenderTicket::prepareSurface(int16 width, int16 height, const Graphics::PixelFormat &format) {
+	if (_surface && _surface->w == width && _surface->h == height && _surface->format == format) {
+		return;
+	}
+
+	if (_surface) {
+		_surface->free();
 	} else {
-		_surface = nullptr;
+		_surface = new Graphics::Surface();
 	}
+	_surface->create((uint16)width, (uint16)height, format);
 }
 
-RenderTicket::~RenderTicket() {
+void RenderTicket::freeSurface() {
 	if (_surface) {
 		_surface->free();
 		delete _surface;
+		_surface = nullptr;
 	}
 }
 
@@ -95,6 +143,20 @@ bool RenderTicket::operator==(const RenderTicket &t) const {
 	return true;
 }
 
+uint RenderTicketHash::operator()(const RenderTicket *ticket) const {
+	const Common::Rect &dst = ticket->_dstRect;
+	const Common::Rect *src = ticket->getSrcRect();
+	uint hash = (uint)(size_t)ticket->_owner;
+	hash = hash * 31 + (uint16)dst.left;
+	hash = hash * 31 + (uint16)dst.top;
+	hash = hash * 31 + (uint16)dst.right;
+	hash = hash * 31 + (uint16)dst.bottom;
+	hash = hash * 31 + (uint16)src->left;
+	hash = hash * 31 + (uint16)src->top;
+	hash = hash * 31 + ticket->_transform._rgbaMod;
+	return hash;
+}
+
 // Replacement for SDL2's SDL_RenderCopy
 void RenderTicket::drawToSurface(Graphics::Surface *_targetSurface) const {
 	Graphics::TransparentSurface src(*getSurface(), false);
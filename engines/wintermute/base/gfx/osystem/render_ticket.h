@@ -30,6 +30,7 @@
 #define WINTERMUTE_RENDER_TICKET_H
 
 #include "graphics/transparent_surface.h"
+#include "graphics/transform_cache.h"
 #include "graphics/surface.h"
 #include "common/rect.h"
 
@@ -51,9 +52,14 @@ class BaseSurfaceOSystem;
  */
 class RenderTicket {
 public:
-	RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRest, Graphics::TransformStruct transform);
-	RenderTicket() : _isValid(true), _wantsDraw(false), _transform(Graphics::TransformStruct()) {}
+	RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRest, Graphics::TransformStruct transform, Graphics::TransformCache *cache = nullptr);
+	RenderTicket() : _isValid(true), _wantsDraw(false), _transform(Graphics::TransformStruct()), _owner(nullptr), _nextSame(nullptr), _surface(nullptr) {}
 	~RenderTicket();
+	/**
+	 * Set the ticket up for a new draw call. Used to recycle tickets, the
+	 * pixel buffer of the ticket is kept if the new copy has the same size.
+	 */
+	void init(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct transform, Graphics::TransformCache *cache = nullptr);
 	const Graphics::Surface *getSurface() const { return _surface; }
 	// Non-dirty-rects:
 	void drawToSurface(Graphics::Surface *_targetSurface) const;
@@ -68,13 +74,30 @@ public:
 	Graphics::TransformStruct _transform;
 
 	BaseSurfaceOSystem *_owner;
+	/** Next ticket comparing equal to this one, see BaseRenderOSystem::_ticketMap */
+	RenderTicket *_nextSame;
 	bool operator==(const RenderTicket &a) const;
 	const Common::Rect *getSrcRect() const { return &_srcRect; }
 private:
+	/** Make _surface an uninitialized surface of the given size. */
+	void prepareSurface(int16 width, int16 height, const Graphics::PixelFormat &format);
+	void freeSurface();
+
 	Graphics::Surface *_surface;
 	Common::Rect _srcRect;
 };
 
+/** Hash function for tickets, matching RenderTicket::operator== */
+struct RenderTicketHash {
+	uint operator()(const RenderTicket *ticket) const;
+};
+
+struct RenderTicketEqual {
+	bool operator()(const RenderTicket *a, const RenderTicket *b) const {
+		return *a == *b;
+	}
+};
+
 } // End of namespace Wintermute
 
 #endif
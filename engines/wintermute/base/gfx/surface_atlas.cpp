@@ -0,0 +1,142 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/wintermute/base/gfx/surface_atlas.h"
+
+namespace Wintermute {
+
+// Shelf heights are rounded up to this, so images of similar height can
+// share a shelf.
+#define SHELF_ROUNDING 8
+
+SurfaceAtlas::SurfaceAtlas() {
+}
+
+SurfaceAtlas::~SurfaceAtlas() {
+	for (uint i = 0; i < _pages.size(); i++) {
+		if (_pages[i]) {
+			_pages[i]->surface.free();
+			delete _pages[i];
+		}
+	}
+}
+
+bool SurfaceAtlas::findRoom(Page &page, int16 w, int16 h, Common::Rect &rect) {
+	// Use the lowest shelf which is high enough and has enough room left,
+	// so low images don't take up space on high shelves
+	Shelf *best = nullptr;
+	for (uint i = 0; i < page.shelves.size(); i++) {
+		Shelf &shelf = page.shelves[i];
+		if (shelf.height >= h && kPageSize - shelf.used >= w && (!best || shelf.height < best->height)) {
+			best = &shelf;
+		}
+	}
+
+	if (!best || best->height - h >= SHELF_ROUNDING) {
+		int16 height = (h + SHELF_ROUNDING - 1) / SHELF_ROUNDING * SHELF_ROUNDING;
+		if (kPageSize - page.used >= height) {
+			Shelf shelf;
+			shelf.top = page.used;
+			shelf.height = height;
+			shelf.used = 0;
+			page.shelves.push_back(shelf);
+			page.used += height;
+			best = &page.shelves.back();
+		}
+	}
+
+	if (!best) {
+		return false;
+	}
+
+	rect = Common::Rect(best->used, best->top, best->used + w, best->top + h);
+	best->used += w;
+	return true;
+}
+
+bool SurfaceAtlas::add(const Graphics::Surface &src, Slot &slot, Graphics::Surface &area) {
+	if (src.w > kMaxImageSize || src.h > kMaxImageSize || src.w == 0 || src.h == 0) {
+		return false;
+	}
+
+	int freePage = -1;
+	slot.page = -1;
+	for (uint i = 0; i < _pages.size(); i++) {
+		if (!_pages[i]) {
+			if (freePage < 0) {
+				freePage = i;
+			}
+		} else if (_pages[i]->surface.format == src.format && findRoom(*_pages[i], src.w, src.h, slot.rect)) {
+			slot.page = i;
+			break;
+		}
+	}
+
+	if (slot.page < 0) {
+		Page *page = new Page();
+		page->surface.create(kPageSize, kPageSize, src.format);
+		page->used = 0;
+		page->images = 0;
+		findRoom(*page, src.w, src.h, slot.rect);
+
+		if (freePage >= 0) {
+			_pages[freePage] = page;
+			slot.page = freePage;
+		} else {
+			_pages.push_back(page);
+			slot.page = _pages.size() - 1;
+		}
+	}
+
+	Page *page = _pages[slot.page];
+	page->images++;
+	page->surface.copyRectToSurface(src, slot.rect.left, slot.rect.top, Common::Rect(src.w, src.h));
+	area = page->surface.getSubArea(slot.rect);
+	return true;
+}
+
+void SurfaceAtlas::remove(Slot &slot) {
+	if (!slot.isValid()) {
+		return;
+	}
+
+	Page *page = _pages[slot.page];
+	assert(page && page->images > 0);
+	if (--page->images == 0) {
+		page->surface.free();
+		delete page;
+		_pages[slot.page] = nullptr;
+	}
+	slot.page = -1;
+}
+
+uint SurfaceAtlas::getPageCount() const {
+	uint count = 0;
+	for (uint i = 0; i < _pages.size(); i++) {
+		if (_pages[i]) {
+			count++;
+		}
+	}
+	return count;
+}
+
+} // End of namespace Wintermute
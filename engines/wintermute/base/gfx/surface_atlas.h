@@ -0,0 +1,100 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef WINTERMUTE_SURFACE_ATLAS_H
+#define WINTERMUTE_SURFACE_ATLAS_H
+
+#include "common/array.h"
+#include "common/rect.h"
+#include "graphics/surface.h"
+
+namespace Wintermute {
+
+/**
+ * Packs small images into shared pages, to save the many small
+ * allocations of scenes with lots of little sprites and UI frames, and to
+ * keep their pixels close together in memory.
+ *
+ * Images are packed into rows ("shelves") of similar height. The space of
+ * a removed image is not reused; a page is freed once all of its images
+ * are removed.
+ */
+class SurfaceAtlas {
+public:
+	/** The place of a single image in the atlas. */
+	struct Slot {
+		Slot() : page(-1) {}
+		bool isValid() const { return page >= 0; }
+
+		int page;
+		Common::Rect rect;
+	};
+
+	SurfaceAtlas();
+	~SurfaceAtlas();
+
+	/**
+	 * Copy an image into the atlas.
+	 *
+	 * @param src   the image to copy
+	 * @param slot  filled in with the place of the image
+	 * @param area  filled in with a surface pointing to the copy, which
+	 *              stays valid until the slot is removed
+	 * @return true on success, false if the image is too large to be packed
+	 */
+	bool add(const Graphics::Surface &src, Slot &slot, Graphics::Surface &area);
+
+	/** Remove an image from the atlas and invalidate the slot. */
+	void remove(Slot &slot);
+
+	/** Number of pages currently allocated */
+	uint getPageCount() const;
+
+	/** Width and height of a page */
+	static const int kPageSize = 512;
+	/** Largest width or height of an image that is packed */
+	static const int kMaxImageSize = 128;
+
+private:
+	struct Shelf {
+		int16 top;
+		int16 height;
+		int16 used;
+	};
+
+	struct Page {
+		Graphics::Surface surface;
+		Common::Array<Shelf> shelves;
+		int16 used;
+		uint images;
+	};
+
+	/** Find room for a w x h image in the page, returns false if there is none. */
+	static bool findRoom(Page &page, int16 w, int16 h, Common::Rect &rect);
+
+	/** Pages in use, nullptr for pages which have been freed */
+	Common::Array<Page *> _pages;
+};
+
+} // End of namespace Wintermute
+
+#endif
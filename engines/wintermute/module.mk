@@ -50,6 +50,7 @@ MODULE_OBJS := \
 	base/gfx/base_image.o \
 	base/gfx/base_renderer.o \
 	base/gfx/base_surface.o \
+	base/gfx/surface_atlas.o \
 	base/gfx/osystem/base_surface_osystem.o \
 	base/gfx/osystem/base_render_osystem.o \
 	base/gfx/osystem/render_ticket.o \
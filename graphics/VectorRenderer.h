@@ -273,6 +273,24 @@ public:
 		_activeSurface = surface;
 	}
 
+	Surface *getActiveSurface() const {
+		return _activeSurface;
+	}
+
+	/**
+	 * Number of colors returned by getColors().
+	 */
+	static const int kColorCount = 5;
+
+	/**
+	 * Returns the current colors of the renderer, in the order foreground,
+	 * background, bevel, gradient start and gradient end. Draw steps which
+	 * don't set a color use the value left over from earlier drawing.
+	 *
+	 * @param colors Array of kColorCount entries to fill in.
+	 */
+	virtual void getColors(uint32 *colors) const = 0;
+
 	/**
 	 * Fills the active surface with the specified fg/bg color or the active gradient.
 	 * Defaults to using the active Foreground color for filling.
@@ -427,6 +445,14 @@ public:
 	 */
 	virtual void drawStep(const Common::Rect &area, const DrawStep &step, uint32 extra = 0);
 
+	/**
+	 * Sets the colors specified by a draw step, as drawStep() does, without
+	 * drawing anything.
+	 *
+	 * @param step Pointer to a DrawStep struct.
+	 */
+	void setStepColors(const DrawStep &step);
+
 	/**
 	 * Copies the part of the current frame to the system overlay.
 	 *
@@ -483,6 +509,7 @@ public:
 	 */
 	virtual void disableShadows() { _disableShadows = true; }
 	virtual void enableShadows() { _disableShadows = false; }
+	bool shadowsEnabled() const { return !_disableShadows; }
 
 	/**
 	 * Applies a whole-screen shading effect, used before opening a new dialog.
@@ -376,12 +376,24 @@ VectorRendererSpec(PixelFormat format) :
 	_alphaMask((0xFF >> format.aLoss) << format.aShift) {
 
 	_bitmapAlphaColor = _format.RGBToColor(255, 0, 255);
+	_fgColor = _bgColor = _bevelColor = 0;
+	_gradientStart = _gradientEnd = 0;
 }
 
 /****************************
  * Gradient-related methods *
  ****************************/
 
+template<typename PixelType>
+void VectorRendererSpec<PixelType>::
+getColors(uint32 *colors) const {
+	colors[0] = _fgColor;
+	colors[1] = _bgColor;
+	colors[2] = _bevelColor;
+	colors[3] = _gradientStart;
+	colors[4] = _gradientEnd;
+}
+
 template<typename PixelType>
 void VectorRendererSpec<PixelType>::
 setGradientColors(uint8 r1, uint8 g1, uint8 b1, uint8 r2, uint8 g2, uint8 b2) {
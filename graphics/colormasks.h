@@ -55,7 +55,9 @@ The meaning of these is masks is the following:
 
  The kHighBitsMask / kLowBitsMask / qhighBits / qlowBits are special values that are
  used in the super-optimized interpolation functions in scaler/intern.h
- and scaler/aspect.cpp. Currently they are only available in 555 and 565 mode.
+ and scaler/aspect.cpp. Currently they are only available in 555, 565 and
+ 888 mode. In 888 mode they only cover a single pixel, whose top byte has to
+ be zero.
  To be specific: They pack the masks for two 16 bit pixels at once. The pixels
  are split into "high" and "low" bits, which are then separately interpolated
  and finally re-composed. That way, 2x2 pixels or even 4x2 pixels can
@@ -222,6 +224,12 @@ struct ColorMasks<4444> {
 template<>
 struct ColorMasks<888> {
 	enum {
+		kHighBitsMask    = 0x00FEFEFE,
+		kLowBitsMask     = 0x00010101,
+		qhighBits   = 0x00FCFCFC,
+		qlowBits    = 0x00030303,
+
+
 		kBytesPerPixel = 4,
 
 		kAlphaBits  = 0,
@@ -239,7 +247,11 @@ struct ColorMasks<888> {
 		kGreenMask = ((1 << kGreenBits) - 1) << kGreenShift,
 		kBlueMask  = ((1 << kBlueBits) - 1) << kBlueShift,
 
-		kRedBlueMask = kRedMask | kBlueMask
+		kRedBlueMask = kRedMask | kBlueMask,
+
+		kLowBits    = (1 << kRedShift) | (1 << kGreenShift) | (1 << kBlueShift),
+		kLow2Bits   = (3 << kRedShift) | (3 << kGreenShift) | (3 << kBlueShift),
+		kLow3Bits   = (7 << kRedShift) | (7 << kGreenShift) | (7 << kBlueShift)
 	};
 };
 
@@ -0,0 +1,109 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "graphics/dirtyregion.h"
+
+namespace Graphics {
+
+static int rectArea(const Common::Rect &r) {
+	return r.width() * r.height();
+}
+
+DirtyRegion::DirtyRegion(uint maxRects, int maxWaste) : _maxRects(maxRects), _maxWaste(maxWaste) {
+	assert(maxRects > 0);
+	_rects.reserve(maxRects);
+	resetStats();
+}
+
+int DirtyRegion::mergeWaste(const Common::Rect &a, const Common::Rect &b) {
+	Common::Rect bounds(a);
+	bounds.extend(b);
+
+	int waste = rectArea(bounds) - rectArea(a) - rectArea(b);
+
+	// Pixels in both rectangles were subtracted twice
+	return waste + rectArea(a.findIntersectingRect(b));
+}
+
+void DirtyRegion::addRect(const Common::Rect &rect) {
+	if (!rect.isValidRect() || rect.isEmpty())
+		return;
+
+	++_stats.rectsAdded;
+	_stats.areaAdded += rectArea(rect);
+
+	// Merge with every rectangle which is cheap to merge with. The merged
+	// rectangle grows with each merge, which may make rectangles already
+	// checked cheap to merge, so start over after each one.
+	Common::Rect merged(rect);
+	uint i = 0;
+	while (i < _rects.size()) {
+		if (mergeWaste(_rects[i], merged) <= _maxWaste) {
+			merged.extend(_rects[i]);
+			_rects[i] = _rects.back();
+			_rects.pop_back();
+			++_stats.merges;
+			i = 0;
+		} else {
+			++i;
+		}
+	}
+
+	if (_rects.size() < _maxRects) {
+		_rects.push_back(merged);
+		return;
+	}
+
+	// The list is full, so merge with the rectangle wasting the fewest pixels
+	uint best = 0;
+	int bestWaste = mergeWaste(_rects[0], merged);
+	for (i = 1; i < _rects.size(); ++i) {
+		const int waste = mergeWaste(_rects[i], merged);
+		if (waste < bestWaste) {
+			best = i;
+			bestWaste = waste;
+		}
+	}
+
+	_rects[best].extend(merged);
+	++_stats.forcedMerges;
+}
+
+void DirtyRegion::clear() {
+	++_stats.frames;
+	_stats.rectsOutput += _rects.size();
+	for (uint i = 0; i < _rects.size(); ++i)
+		_stats.areaOutput += rectArea(_rects[i]);
+
+	_rects.clear();
+}
+
+void DirtyRegion::resetStats() {
+	_stats.frames = 0;
+	_stats.rectsAdded = 0;
+	_stats.rectsOutput = 0;
+	_stats.merges = 0;
+	_stats.forcedMerges = 0;
+	_stats.areaAdded = 0;
+	_stats.areaOutput = 0;
+}
+
+} // End of namespace Graphics
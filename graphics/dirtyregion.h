@@ -0,0 +1,94 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#ifndef GRAPHICS_DIRTYREGION_H
+#define GRAPHICS_DIRTYREGION_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * A list of dirty rectangles, which merges the rectangles added to it so
+ * that their number stays bounded.
+ *
+ * A new rectangle is merged with an existing one whenever their bounding
+ * box covers at most a given number of pixels which are in neither of the
+ * two, so overlapping and adjacent rectangles are combined for free. Once
+ * the list is full, further rectangles are merged with the rectangle which
+ * wastes the fewest pixels, instead of having to redraw everything.
+ */
+class DirtyRegion {
+public:
+	/** Counters describing how well the merging works. */
+	struct Stats {
+		/** Number of times the region was cleared, i.e. usually frames */
+		uint32 frames;
+		/** Number of (non empty) rectangles added */
+		uint32 rectsAdded;
+		/** Number of rectangles left after merging, summed over all frames */
+		uint32 rectsOutput;
+		/** Number of merges done because the wasted area was small */
+		uint32 merges;
+		/** Number of merges done because the list was full */
+		uint32 forcedMerges;
+		/** Total area of the rectangles added */
+		uint32 areaAdded;
+		/** Total area of the rectangles left after merging */
+		uint32 areaOutput;
+	};
+
+	/**
+	 * Create an empty region.
+	 *
+	 * @param maxRects  the maximum number of rectangles kept
+	 * @param maxWaste  the maximum number of pixels a merge may add which
+	 *                  were not dirty before
+	 */
+	DirtyRegion(uint maxRects, int maxWaste);
+
+	/** Add a rectangle to the region. Empty rectangles are ignored. */
+	void addRect(const Common::Rect &rect);
+
+	/** Remove all rectangles and count the frame in the statistics. */
+	void clear();
+
+	bool empty() const { return _rects.empty(); }
+	uint size() const { return _rects.size(); }
+	const Common::Rect &operator[](uint idx) const { return _rects[idx]; }
+
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	/** The number of pixels in the bounding box of a and b, which are in neither. */
+	static int mergeWaste(const Common::Rect &a, const Common::Rect &b);
+
+	Common::Array<Common::Rect> _rects;
+	uint _maxRects;
+	int _maxWaste;
+	Stats _stats;
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -120,8 +120,9 @@ void InitLUT(Graphics::PixelFormat format) {
 #endif
 
 
-/** Lookup table for the DotMatrix scaler. */
+/** Lookup tables for the DotMatrix scaler. */
 uint16 g_dotmatrix[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+uint32 g_dotmatrix32[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 
 /** Init the scaler subsystem. */
 void InitScalers(uint32 BitFormat) {
@@ -150,6 +151,14 @@ void InitScalers(uint32 BitFormat) {
 	g_dotmatrix[2] = g_dotmatrix[8] = format.RGBToColor(63, 0, 0);
 	g_dotmatrix[4] = g_dotmatrix[6] =
 		g_dotmatrix[12] = g_dotmatrix[14] = format.RGBToColor(63, 63, 63);
+
+	// The 32 bit scalers always use the same format
+	const Graphics::PixelFormat format32 = Graphics::createPixelFormat<888>();
+	g_dotmatrix32[0] = g_dotmatrix32[10] = format32.RGBToColor(0, 63, 0);
+	g_dotmatrix32[1] = g_dotmatrix32[11] = format32.RGBToColor(0, 0, 63);
+	g_dotmatrix32[2] = g_dotmatrix32[8] = format32.RGBToColor(63, 0, 0);
+	g_dotmatrix32[4] = g_dotmatrix32[6] =
+		g_dotmatrix32[12] = g_dotmatrix32[14] = format32.RGBToColor(63, 63, 63);
 }
 
 void DestroyScalers() {
@@ -164,20 +173,29 @@ void DestroyScalers() {
  * Trivial 'scaler' - in fact it doesn't do any scaling but just copies the
  * source to the destination.
  */
-void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+template<typename Pixel>
+static void Normal1xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							int width, int height) {
 	// Spot the case when it can all be done in 1 hit
-	if ((srcPitch == sizeof(uint16) * (uint)width) && (dstPitch == sizeof(uint16) * (uint)width)) {
-		memcpy(dstPtr, srcPtr, sizeof(uint16) * width * height);
+	if ((srcPitch == sizeof(Pixel) * (uint)width) && (dstPitch == sizeof(Pixel) * (uint)width)) {
+		memcpy(dstPtr, srcPtr, sizeof(Pixel) * width * height);
 		return;
 	}
 	while (height--) {
-		memcpy(dstPtr, srcPtr, sizeof(uint16) * width);
+		memcpy(dstPtr, srcPtr, sizeof(Pixel) * width);
 		srcPtr += srcPitch;
 		dstPtr += dstPitch;
 	}
 }
 
+void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	Normal1xTemplate<uint16>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+}
+
+void Normal1x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	Normal1xTemplate<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+}
+
 #ifdef USE_SCALERS
 
 
@@ -253,6 +271,39 @@ void Normal3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 	}
 }
 
+/**
+ * Trivial nearest-neighbor scaler for 32 bit pixels. The first line of each
+ * block is scaled horizontally, then copied to the remaining lines.
+ */
+template<int scale>
+static void Normal32Template(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	assert(IS_ALIGNED(dstPtr, 4));
+	while (height--) {
+		const uint32 *s = (const uint32 *)srcPtr;
+		uint32 *d = (uint32 *)dstPtr;
+		for (int i = 0; i < width; ++i) {
+			const uint32 color = *s++;
+			for (int j = 0; j < scale; ++j)
+				*d++ = color;
+		}
+
+		for (int j = 1; j < scale; ++j)
+			memcpy(dstPtr + j * dstPitch, dstPtr, width * scale * sizeof(uint32));
+
+		srcPtr += srcPitch;
+		dstPtr += dstPitch * scale;
+	}
+}
+
+void Normal2x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	Normal32Template<2>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+}
+
+void Normal3x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	Normal32Template<3>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+}
+
 #define interpolate_1_1		interpolate16_1_1<ColorMask>
 #define interpolate_1_1_1_1	interpolate16_1_1_1_1<ColorMask>
 
@@ -267,24 +318,27 @@ void Normal1o5xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uin
 	const uint32 dstPitch3 = dstPitch * 3;
 	const uint32 srcPitch2 = srcPitch * 2;
 
-	assert(IS_ALIGNED(dstPtr, 2));
+	typedef typename ScalerPixel<ColorMask::kBytesPerPixel>::Type Pixel;
+	const int p = sizeof(Pixel);
+
+	assert(IS_ALIGNED(dstPtr, p));
 	while (height > 0) {
 		r = dstPtr;
-		for (int i = 0; i < width; i += 2, r += 6) {
-			uint16 color0 = *(((const uint16 *)srcPtr) + i);
-			uint16 color1 = *(((const uint16 *)srcPtr) + i + 1);
-			uint16 color2 = *(((const uint16 *)(srcPtr + srcPitch)) + i);
-			uint16 color3 = *(((const uint16 *)(srcPtr + srcPitch)) + i + 1);
-
-			*(uint16 *)(r + 0) = color0;
-			*(uint16 *)(r + 2) = interpolate_1_1(color0, color1);
-			*(uint16 *)(r + 4) = color1;
-			*(uint16 *)(r + 0 + dstPitch) = interpolate_1_1(color0, color2);
-			*(uint16 *)(r + 2 + dstPitch) = interpolate_1_1_1_1(color0, color1, color2, color3);
-			*(uint16 *)(r + 4 + dstPitch) = interpolate_1_1(color1, color3);
-			*(uint16 *)(r + 0 + dstPitch2) = color2;
-			*(uint16 *)(r + 2 + dstPitch2) = interpolate_1_1(color2, color3);
-			*(uint16 *)(r + 4 + dstPitch2) = color3;
+		for (int i = 0; i < width; i += 2, r += 3 * p) {
+			Pixel color0 = *(((const Pixel *)srcPtr) + i);
+			Pixel color1 = *(((const Pixel *)srcPtr) + i + 1);
+			Pixel color2 = *(((const Pixel *)(srcPtr + srcPitch)) + i);
+			Pixel color3 = *(((const Pixel *)(srcPtr + srcPitch)) + i + 1);
+
+			*(Pixel *)(r + 0 * p) = color0;
+			*(Pixel *)(r + 1 * p) = interpolate_1_1(color0, color1);
+			*(Pixel *)(r + 2 * p) = color1;
+			*(Pixel *)(r + 0 * p + dstPitch) = interpolate_1_1(color0, color2);
+			*(Pixel *)(r + 1 * p + dstPitch) = interpolate_1_1_1_1(color0, color1, color2, color3);
+			*(Pixel *)(r + 2 * p + dstPitch) = interpolate_1_1(color1, color3);
+			*(Pixel *)(r + 0 * p + dstPitch2) = color2;
+			*(Pixel *)(r + 1 * p + dstPitch2) = interpolate_1_1(color2, color3);
+			*(Pixel *)(r + 2 * p + dstPitch2) = color3;
 		}
 		srcPtr += srcPitch2;
 		dstPtr += dstPitch3;
@@ -299,6 +353,10 @@ void Normal1o5x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstP
 		Normal1o5xTemplate<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 }
 
+void Normal1o5x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	Normal1o5xTemplate<Graphics::ColorMasks<888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+}
+
 /**
  * The Scale2x filter, also known as AdvMame2x.
  * See also http://scale2x.sourceforge.net
@@ -317,18 +375,30 @@ void AdvMame3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPi
 	scale(3, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 2, width, height);
 }
 
+void AdvMame2x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							 int width, int height) {
+	scale(2, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 4, width, height);
+}
+
+void AdvMame3x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							 int width, int height) {
+	scale(3, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 4, width, height);
+}
+
 template<typename ColorMask>
 void TV2xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 					int width, int height) {
-	const uint32 nextlineSrc = srcPitch / sizeof(uint16);
-	const uint16 *p = (const uint16 *)srcPtr;
+	typedef typename ScalerPixel<ColorMask::kBytesPerPixel>::Type Pixel;
+
+	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
+	const Pixel *p = (const Pixel *)srcPtr;
 
-	const uint32 nextlineDst = dstPitch / sizeof(uint16);
-	uint16 *q = (uint16 *)dstPtr;
+	const uint32 nextlineDst = dstPitch / sizeof(Pixel);
+	Pixel *q = (Pixel *)dstPtr;
 
 	while (height--) {
 		for (int i = 0, j = 0; i < width; ++i, j += 2) {
-			uint16 p1 = *(p + i);
+			Pixel p1 = *(p + i);
 			uint32 pi;
 
 			pi = (((p1 & ColorMask::kRedBlueMask) * 7) >> 3) & ColorMask::kRedBlueMask;
@@ -336,8 +406,8 @@ void TV2xTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 ds
 
 			*(q + j) = p1;
 			*(q + j + 1) = p1;
-			*(q + j + nextlineDst) = (uint16)pi;
-			*(q + j + nextlineDst + 1) = (uint16)pi;
+			*(q + j + nextlineDst) = (Pixel)pi;
+			*(q + j + nextlineDst + 1) = (Pixel)pi;
 		}
 		p += nextlineSrc;
 		q += nextlineDst << 1;
@@ -351,7 +421,12 @@ void TV2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 		TV2xTemplate<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 }
 
-static inline uint16 DOT_16(const uint16 *dotmatrix, uint16 c, int j, int i) {
+void TV2x_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	TV2xTemplate<Graphics::ColorMasks<888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+}
+
+template<typename Pixel>
+static inline Pixel DOT_16(const Pixel *dotmatrix, Pixel c, int j, int i) {
 	return c - ((c >> 2) & dotmatrix[((j & 3) << 2) + (i & 3)]);
 }
 
@@ -362,20 +437,19 @@ static inline uint16 DOT_16(const uint16 *dotmatrix, uint16 c, int j, int i) {
 // a way that also works together with aspect-ratio correction is left as an
 // exercise for the reader.)
 
-void DotMatrix(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+template<typename Pixel>
+static void DotMatrixTemplate(const Pixel *dotmatrix, const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 					int width, int height) {
 
-	const uint16 *dotmatrix = g_dotmatrix;
-
-	const uint32 nextlineSrc = srcPitch / sizeof(uint16);
-	const uint16 *p = (const uint16 *)srcPtr;
+	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
+	const Pixel *p = (const Pixel *)srcPtr;
 
-	const uint32 nextlineDst = dstPitch / sizeof(uint16);
-	uint16 *q = (uint16 *)dstPtr;
+	const uint32 nextlineDst = dstPitch / sizeof(Pixel);
+	Pixel *q = (Pixel *)dstPtr;
 
 	for (int j = 0, jj = 0; j < height; ++j, jj += 2) {
 		for (int i = 0, ii = 0; i < width; ++i, ii += 2) {
-			uint16 c = *(p + i);
+			Pixel c = *(p + i);
 			*(q + ii) = DOT_16(dotmatrix, c, jj, ii);
 			*(q + ii + 1) = DOT_16(dotmatrix, c, jj, ii + 1);
 			*(q + ii + nextlineDst) = DOT_16(dotmatrix, c, jj + 1, ii);
@@ -386,4 +460,12 @@ void DotMatrix(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPi
 	}
 }
 
+void DotMatrix(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	DotMatrixTemplate<uint16>(g_dotmatrix, srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+}
+
+void DotMatrix_32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	DotMatrixTemplate<uint32>(g_dotmatrix32, srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+}
+
 #endif // #ifdef USE_SCALERS
@@ -62,6 +62,36 @@ DECLARE_SCALER(HQ3x);
 
 #endif // #ifdef USE_SCALERS
 
+/**
+ * 32 bit variants of the scalers above. They operate on pixels with 8 bits
+ * per channel and the top byte unused (e.g. XRGB8888), and do not depend on
+ * the format passed to InitScalers().
+ */
+DECLARE_SCALER(Normal1x_32);
+
+#ifdef USE_SCALERS
+
+DECLARE_SCALER(Normal2x_32);
+DECLARE_SCALER(Normal3x_32);
+DECLARE_SCALER(Normal1o5x_32);
+
+DECLARE_SCALER(_2xSaI_32);
+DECLARE_SCALER(Super2xSaI_32);
+DECLARE_SCALER(SuperEagle_32);
+
+DECLARE_SCALER(AdvMame2x_32);
+DECLARE_SCALER(AdvMame3x_32);
+
+DECLARE_SCALER(TV2x_32);
+DECLARE_SCALER(DotMatrix_32);
+
+#ifdef USE_HQ_SCALERS
+DECLARE_SCALER(HQ2x_32);
+DECLARE_SCALER(HQ3x_32);
+#endif
+
+#endif // #ifdef USE_SCALERS
+
 // creates a 160x100 thumbnail for 320x200 games
 // and 160x120 thumbnail for 320x240 and 640x480 games
 // only 565 mode
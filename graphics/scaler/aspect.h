@@ -56,6 +56,18 @@ int stretch200To240(uint8 *buf,
                     int srcY,
                     int origSrcY);
 
+/**
+ * 32 bit variant of stretch200To240, for pixels with 8 bits per channel and
+ * the top byte unused.
+ */
+int stretch200To240_32(uint8 *buf,
+                       uint32 pitch,
+                       int width,
+                       int height,
+                       int srcX,
+                       int srcY,
+                       int origSrcY);
+
 
 /**
  * This filter (up)scales the source image vertically by a factor of 6/5.
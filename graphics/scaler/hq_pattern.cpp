@@ -0,0 +1,329 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/scaler/intern.h"
+#include "common/atomic.h"
+
+// Instruction sets always available when compiling for them
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define USE_HQ_PATTERN_SSE2
+#	include <emmintrin.h>
+#endif
+
+// SSSE3 is only used when the CPU supports it, which needs compiler support
+// for per-function target instruction sets
+#if defined(USE_HQ_PATTERN_SSE2) && defined(__GNUC__) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#	define USE_HQ_PATTERN_SSSE3
+#	include <tmmintrin.h>
+#endif
+
+#pragma mark -
+#pragma mark --- Reference implementation ---
+#pragma mark -
+
+template<typename ColorMask>
+static void computePatterns(const uint8 *src, uint32 srcPitch, int width, uint8 *patterns) {
+	typedef typename ScalerPixel<ColorMask::kBytesPerPixel>::Type Pixel;
+
+	const int nextline = srcPitch / sizeof(Pixel);
+	const int offsets[8] = {
+		-1 - nextline, -nextline, 1 - nextline,
+		-1,                       1,
+		-1 + nextline,  nextline, 1 + nextline
+	};
+	const Pixel *p = (const Pixel *)src;
+
+	for (int x = 0; x < width; ++x, ++p) {
+		const Pixel w5 = *p;
+		const int yuv5 = convertToYUV<ColorMask>(w5);
+
+		int pattern = 0;
+		for (int i = 0; i < 8; ++i) {
+			const Pixel w = p[offsets[i]];
+			if (w5 != w && diffYUV(yuv5, convertToYUV<ColorMask>(w)))
+				pattern |= 1 << i;
+		}
+		patterns[x] = pattern;
+	}
+}
+
+static const HQPatternKernels s_kernelsCPP = {
+	"C++",
+	&computePatterns<Graphics::ColorMasks<555> >,
+	&computePatterns<Graphics::ColorMasks<565> >,
+	&computePatterns<Graphics::ColorMasks<888> >
+};
+
+// The vector implementations below convert eight pixels at a time to Y, U and
+// V components in separate 16 bit lanes, using the same formula as the
+// RGBtoYUV table, and then compare them with the same thresholds as
+// diffYUV(). The constant offset of U and V does not matter for the
+// comparisons, so it is left out.
+
+#ifdef USE_HQ_PATTERN_SSE2
+
+#pragma mark -
+#pragma mark --- SSE2 implementation ---
+#pragma mark -
+
+struct YUVVectors {
+	__m128i y, u, v;
+};
+
+/** Expand n bit components to 8 bits like PixelFormat::colorToRGB does. */
+template<int bits>
+static inline __m128i expandSSE2(__m128i c) {
+	if (bits == 8)
+		return c;
+	return _mm_or_si128(_mm_slli_epi16(c, 8 - bits), _mm_srli_epi16(c, 2 * bits - 8));
+}
+
+/** Extract a component from eight 16 bit or 32 bit pixels into 16 bit lanes. */
+template<typename ColorMask, int shift, int bits>
+static inline __m128i extractSSE2(const uint8 *src) {
+	if (ColorMask::kBytesPerPixel == 2) {
+		const __m128i c = _mm_loadu_si128((const __m128i *)src);
+		return _mm_and_si128(_mm_srli_epi16(c, shift), _mm_set1_epi16((1 << bits) - 1));
+	} else {
+		const __m128i mask = _mm_set1_epi32((1 << bits) - 1);
+		const __m128i c0 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i *)src), shift), mask);
+		const __m128i c1 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i *)(src + 16)), shift), mask);
+		return _mm_packs_epi32(c0, c1);
+	}
+}
+
+static inline void convertToYUVSSE2(__m128i r, __m128i g, __m128i b, YUVVectors &yuv) {
+	yuv.y = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(r, g), b), 2);
+	yuv.u = _mm_srai_epi16(_mm_sub_epi16(r, b), 2);
+	yuv.v = _mm_srai_epi16(_mm_sub_epi16(_mm_slli_epi16(g, 1), _mm_add_epi16(r, b)), 3);
+}
+
+template<typename ColorMask>
+static inline void loadYUVSSE2(const uint8 *src, YUVVectors &yuv) {
+	const __m128i r = expandSSE2<ColorMask::kRedBits>(extractSSE2<ColorMask, ColorMask::kRedShift, ColorMask::kRedBits>(src));
+	const __m128i g = expandSSE2<ColorMask::kGreenBits>(extractSSE2<ColorMask, ColorMask::kGreenShift, ColorMask::kGreenBits>(src));
+	const __m128i b = expandSSE2<ColorMask::kBlueBits>(extractSSE2<ColorMask, ColorMask::kBlueShift, ColorMask::kBlueBits>(src));
+	convertToYUVSSE2(r, g, b, yuv);
+}
+
+static inline __m128i absSSE2(__m128i d) {
+	return _mm_max_epi16(d, _mm_sub_epi16(_mm_setzero_si128(), d));
+}
+
+/** Returns all bits set in the lanes in which diffYUV() would return true. */
+static inline __m128i diffYUVSSE2(const YUVVectors &a, const YUVVectors &b) {
+	__m128i diff = _mm_cmpgt_epi16(absSSE2(_mm_sub_epi16(a.y, b.y)), _mm_set1_epi16(0x30));
+	diff = _mm_or_si128(diff, _mm_cmpgt_epi16(absSSE2(_mm_sub_epi16(a.u, b.u)), _mm_set1_epi16(0x07)));
+	diff = _mm_or_si128(diff, _mm_cmpgt_epi16(absSSE2(_mm_sub_epi16(a.v, b.v)), _mm_set1_epi16(0x06)));
+	return diff;
+}
+
+template<typename ColorMask>
+static void computePatternsSSE2(const uint8 *src, uint32 srcPitch, int width, uint8 *patterns) {
+	const int bpp = ColorMask::kBytesPerPixel;
+	const int offsets[8] = {
+		-bpp - (int)srcPitch, -(int)srcPitch, bpp - (int)srcPitch,
+		-bpp,                                 bpp,
+		-bpp + (int)srcPitch,  (int)srcPitch, bpp + (int)srcPitch
+	};
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const uint8 *p = src + x * bpp;
+
+		YUVVectors center, neighbor;
+		loadYUVSSE2<ColorMask>(p, center);
+
+		__m128i pattern = _mm_setzero_si128();
+		for (int i = 0; i < 8; ++i) {
+			loadYUVSSE2<ColorMask>(p + offsets[i], neighbor);
+			pattern = _mm_or_si128(pattern, _mm_and_si128(diffYUVSSE2(center, neighbor), _mm_set1_epi16(1 << i)));
+		}
+		_mm_storel_epi64((__m128i *)(patterns + x), _mm_packus_epi16(pattern, pattern));
+	}
+
+	computePatterns<ColorMask>(src + x * bpp, srcPitch, width - x, patterns + x);
+}
+
+static const HQPatternKernels s_kernelsSSE2 = {
+	"SSE2",
+	&computePatternsSSE2<Graphics::ColorMasks<555> >,
+	&computePatternsSSE2<Graphics::ColorMasks<565> >,
+	&computePatternsSSE2<Graphics::ColorMasks<888> >
+};
+
+#endif // USE_HQ_PATTERN_SSE2
+
+#ifdef USE_HQ_PATTERN_SSSE3
+
+#pragma mark -
+#pragma mark --- SSSE3 implementation ---
+#pragma mark -
+
+#define HQ_PATTERN_SSSE3_FUNC __attribute__((target("ssse3")))
+
+// In addition to the SSE2 version, this converts each source pixel only once
+// per row and builds the left and right neighbors with palignr. The
+// components of 32 bit pixels are gathered with pshufb.
+
+/** Gather the byte at the given offset of eight 32 bit pixels into 16 bit lanes. */
+template<int offset>
+HQ_PATTERN_SSSE3_FUNC static inline __m128i extractSSSE3(__m128i c0, __m128i c1) {
+	const __m128i lo = _mm_setr_epi8(offset, -1, offset + 4, -1, offset + 8, -1, offset + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i hi = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, offset, -1, offset + 4, -1, offset + 8, -1, offset + 12, -1);
+	return _mm_or_si128(_mm_shuffle_epi8(c0, lo), _mm_shuffle_epi8(c1, hi));
+}
+
+template<typename ColorMask>
+HQ_PATTERN_SSSE3_FUNC static inline void loadYUVSSSE3(const uint8 *src, YUVVectors &yuv) {
+	if (ColorMask::kBytesPerPixel == 2) {
+		loadYUVSSE2<ColorMask>(src, yuv);
+	} else {
+		// Only used for ColorMasks<888>, which has 8 bit components at byte boundaries
+		const __m128i c0 = _mm_loadu_si128((const __m128i *)src);
+		const __m128i c1 = _mm_loadu_si128((const __m128i *)(src + 16));
+		const __m128i r = extractSSSE3<ColorMask::kRedShift / 8>(c0, c1);
+		const __m128i g = extractSSSE3<ColorMask::kGreenShift / 8>(c0, c1);
+		const __m128i b = extractSSSE3<ColorMask::kBlueShift / 8>(c0, c1);
+		convertToYUVSSE2(r, g, b, yuv);
+	}
+}
+
+/** Shift the pixels of next into prev by the given number of lanes. */
+template<int lanes>
+HQ_PATTERN_SSSE3_FUNC static inline void alignYUVSSSE3(const YUVVectors &next, const YUVVectors &prev, YUVVectors &yuv) {
+	yuv.y = _mm_alignr_epi8(next.y, prev.y, lanes * 2);
+	yuv.u = _mm_alignr_epi8(next.u, prev.u, lanes * 2);
+	yuv.v = _mm_alignr_epi8(next.v, prev.v, lanes * 2);
+}
+
+HQ_PATTERN_SSSE3_FUNC static inline __m128i diffYUVSSSE3(const YUVVectors &a, const YUVVectors &b) {
+	__m128i diff = _mm_cmpgt_epi16(_mm_abs_epi16(_mm_sub_epi16(a.y, b.y)), _mm_set1_epi16(0x30));
+	diff = _mm_or_si128(diff, _mm_cmpgt_epi16(_mm_abs_epi16(_mm_sub_epi16(a.u, b.u)), _mm_set1_epi16(0x07)));
+	diff = _mm_or_si128(diff, _mm_cmpgt_epi16(_mm_abs_epi16(_mm_sub_epi16(a.v, b.v)), _mm_set1_epi16(0x06)));
+	return diff;
+}
+
+HQ_PATTERN_SSSE3_FUNC static inline __m128i patternBitSSSE3(const YUVVectors &center, const YUVVectors &neighbor, int bit) {
+	return _mm_and_si128(diffYUVSSSE3(center, neighbor), _mm_set1_epi16(1 << bit));
+}
+
+template<typename ColorMask>
+HQ_PATTERN_SSSE3_FUNC static void computePatternsSSSE3(const uint8 *src, uint32 srcPitch, int width, uint8 *patterns) {
+	const int bpp = ColorMask::kBytesPerPixel;
+
+	// The rows above, at and below the pixels, starting at the left neighbor
+	// of the first pixel
+	const uint8 *rows[3] = {
+		src - srcPitch - bpp,
+		src - bpp,
+		src + srcPitch - bpp
+	};
+
+	// Each iteration loads the eight pixels following the ones in prev, so
+	// it reads up to seven pixels past the right neighbor of the last pixel
+	// it computes the pattern of.
+	int x = 0;
+	if (width >= 15) {
+		YUVVectors prev[3];
+		for (int i = 0; i < 3; ++i)
+			loadYUVSSSE3<ColorMask>(rows[i], prev[i]);
+
+		for (; x + 15 <= width; x += 8) {
+			YUVVectors next[3], mid[3], right[3];
+			for (int i = 0; i < 3; ++i) {
+				loadYUVSSSE3<ColorMask>(rows[i] + (x + 8) * bpp, next[i]);
+				alignYUVSSSE3<1>(next[i], prev[i], mid[i]);
+				alignYUVSSSE3<2>(next[i], prev[i], right[i]);
+			}
+
+			const YUVVectors &center = mid[1];
+			__m128i pattern = patternBitSSSE3(center, prev[0], 0);
+			pattern = _mm_or_si128(pattern, patternBitSSSE3(center, mid[0], 1));
+			pattern = _mm_or_si128(pattern, patternBitSSSE3(center, right[0], 2));
+			pattern = _mm_or_si128(pattern, patternBitSSSE3(center, prev[1], 3));
+			pattern = _mm_or_si128(pattern, patternBitSSSE3(center, right[1], 4));
+			pattern = _mm_or_si128(pattern, patternBitSSSE3(center, prev[2], 5));
+			pattern = _mm_or_si128(pattern, patternBitSSSE3(center, mid[2], 6));
+			pattern = _mm_or_si128(pattern, patternBitSSSE3(center, right[2], 7));
+			_mm_storel_epi64((__m128i *)(patterns + x), _mm_packus_epi16(pattern, pattern));
+
+			for (int i = 0; i < 3; ++i)
+				prev[i] = next[i];
+		}
+	}
+
+	computePatterns<ColorMask>(src + x * bpp, srcPitch, width - x, patterns + x);
+}
+
+static const HQPatternKernels s_kernelsSSSE3 = {
+	"SSSE3",
+	&computePatternsSSSE3<Graphics::ColorMasks<555> >,
+	&computePatternsSSSE3<Graphics::ColorMasks<565> >,
+	&computePatternsSSSE3<Graphics::ColorMasks<888> >
+};
+
+#endif // USE_HQ_PATTERN_SSSE3
+
+#pragma mark -
+#pragma mark --- Dispatch ---
+#pragma mark -
+
+static const HQPatternKernels *s_kernels[3];
+static volatile int32 s_kernelsCount = 0;
+
+static void initHQPatternKernels() {
+	if (Common::atomicLoad(&s_kernelsCount))
+		return;
+
+	uint count = 0;
+	s_kernels[count++] = &s_kernelsCPP;
+
+#ifdef USE_HQ_PATTERN_SSE2
+	s_kernels[count++] = &s_kernelsSSE2;
+#endif
+
+#ifdef USE_HQ_PATTERN_SSSE3
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("ssse3"))
+		s_kernels[count++] = &s_kernelsSSSE3;
+#endif
+
+	// Concurrent callers all arrive at the same result
+	Common::atomicStore(&s_kernelsCount, count);
+}
+
+uint getHQPatternKernelsCount() {
+	initHQPatternKernels();
+	return s_kernelsCount;
+}
+
+const HQPatternKernels &getHQPatternKernels(uint index) {
+	initHQPatternKernels();
+	assert(index < (uint)s_kernelsCount);
+	return *s_kernels[index];
+}
+
+const HQPatternKernels &getBestHQPatternKernels() {
+	initHQPatternKernels();
+	return *s_kernels[s_kernelsCount - 1];
+}
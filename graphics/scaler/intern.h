@@ -27,6 +27,24 @@
 #include "graphics/colormasks.h"
 
 
+/**
+ * The type holding a single pixel with the given number of bytes.
+ */
+template<int bytesPerPixel>
+struct ScalerPixel {
+};
+
+template<>
+struct ScalerPixel<2> {
+	typedef uint16 Type;
+};
+
+template<>
+struct ScalerPixel<4> {
+	typedef uint32 Type;
+};
+
+
 /**
  * Interpolate two 16 bit pixel *pairs* at once with equal weights 1.
  * In particular, p1 and p2 can contain two pixels each in the upper
@@ -179,6 +197,92 @@ static inline unsigned interpolate16_1_1_1_1(unsigned p1, unsigned p2, unsigned
 	return ((p1+p2+p3+p4) - lowbits) >> 2;
 }
 
+/**
+ * Convert a pixel to YUV (encoded 8-8-8), as used for the similarity checks
+ * of the hq scaler family. This computes the same values as the RGBtoYUV
+ * table, which is used instead for 16 bit pixels.
+ */
+template<typename ColorMask>
+inline int convertToYUV(uint32 color) {
+	// Expand the components to 8 bits the same way PixelFormat::colorToRGB does
+	int r = (color & ColorMask::kRedMask) >> ColorMask::kRedShift;
+	int g = (color & ColorMask::kGreenMask) >> ColorMask::kGreenShift;
+	int b = (color & ColorMask::kBlueMask) >> ColorMask::kBlueShift;
+	r = (r << (8 - ColorMask::kRedBits)) | (r >> (2 * ColorMask::kRedBits - 8));
+	g = (g << (8 - ColorMask::kGreenBits)) | (g >> (2 * ColorMask::kGreenBits - 8));
+	b = (b << (8 - ColorMask::kBlueBits)) | (b >> (2 * ColorMask::kBlueBits - 8));
+
+	const int y = (r + g + b) >> 2;
+	const int u = 128 + ((r - b) >> 2);
+	const int v = 128 + ((-r + 2 * g - b) >> 3);
+	return (y << 16) | (u << 8) | v;
+}
+
+#ifdef USE_HQ_SCALERS
+extern "C" uint32 *RGBtoYUV;
+
+template<>
+inline int convertToYUV<Graphics::ColorMasks<565> >(uint32 color) {
+	return RGBtoYUV[color];
+}
+
+template<>
+inline int convertToYUV<Graphics::ColorMasks<555> >(uint32 color) {
+	return RGBtoYUV[color];
+}
+
+/**
+ * Compute the hq pattern of a number of consecutive pixels in a row. Bit n of
+ * a pattern is set when the pixel differs from its neighbor n according to
+ * diffYUV(), with the neighbors numbered like this:
+ *
+ *   0 1 2
+ *   3 . 4
+ *   5 6 7
+ *
+ * @param src       the first pixel
+ * @param srcPitch  the pitch of the source surface
+ * @param width     the number of pixels, at most kHQPatternChunkSize
+ * @param patterns  receives one pattern per pixel
+ */
+typedef void (*HQPatternProc)(const uint8 *src, uint32 srcPitch, int width, uint8 *patterns);
+
+enum {
+	/** The number of pixels the hq scalers compute the patterns of at once. */
+	kHQPatternChunkSize = 256
+};
+
+/**
+ * A set of pattern procedures for the pixel formats the hq scalers support,
+ * all using the same instruction set.
+ */
+struct HQPatternKernels {
+	const char *name;
+	HQPatternProc pattern555;
+	HQPatternProc pattern565;
+	HQPatternProc pattern888;
+};
+
+/**
+ * Returns the number of available pattern kernel sets. The first one is
+ * always the portable C++ reference implementation.
+ */
+uint getHQPatternKernelsCount();
+
+/** Returns the pattern kernel set with the given index. */
+const HQPatternKernels &getHQPatternKernels(uint index);
+
+/** Returns the fastest pattern kernel set supported by the CPU. */
+const HQPatternKernels &getBestHQPatternKernels();
+
+/**
+ * Run the HQ2x/HQ3x scalers with the given pattern kernels and pixel format
+ * (555, 565 or 888). Mostly useful for testing the different kernels.
+ */
+void HQ2xWithPatternKernels(const HQPatternKernels &kernels, int bitFormat, const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
+void HQ3xWithPatternKernels(const HQPatternKernels &kernels, int bitFormat, const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
+#endif
+
 /**
  * Compare two YUV values (encoded 8-8-8) and check if they differ by more than
  * a certain hard coded threshold. Used by the hq scaler family.
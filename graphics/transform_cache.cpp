@@ -0,0 +1,142 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transform_cache.h"
+
+namespace Graphics {
+
+TransformCache::TransformCache(uint32 maxBytes) : _usedBytes(0), _maxBytes(maxBytes) {
+	resetStats();
+}
+
+TransformCache::~TransformCache() {
+	clear();
+}
+
+uint TransformCache::KeyHash::operator()(const Key &key) const {
+	uint hash = (uint)(size_t)key.source;
+	hash = hash * 31 + (uint16)key.srcRect.left;
+	hash = hash * 31 + (uint16)key.srcRect.top;
+	hash = hash * 31 + (uint16)key.dstWidth;
+	hash = hash * 31 + (uint16)key.dstHeight;
+	hash = hash * 31 + (uint)key.transform._angle;
+	hash = hash * 31 + (uint)key.transform._zoom.x;
+	hash = hash * 31 + (uint)key.transform._zoom.y;
+	hash = hash * 31 + key.transform._flip;
+	return hash;
+}
+
+bool TransformCache::KeyEqual::operator()(const Key &a, const Key &b) const {
+	// TransformStruct::operator== ignores the hotspot, which rotoscale() uses.
+	return a.source == b.source &&
+	       a.srcRect == b.srcRect &&
+	       a.dstWidth == b.dstWidth &&
+	       a.dstHeight == b.dstHeight &&
+	       a.transform == b.transform &&
+	       a.transform._hotspot == b.transform._hotspot;
+}
+
+TransformCache::Key TransformCache::makeKey(const void *source, const Common::Rect &srcRect, const TransformStruct &transform, int16 dstWidth, int16 dstHeight) {
+	Key key;
+	key.source = source;
+	key.srcRect = srcRect;
+	key.transform = transform;
+	key.dstWidth = dstWidth;
+	key.dstHeight = dstHeight;
+	return key;
+}
+
+const Surface *TransformCache::get(const void *source, const Common::Rect &srcRect, const TransformStruct &transform, int16 dstWidth, int16 dstHeight) {
+	Entry *entry = _entries.getVal(makeKey(source, srcRect, transform, dstWidth, dstHeight), nullptr);
+	if (!entry) {
+		_stats.misses++;
+		return nullptr;
+	}
+
+	_stats.hits++;
+	if (entry->lruPos != _lru.begin()) {
+		_lru.erase(entry->lruPos);
+		_lru.push_front(entry);
+		entry->lruPos = _lru.begin();
+	}
+	return &entry->surface;
+}
+
+void TransformCache::put(const void *source, const Common::Rect &srcRect, const TransformStruct &transform, int16 dstWidth, int16 dstHeight, const Surface &surface) {
+	uint32 bytes = surface.pitch * surface.h;
+	if (bytes > _maxBytes) {
+		return;
+	}
+
+	Key key = makeKey(source, srcRect, transform, dstWidth, dstHeight);
+	Entry *old = _entries.getVal(key, nullptr);
+	if (old) {
+		removeEntry(old);
+	}
+
+	while (_usedBytes + bytes > _maxBytes) {
+		removeEntry(_lru.back());
+		_stats.evictions++;
+	}
+
+	Entry *entry = new Entry();
+	entry->key = key;
+	entry->surface.copyFrom(surface);
+	entry->bytes = bytes;
+	_lru.push_front(entry);
+	entry->lruPos = _lru.begin();
+	_entries[key] = entry;
+	_usedBytes += bytes;
+}
+
+void TransformCache::invalidate(const void *source) {
+	EntryList::iterator it = _lru.begin();
+	while (it != _lru.end()) {
+		Entry *entry = *it;
+		++it;
+		if (entry->key.source == source) {
+			removeEntry(entry);
+		}
+	}
+}
+
+void TransformCache::clear() {
+	while (!_lru.empty()) {
+		removeEntry(_lru.back());
+	}
+}
+
+void TransformCache::resetStats() {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+}
+
+void TransformCache::removeEntry(Entry *entry) {
+	_entries.erase(entry->key);
+	_lru.erase(entry->lruPos);
+	_usedBytes -= entry->bytes;
+	entry->surface.free();
+	delete entry;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TRANSFORM_CACHE_H
+#define GRAPHICS_TRANSFORM_CACHE_H
+
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/rect.h"
+#include "graphics/surface.h"
+#include "graphics/transform_struct.h"
+
+namespace Graphics {
+
+/**
+ * A least recently used cache of transformed (scaled or rotated) copies of
+ * surfaces, so that drawing the same frame with the same transform over and
+ * over again does not have to recompute it every time.
+ *
+ * Entries are keyed by an opaque source pointer, the part of the source used,
+ * the transform and the requested size. The cache does not look at the
+ * source itself: whoever owns it has to call invalidate() whenever its pixels
+ * change or it is destroyed.
+ */
+class TransformCache {
+public:
+	/** Counters describing how well the cache works. */
+	struct Stats {
+		uint32 hits;
+		uint32 misses;
+		/** Number of entries dropped to stay within the budget */
+		uint32 evictions;
+	};
+
+	/**
+	 * Create an empty cache.
+	 *
+	 * @param maxBytes  the maximum number of pixel bytes kept in the cache
+	 */
+	TransformCache(uint32 maxBytes);
+	~TransformCache();
+
+	/**
+	 * Look up a transformed surface.
+	 *
+	 * @return the cached surface, or nullptr if there is none. The surface
+	 *         stays valid until the next call to put(), invalidate() or clear().
+	 */
+	const Surface *get(const void *source, const Common::Rect &srcRect, const TransformStruct &transform, int16 dstWidth, int16 dstHeight);
+
+	/**
+	 * Store a copy of a transformed surface, evicting the least recently used
+	 * entries as needed. Surfaces larger than the whole budget are not stored.
+	 */
+	void put(const void *source, const Common::Rect &srcRect, const TransformStruct &transform, int16 dstWidth, int16 dstHeight, const Surface &surface);
+
+	/** Drop all entries made from the given source. */
+	void invalidate(const void *source);
+
+	/** Drop all entries. */
+	void clear();
+
+	uint size() const { return _entries.size(); }
+	uint32 getUsedBytes() const { return _usedBytes; }
+	uint32 getMaxBytes() const { return _maxBytes; }
+
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	struct Key {
+		const void *source;
+		Common::Rect srcRect;
+		TransformStruct transform;
+		int16 dstWidth;
+		int16 dstHeight;
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const;
+	};
+
+	struct KeyEqual {
+		bool operator()(const Key &a, const Key &b) const;
+	};
+
+	struct Entry;
+	typedef Common::List<Entry *> EntryList;
+
+	struct Entry {
+		Key key;
+		Surface surface;
+		uint32 bytes;
+		EntryList::iterator lruPos;
+	};
+
+	static Key makeKey(const void *source, const Common::Rect &srcRect, const TransformStruct &transform, int16 dstWidth, int16 dstHeight);
+	void removeEntry(Entry *entry);
+
+	/** Most recently used entries first. */
+	EntryList _lru;
+	Common::HashMap<Key, Entry *, KeyHash, KeyEqual> _entries;
+	uint32 _usedBytes;
+	uint32 _maxBytes;
+	Stats _stats;
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -39,6 +39,13 @@
 
 //#define ENABLE_BILINEAR
 
+// SSE2 is always available when compiling for it. The kernels depend on the
+// little endian pixel layout.
+#if defined(SCUMM_LITTLE_ENDIAN) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#	define USE_TRANSPARENT_BLIT_SSE2
+#	include <emmintrin.h>
+#endif
+
 namespace Graphics {
 
 static const int kAShift = 0;//img->format.aShift;
@@ -85,53 +92,270 @@ TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Sur
 }
 
 /**
- * Optimized version of doBlit to be used w/opaque blitting (no alpha).
+ * Copy a row, making every pixel opaque.
  */
-void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
-
-	byte *in;
-	byte *out;
-
-	for (uint32 i = 0; i < height; i++) {
-		out = outo;
-		in = ino;
+static void blitRowOpaque(const byte *in, int32 inStep, byte *out, uint32 width, uint32 color) {
+	if (inStep == 4) {
 		memcpy(out, in, width * 4);
 		for (uint32 j = 0; j < width; j++) {
 			out[kAIndex] = 0xFF;
 			out += 4;
 		}
-		outo += pitch;
-		ino += inoStep;
+	} else {
+		for (uint32 j = 0; j < width; j++) {
+			*(uint32 *)out = *(const uint32 *)in;
+			out[kAIndex] = 0xFF;
+			out += 4;
+			in += inStep;
+		}
 	}
 }
 
 /**
- * Optimized version of doBlit to be used w/binary blitting (blit or no-blit, no blending).
+ * Copy the pixels of a row which are not fully transparent, making them
+ * opaque (blit or no-blit, no blending).
  */
-void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+static void blitRowBinary(const byte *in, int32 inStep, byte *out, uint32 width, uint32 color) {
+	for (uint32 j = 0; j < width; j++) {
+		uint32 pix = *(const uint32 *)in;
+		int a = (pix >> kAShift) & 0xff;
 
-	byte *in;
-	byte *out;
-
-	for (uint32 i = 0; i < height; i++) {
-		out = outo;
-		in = ino;
-		for (uint32 j = 0; j < width; j++) {
-			uint32 pix = *(uint32 *)in;
-			int a = (pix >> kAShift) & 0xff;
+		if (a != 0) {   // Full opacity (Any value not exactly 0 is Opaque here)
+			*(uint32 *)out = pix;
+			out[kAIndex] = 0xFF;
+		}
+		out += 4;
+		in += inStep;
+	}
+}
 
-			if (a != 0) {   // Full opacity (Any value not exactly 0 is Opaque here)
-				*(uint32 *)out = pix;
-				out[kAIndex] = 0xFF;
-			}
-			out += 4;
-			in += inStep;
+/**
+ * Alpha blend a row without color modulation.
+ */
+static void blitRowAlphaBlend(const byte *in, int32 inStep, byte *out, uint32 width, uint32 color) {
+	for (uint32 j = 0; j < width; j++) {
+
+		if (in[kAIndex] != 0) {
+			out[kAIndex] = 255;
+			out[kRIndex] = ((in[kRIndex] * in[kAIndex]) + out[kRIndex] * (255 - in[kAIndex])) >> 8;
+			out[kGIndex] = ((in[kGIndex] * in[kAIndex]) + out[kGIndex] * (255 - in[kAIndex])) >> 8;
+			out[kBIndex] = ((in[kBIndex] * in[kAIndex]) + out[kBIndex] * (255 - in[kAIndex])) >> 8;
 		}
+
+		in += inStep;
+		out += 4;
+	}
+}
+
+/**
+ * Alpha blend a row with color modulation.
+ * @color colormod in 0xAARRGGBB format
+ */
+static void blitRowAlphaBlendColor(const byte *in, int32 inStep, byte *out, uint32 width, uint32 color) {
+	byte ca = (color >> kAModShift) & 0xFF;
+	byte cr = (color >> kRModShift) & 0xFF;
+	byte cg = (color >> kGModShift) & 0xFF;
+	byte cb = (color >> kBModShift) & 0xFF;
+
+	for (uint32 j = 0; j < width; j++) {
+
+		uint32 ina = in[kAIndex] * ca >> 8;
+		out[kAIndex] = 255;
+		out[kBIndex] = (out[kBIndex] * (255 - ina) >> 8);
+		out[kGIndex] = (out[kGIndex] * (255 - ina) >> 8);
+		out[kRIndex] = (out[kRIndex] * (255 - ina) >> 8);
+
+		out[kBIndex] = out[kBIndex] + (in[kBIndex] * ina * cb >> 16);
+		out[kGIndex] = out[kGIndex] + (in[kGIndex] * ina * cg >> 16);
+		out[kRIndex] = out[kRIndex] + (in[kRIndex] * ina * cr >> 16);
+
+		in += inStep;
+		out += 4;
+	}
+}
+
+static const TransparentBlitKernels s_blitKernelsCPP = {
+	"C++",
+	&blitRowOpaque,
+	&blitRowBinary,
+	&blitRowAlphaBlend,
+	&blitRowAlphaBlendColor
+};
+
+#ifdef USE_TRANSPARENT_BLIT_SSE2
+
+// The vector kernels process four pixels at a time and leave the remaining
+// pixels of a row to the C++ kernels. They only support the little endian
+// pixel layout, where the alpha component is the lowest byte of a pixel.
+// Mirrored rows are read four pixels at a time as well, and reversed.
+// All arithmetic is done in 16 bit lanes and matches the C++ kernels
+// exactly.
+
+static inline __m128i loadPixels(const byte *in, int32 inStep) {
+	if (inStep > 0)
+		return _mm_loadu_si128((const __m128i *)in);
+	else
+		return _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(in - 12)), _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+/** Broadcast the alpha lane of both pixels in 16 bit lanes to their other lanes. */
+static inline __m128i broadcastAlpha(__m128i pixels16) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels16, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+static void blitRowOpaqueSSE2(const byte *in, int32 inStep, byte *out, uint32 width, uint32 color) {
+	const __m128i alphaMask = _mm_set1_epi32(0xFF);
+
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		_mm_storeu_si128((__m128i *)out, _mm_or_si128(loadPixels(in, inStep), alphaMask));
+		in += 4 * inStep;
+		out += 16;
+	}
+
+	blitRowOpaque(in, inStep, out, width - j, color);
+}
+
+static void blitRowBinarySSE2(const byte *in, int32 inStep, byte *out, uint32 width, uint32 color) {
+	const __m128i alphaMask = _mm_set1_epi32(0xFF);
+	const __m128i zero = _mm_setzero_si128();
+
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = loadPixels(in, inStep);
+		const __m128i dst = _mm_loadu_si128((const __m128i *)out);
+		const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(src, alphaMask), zero);
+
+		const __m128i result = _mm_or_si128(_mm_and_si128(transparent, dst),
+		                                    _mm_andnot_si128(transparent, _mm_or_si128(src, alphaMask)));
+		_mm_storeu_si128((__m128i *)out, result);
+		in += 4 * inStep;
+		out += 16;
+	}
+
+	blitRowBinary(in, inStep, out, width - j, color);
+}
+
+/** (src * a + dst * (255 - a)) >> 8 for two pixels in 16 bit lanes. */
+static inline __m128i blendPixels(__m128i src16, __m128i dst16) {
+	const __m128i alpha = broadcastAlpha(src16);
+	const __m128i invAlpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src16, alpha), _mm_mullo_epi16(dst16, invAlpha)), 8);
+}
+
+static void blitRowAlphaBlendSSE2(const byte *in, int32 inStep, byte *out, uint32 width, uint32 color) {
+	const __m128i alphaMask = _mm_set1_epi32(0xFF);
+	const __m128i zero = _mm_setzero_si128();
+
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = loadPixels(in, inStep);
+		const __m128i dst = _mm_loadu_si128((const __m128i *)out);
+		const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(src, alphaMask), zero);
+
+		const __m128i lo = blendPixels(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+		const __m128i hi = blendPixels(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+		const __m128i blended = _mm_or_si128(_mm_packus_epi16(lo, hi), alphaMask);
+
+		const __m128i result = _mm_or_si128(_mm_and_si128(transparent, dst), _mm_andnot_si128(transparent, blended));
+		_mm_storeu_si128((__m128i *)out, result);
+		in += 4 * inStep;
+		out += 16;
+	}
+
+	blitRowAlphaBlend(in, inStep, out, width - j, color);
+}
+
+/**
+ * Blend two pixels in 16 bit lanes with color modulation:
+ * ina = a * ca >> 8, dst * (255 - ina) >> 8 + (src * cmod * ina >> 16)
+ */
+static inline __m128i blendPixelsColor(__m128i src16, __m128i dst16, __m128i ca, __m128i colorMod) {
+	const __m128i lowByte = _mm_set1_epi16(0xFF);
+	const __m128i ina = _mm_srli_epi16(_mm_mullo_epi16(broadcastAlpha(src16), ca), 8);
+	const __m128i dstPart = _mm_srli_epi16(_mm_mullo_epi16(dst16, _mm_sub_epi16(lowByte, ina)), 8);
+	const __m128i srcPart = _mm_mulhi_epu16(_mm_mullo_epi16(src16, colorMod), ina);
+	// The C++ kernel stores the sum in a byte
+	return _mm_and_si128(_mm_add_epi16(dstPart, srcPart), lowByte);
+}
+
+static void blitRowAlphaBlendColorSSE2(const byte *in, int32 inStep, byte *out, uint32 width, uint32 color) {
+	const __m128i alphaMask = _mm_set1_epi32(0xFF);
+	const __m128i zero = _mm_setzero_si128();
+	const short cr = (color >> kRModShift) & 0xFF;
+	const short cg = (color >> kGModShift) & 0xFF;
+	const short cb = (color >> kBModShift) & 0xFF;
+	const __m128i ca = _mm_set1_epi16((color >> kAModShift) & 0xFF);
+	const __m128i colorMod = _mm_set_epi16(cr, cg, cb, 0, cr, cg, cb, 0);
+
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i src = loadPixels(in, inStep);
+		const __m128i dst = _mm_loadu_si128((const __m128i *)out);
+
+		const __m128i lo = blendPixelsColor(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero), ca, colorMod);
+		const __m128i hi = blendPixelsColor(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero), ca, colorMod);
+		_mm_storeu_si128((__m128i *)out, _mm_or_si128(_mm_packus_epi16(lo, hi), alphaMask));
+		in += 4 * inStep;
+		out += 16;
+	}
+
+	blitRowAlphaBlendColor(in, inStep, out, width - j, color);
+}
+
+static const TransparentBlitKernels s_blitKernelsSSE2 = {
+	"SSE2",
+	&blitRowOpaqueSSE2,
+	&blitRowBinarySSE2,
+	&blitRowAlphaBlendSSE2,
+	&blitRowAlphaBlendColorSSE2
+};
+
+#endif
+
+static const TransparentBlitKernels *const s_blitKernels[] = {
+	&s_blitKernelsCPP,
+#ifdef USE_TRANSPARENT_BLIT_SSE2
+	&s_blitKernelsSSE2,
+#endif
+};
+
+uint getTransparentBlitKernelsCount() {
+	return ARRAYSIZE(s_blitKernels);
+}
+
+const TransparentBlitKernels &getTransparentBlitKernels(uint index) {
+	assert(index < ARRAYSIZE(s_blitKernels));
+	return *s_blitKernels[index];
+}
+
+const TransparentBlitKernels &getBestTransparentBlitKernels() {
+	// The kernels are sorted from slowest to fastest
+	return *s_blitKernels[ARRAYSIZE(s_blitKernels) - 1];
+}
+
+static void blitRows(TransparentBlitRowProc proc, byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	for (uint32 i = 0; i < height; i++) {
+		proc(ino, inStep, outo, width, color);
 		outo += pitch;
 		ino += inoStep;
 	}
 }
 
+/**
+ * Optimized version of doBlit to be used w/opaque blitting (no alpha).
+ */
+void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	blitRows(getBestTransparentBlitKernels().opaque, ino, outo, width, height, pitch, inStep, inoStep, 0xFFFFFFFF);
+}
+
+/**
+ * Optimized version of doBlit to be used w/binary blitting (blit or no-blit, no blending).
+ */
+void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep) {
+	blitRows(getBestTransparentBlitKernels().binary, ino, outo, width, height, pitch, inStep, inoStep, 0xFFFFFFFF);
+}
+
 /**
  * Optimized version of doBlit to be used with alpha blended blitting
  * @param ino a pointer to the input surface
@@ -144,58 +368,11 @@ void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32
  * @color colormod in 0xAARRGGBB format - 0xFFFFFFFF for no colormod
  */
 void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
-	byte *in;
-	byte *out;
-
-	if (color == 0xffffffff) {
-
-		for (uint32 i = 0; i < height; i++) {
-			out = outo;
-			in = ino;
-			for (uint32 j = 0; j < width; j++) {
-
-				if (in[kAIndex] != 0) {
-					out[kAIndex] = 255;
-					out[kRIndex] = ((in[kRIndex] * in[kAIndex]) + out[kRIndex] * (255 - in[kAIndex])) >> 8;
-					out[kGIndex] = ((in[kGIndex] * in[kAIndex]) + out[kGIndex] * (255 - in[kAIndex])) >> 8;
-					out[kBIndex] = ((in[kBIndex] * in[kAIndex]) + out[kBIndex] * (255 - in[kAIndex])) >> 8;
-				}
-
-				in += inStep;
-				out += 4;
-			}
-			outo += pitch;
-			ino += inoStep;
-		}
-	} else {
-
-		byte ca = (color >> kAModShift) & 0xFF;
-		byte cr = (color >> kRModShift) & 0xFF;
-		byte cg = (color >> kGModShift) & 0xFF;
-		byte cb = (color >> kBModShift) & 0xFF;
-
-		for (uint32 i = 0; i < height; i++) {
-			out = outo;
-			in = ino;
-			for (uint32 j = 0; j < width; j++) {
-
-				uint32 ina = in[kAIndex] * ca >> 8;
-				out[kAIndex] = 255;
-				out[kBIndex] = (out[kBIndex] * (255 - ina) >> 8);
-				out[kGIndex] = (out[kGIndex] * (255 - ina) >> 8);
-				out[kRIndex] = (out[kRIndex] * (255 - ina) >> 8);
-
-				out[kBIndex] = out[kBIndex] + (in[kBIndex] * ina * cb >> 16);
-				out[kGIndex] = out[kGIndex] + (in[kGIndex] * ina * cg >> 16);
-				out[kRIndex] = out[kRIndex] + (in[kRIndex] * ina * cr >> 16);
-
-				in += inStep;
-				out += 4;
-			}
-			outo += pitch;
-			ino += inoStep;
-		}
-	}
+	const TransparentBlitKernels &kernels = getBestTransparentBlitKernels();
+	if (color == 0xffffffff)
+		blitRows(kernels.alphaBlend, ino, outo, width, height, pitch, inStep, inoStep, color);
+	else
+		blitRows(kernels.alphaBlendColor, ino, outo, width, height, pitch, inStep, inoStep, color);
 }
 
 /**
@@ -68,6 +68,44 @@ enum AlphaType {
     ALPHA_FULL = 2
 };
 
+/**
+ * Blit one row of pixels.
+ *
+ * @param in     the first source pixel
+ * @param inStep offset in bytes from one source pixel to the next, either 4
+ *               or -4 for horizontally flipped rows
+ * @param out    the first target pixel
+ * @param width  number of pixels
+ * @param color  colormod in 0xAARRGGBB format, if used by the kernel
+ */
+typedef void (*TransparentBlitRowProc)(const byte *in, int32 inStep, byte *out, uint32 width, uint32 color);
+
+/**
+ * Row kernels used by TransparentSurface::blit() for the common cases of
+ * normal blending. All implementations give the same results.
+ */
+struct TransparentBlitKernels {
+	const char *name;
+	/** ALPHA_OPAQUE without color modulation */
+	TransparentBlitRowProc opaque;
+	/** ALPHA_BINARY without color modulation */
+	TransparentBlitRowProc binary;
+	/** ALPHA_FULL without color modulation */
+	TransparentBlitRowProc alphaBlend;
+	/** Color modulation, including the alpha value of the color */
+	TransparentBlitRowProc alphaBlendColor;
+};
+
+/**
+ * Return the number of kernel implementations available on this CPU.
+ * Index 0 is always the C++ reference implementation.
+ */
+uint getTransparentBlitKernelsCount();
+const TransparentBlitKernels &getTransparentBlitKernels(uint index);
+
+/** Return the fastest kernel implementation, as used by blit(). */
+const TransparentBlitKernels &getBestTransparentBlitKernels();
+
 /**
  * A transparent graphics surface, which implements alpha blitting.
  */
@@ -24,6 +24,7 @@
 #include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/hashmap.h"
 #include "common/unzip.h"
 #include "common/tokenizer.h"
 #include "common/translation.h"
@@ -84,6 +85,18 @@ struct WidgetDrawData {
 
 	bool _buffer;
 
+	/** Whether the result of drawing the item may be cached, see DrawDataCache */
+	bool _cacheable;
+
+	/** Whether the first step covers the whole surface, hiding what was drawn before */
+	bool _opaque;
+
+	/**
+	 * Renderer colors (bit i is index i of VectorRenderer::getColors())
+	 * which the item may use without setting them first.
+	 */
+	byte _inheritedColors;
+
 
 	/**
 	 * Calculates the background threshold offset of a given DrawData item.
@@ -93,8 +106,98 @@ struct WidgetDrawData {
 	 * value will be added when restoring the background of the widget.
 	 */
 	void calcBackgroundOffset();
+
+	/**
+	 * Calculates whether and how the item can be cached. Like
+	 * calcBackgroundOffset() this must be called after loading all
+	 * DrawSteps of the item.
+	 */
+	void calcCacheInfo();
 };
 
+/**
+ * Cache of rendered DrawData items.
+ *
+ * The look of an item depends on more than its own draw steps: shadows and
+ * anti-aliased edges are blended with what was drawn below, and steps may
+ * leave colors unset. So besides the item, its size and its dynamic data,
+ * an entry stores the colors the item inherited and the pixels below it.
+ * An entry is only used if all of these match, and then its pixels are
+ * copied instead of running the draw steps again.
+ *
+ * Entries are looked up by their key in a hash map. Entries with the same
+ * key but different pixels below them are chained from there. A separate
+ * list keeps all entries in the order they were used.
+ */
+class DrawDataCache {
+public:
+	struct Key {
+		const WidgetDrawData *data;
+		uint32 dynamic;
+		int16 width, height;  ///< Size of the widget area
+		Common::Rect rect;    ///< Area drawn to, relative to the widget area
+		byte parity;          ///< Lowest bits of the widget position, used by gradient dithering
+		bool shadows;
+		uint32 colors[Graphics::VectorRenderer::kColorCount];
+
+		bool operator==(const Key &k) const;
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &k) const;
+	};
+
+	DrawDataCache(uint32 maxBytes) : _usedBytes(0), _maxBytes(maxBytes) {}
+	~DrawDataCache() { clear(); }
+
+	/**
+	 * Draw a cached item, if there is an entry for it.
+	 *
+	 * @param key Key of the item.
+	 * @param target Surface to draw on.
+	 * @param rect Area of the target the item draws to.
+	 * @return true if the item was drawn.
+	 */
+	bool draw(const Key &key, Graphics::Surface *target, const Common::Rect &rect);
+
+	/**
+	 * Store the result of drawing an item.
+	 *
+	 * @param key Key of the item.
+	 * @param before Copy of the pixels below the item, or 0 if the item
+	 *               is opaque. The cache takes ownership of it.
+	 * @param target Surface the item was drawn on.
+	 * @param rect Area of the target the item was drawn to.
+	 */
+	void add(const Key &key, Graphics::Surface *before, const Graphics::Surface &target, const Common::Rect &rect);
+
+	void clear();
+
+private:
+	struct Entry {
+		Key key;
+		Graphics::Surface *before;
+		Graphics::Surface after;
+		uint32 bytes;
+		Entry *nextSameKey;                    ///< Next entry in the chain of _index
+		Common::List<Entry *>::iterator lruPos; ///< Position in _entries
+	};
+
+	typedef Common::HashMap<Key, Entry *, KeyHash> EntryMap;
+
+	void removeEntry(Entry *entry);
+
+	/** First entry with each key */
+	EntryMap _index;
+	/** Most recently used entries first */
+	Common::List<Entry *> _entries;
+	uint32 _usedBytes;
+	uint32 _maxBytes;
+};
+
+/** Memory used at most by the DrawData cache */
+static const uint32 kDrawDataCacheSize = 4 * 1024 * 1024;
+
 class ThemeItem {
 
 public:
@@ -233,11 +336,8 @@ void ThemeItemDrawData::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step)
-			_engine->renderer()->drawStep(_area, *step, _dynamicData);
-	}
+	if (draw)
+		_engine->drawDD(_data, _area, _dynamicData, extendedRect);
 
 	_engine->addDirtyRect(extendedRect);
 }
@@ -285,6 +385,8 @@ ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
 
 	_useCursor = false;
 
+	_drawCache = new DrawDataCache(kDrawDataCacheSize);
+
 	for (int i = 0; i < kDrawDataMAX; ++i) {
 		_widgets[i] = 0;
 	}
@@ -322,6 +424,7 @@ ThemeEngine::~ThemeEngine() {
 	_backBuffer.free();
 
 	unloadTheme();
+	delete _drawCache;
 
 	// Release all graphics surfaces
 	for (ImagesMap::iterator i = _bitmaps.begin(); i != _bitmaps.end(); ++i) {
@@ -524,6 +627,9 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
 
+	// The cached items were drawn for the old surfaces and renderer
+	_drawCache->clear();
+
 	// Since we reinitialized our screen surfaces we know nothing has been
 	// drawn so far. Sometimes we still end up with dirty screen bits in the
 	// list. Clearing it avoids invalid overlay writes when the backend
@@ -545,6 +651,215 @@ void WidgetDrawData::calcBackgroundOffset() {
 	_backgroundOffset = maxShadow;
 }
 
+void WidgetDrawData::calcCacheInfo() {
+	_cacheable = !_steps.empty();
+	_opaque = false;
+	_inheritedColors = (1 << Graphics::VectorRenderer::kColorCount) - 1;
+	if (!_cacheable)
+		return;
+
+	// Colors not set by the first step may be taken over from earlier drawing
+	const Graphics::DrawStep &first = _steps.front();
+	if (first.fgColor.set)
+		_inheritedColors &= ~(1 << 0);
+	if (first.bgColor.set)
+		_inheritedColors &= ~(1 << 1);
+	if (first.bevelColor.set)
+		_inheritedColors &= ~(1 << 2);
+	if (first.gradColor1.set && first.gradColor2.set)
+		_inheritedColors &= ~((1 << 3) | (1 << 4));
+
+	_opaque = first.drawingCall == &Graphics::VectorRenderer::drawCallback_FILLSURFACE &&
+	          first.fillMode != Graphics::VectorRenderer::kFillDisabled;
+
+	for (Common::List<Graphics::DrawStep>::const_iterator step = _steps.begin();
+	        step != _steps.end(); ++step) {
+		// Tabs draw their base line outside of their area, as far as the
+		// dynamic data says
+		if (step->drawingCall == &Graphics::VectorRenderer::drawCallback_TAB)
+			_cacheable = false;
+	}
+}
+
+bool DrawDataCache::Key::operator==(const Key &k) const {
+	return data == k.data && dynamic == k.dynamic &&
+	       width == k.width && height == k.height &&
+	       rect == k.rect && parity == k.parity && shadows == k.shadows &&
+	       !memcmp(colors, k.colors, sizeof(colors));
+}
+
+static bool sameRect(const Graphics::Surface &surf, const Graphics::Surface &target, const Common::Rect &rect) {
+	const int bytes = rect.width() * target.format.bytesPerPixel;
+	for (int y = 0; y < rect.height(); ++y) {
+		if (memcmp(surf.getBasePtr(0, y), target.getBasePtr(rect.left, rect.top + y), bytes))
+			return false;
+	}
+	return true;
+}
+
+uint DrawDataCache::KeyHash::operator()(const Key &k) const {
+	uint hash = (uint)(size_t)k.data;
+	hash = hash * 31 + k.dynamic;
+	hash = hash * 31 + (uint16)k.width;
+	hash = hash * 31 + (uint16)k.height;
+	hash = hash * 31 + (uint16)k.rect.left;
+	hash = hash * 31 + (uint16)k.rect.top;
+	hash = hash * 31 + (uint16)k.rect.right;
+	hash = hash * 31 + (uint16)k.rect.bottom;
+	hash = hash * 31 + k.parity + (k.shadows ? 4 : 0);
+	for (int i = 0; i < Graphics::VectorRenderer::kColorCount; ++i)
+		hash = hash * 31 + k.colors[i];
+	return hash;
+}
+
+bool DrawDataCache::draw(const Key &key, Graphics::Surface *target, const Common::Rect &rect) {
+	for (Entry *entry = _index.getVal(key, 0); entry; entry = entry->nextSameKey) {
+		if (entry->after.format != target->format)
+			continue;
+		if (entry->before && !sameRect(*entry->before, *target, rect))
+			continue;
+
+		target->copyRectToSurface(entry->after, rect.left, rect.top, Common::Rect(rect.width(), rect.height()));
+
+		if (entry->lruPos != _entries.begin()) {
+			_entries.erase(entry->lruPos);
+			_entries.push_front(entry);
+			entry->lruPos = _entries.begin();
+		}
+		return true;
+	}
+	return false;
+}
+
+void DrawDataCache::add(const Key &key, Graphics::Surface *before, const Graphics::Surface &target, const Common::Rect &rect) {
+	uint32 bytes = rect.width() * rect.height() * target.format.bytesPerPixel;
+	if (before)
+		bytes *= 2;
+
+	if (bytes > _maxBytes) {
+		if (before) {
+			before->free();
+			delete before;
+		}
+		return;
+	}
+
+	while (_usedBytes + bytes > _maxBytes)
+		removeEntry(_entries.back());
+
+	Entry *entry = new Entry();
+	entry->key = key;
+	entry->before = before;
+	entry->after.create(rect.width(), rect.height(), target.format);
+	entry->after.copyRectToSurface(target, 0, 0, rect);
+	entry->bytes = bytes;
+	entry->nextSameKey = _index.getVal(key, 0);
+	_index.setVal(key, entry);
+	_entries.push_front(entry);
+	entry->lruPos = _entries.begin();
+	_usedBytes += bytes;
+}
+
+void DrawDataCache::clear() {
+	while (!_entries.empty())
+		removeEntry(_entries.front());
+}
+
+void DrawDataCache::removeEntry(Entry *entry) {
+	// Unlink the entry from the chain of entries with its key
+	EntryMap::iterator head = _index.find(entry->key);
+	assert(head != _index.end());
+	if (head->_value == entry) {
+		if (entry->nextSameKey)
+			head->_value = entry->nextSameKey;
+		else
+			_index.erase(head);
+	} else {
+		Entry *prev = head->_value;
+		while (prev->nextSameKey != entry)
+			prev = prev->nextSameKey;
+		prev->nextSameKey = entry->nextSameKey;
+	}
+
+	_entries.erase(entry->lruPos);
+	if (entry->before) {
+		entry->before->free();
+		delete entry->before;
+	}
+	entry->after.free();
+	_usedBytes -= entry->bytes;
+	delete entry;
+}
+
+void ThemeEngine::drawDD(const WidgetDrawData *data, const Common::Rect &area, uint32 dynamic, const Common::Rect &extendedRect) {
+	Graphics::Surface *target = _vectorRenderer->getActiveSurface();
+	bool cacheable = data->_cacheable;
+
+	// The cached pixels have to cover everything the steps draw to. Shapes
+	// may be offset by their padding, circles and lines may be larger than
+	// their size says, and shadows reach a bit further than their offset.
+	Common::Rect rect(extendedRect);
+	Common::List<Graphics::DrawStep>::const_iterator step;
+	for (step = data->_steps.begin(); step != data->_steps.end() && cacheable; ++step) {
+		if (step->drawingCall == &Graphics::VectorRenderer::drawCallback_FILLSURFACE) {
+			rect = Common::Rect(target->w, target->h);
+			continue;
+		}
+
+		uint16 x, y, w, h;
+		_vectorRenderer->stepGetPositions(*step, area, x, y, w, h);
+		if (step->drawingCall == &Graphics::VectorRenderer::drawCallback_CIRCLE)
+			w = h = 2 * _vectorRenderer->stepGetRadius(*step, area) + 1;
+		else if (step->drawingCall == &Graphics::VectorRenderer::drawCallback_LINE)
+			w = h = w + 1;
+
+		Common::Rect box(x, y, x + w, y + h);
+		box.grow(MAX<int>(step->shadow ? step->shadow + 2 : 0, step->bevel));
+		rect.extend(box);
+	}
+
+	rect.clip(target->w, target->h);
+	if (rect.isEmpty())
+		cacheable = false;
+
+	DrawDataCache::Key key;
+	Graphics::Surface *before = 0;
+	if (cacheable) {
+		key.data = data;
+		key.dynamic = dynamic;
+		key.width = area.width();
+		key.height = area.height();
+		key.rect = rect;
+		key.rect.translate(-area.left, -area.top);
+		key.parity = (area.left & 1) | ((area.top & 1) << 1);
+		key.shadows = _vectorRenderer->shadowsEnabled();
+		_vectorRenderer->getColors(key.colors);
+		for (int i = 0; i < Graphics::VectorRenderer::kColorCount; ++i) {
+			if (!(data->_inheritedColors & (1 << i)))
+				key.colors[i] = 0;
+		}
+
+		if (_drawCache->draw(key, target, rect)) {
+			// Leave the renderer colors as drawing the item would have
+			for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+				_vectorRenderer->setStepColors(*step);
+			return;
+		}
+
+		if (!data->_opaque) {
+			before = new Graphics::Surface();
+			before->create(rect.width(), rect.height(), target->format);
+			before->copyRectToSurface(*target, 0, 0, rect);
+		}
+	}
+
+	for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+		_vectorRenderer->drawStep(area, *step, dynamic);
+
+	if (cacheable)
+		_drawCache->add(key, before, *target, rect);
+}
+
 void ThemeEngine::restoreBackground(Common::Rect r) {
 	r.clip(_screen.w, _screen.h);
 	_vectorRenderer->blitSurface(&_backBuffer, r);
@@ -705,6 +1020,7 @@ void ThemeEngine::loadTheme(const Common::String &themeId) {
 			warning("Missing data asset: '%s'", kDrawDataDefaults[i].name);
 		} else {
 			_widgets[i]->calcBackgroundOffset();
+			_widgets[i]->calcCacheInfo();
 		}
 	}
 }
@@ -713,6 +1029,8 @@ void ThemeEngine::unloadTheme() {
 	if (!_themeOk)
 		return;
 
+	_drawCache->clear();
+
 	for (int i = 0; i < kDrawDataMAX; ++i) {
 		delete _widgets[i];
 		_widgets[i] = 0;
@@ -1578,7 +1896,14 @@ bool ThemeEngine::themeConfigUsable(const Common::ArchiveMember &member, Common:
 		Common::Archive *zipArchive = Common::makeZipArchive(member.createReadStream());
 
 		if (zipArchive && zipArchive->hasFile("THEMERC")) {
+			// The member stream reads from the archive, so the header has
+			// to be parsed before the archive is deleted.
 			stream.open("THEMERC", *zipArchive);
+			if (stream.isOpen()) {
+				Common::String stxHeader = stream.readLine();
+				foundHeader = themeConfigParseHeader(stxHeader, themeName);
+				stream.close();
+			}
 		}
 
 		delete zipArchive;
@@ -1599,15 +1924,15 @@ bool ThemeEngine::themeConfigUsable(const Common::FSNode &node, Common::String &
 	if (node.getName().matchString("*.zip", true) && !node.isDirectory()) {
 		Common::Archive *zipArchive = Common::makeZipArchive(node);
 		if (zipArchive && zipArchive->hasFile("THEMERC")) {
-			// Open THEMERC from the ZIP file.
+			// Open THEMERC from the ZIP file and parse it while the
+			// archive, which the member stream reads from, is still alive.
 			stream.open("THEMERC", *zipArchive);
+			if (stream.isOpen()) {
+				Common::String stxHeader = stream.readLine();
+				foundHeader = themeConfigParseHeader(stxHeader, themeName);
+				stream.close();
+			}
 		}
-		// Delete the ZIP archive again. Note: This only works because
-		// stream.open() only uses ZipArchive::createReadStreamForMember,
-		// and that in turn happens to read all the data for a given
-		// archive member into a memory block. So there will be no dangling
-		// reference to zipArchive anywhere. This could change if we
-		// ever modify ZipArchive::createReadStreamForMember.
 		delete zipArchive;
 	} else if (node.isDirectory()) {
 		Common::FSNode headerfile = node.getChild("THEMERC");
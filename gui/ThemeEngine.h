@@ -48,6 +48,7 @@ class VectorRenderer;
 namespace GUI {
 
 struct WidgetDrawData;
+class DrawDataCache;
 struct TextDrawData;
 struct TextColorData;
 class Dialog;
@@ -523,6 +524,18 @@ public:
 	 */
 	void restoreBackground(Common::Rect r);
 
+	/**
+	 * Draws the steps of a DrawData item on the active surface of the
+	 * renderer, reusing the result of an earlier identical drawing when
+	 * possible.
+	 *
+	 * @param data Item to draw.
+	 * @param area Area of the widget.
+	 * @param dynamic Dynamic data passed to the draw steps.
+	 * @param extendedRect Area the item may draw to, including shadows.
+	 */
+	void drawDD(const WidgetDrawData *data, const Common::Rect &area, uint32 dynamic, const Common::Rect &extendedRect);
+
 	const Common::String &getThemeName() const { return _themeName; }
 	const Common::String &getThemeId() const { return _themeId; }
 	int getGraphicsMode() const { return _graphicsMode; }
@@ -652,6 +665,9 @@ protected:
 	 */
 	WidgetDrawData *_widgets[kDrawDataMAX];
 
+	/** Rendered DrawData items, to save drawing them again */
+	DrawDataCache *_drawCache;
+
 	/** Array of all the text fonts that can be drawn. */
 	TextDrawData *_texts[kTextDataMAX];
 
@@ -0,0 +1,316 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "audio/rate_mix.h"
+#include "audio/decoders/raw.h"
+
+#include "common/frac.h"
+#include "common/memstream.h"
+
+class RateTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	int16 random16() {
+		_seed = _seed * 1103515245 + 12345;
+		return (int16)(_seed >> 16);
+	}
+
+	static int16 *createBuffer(uint size) {
+		return (int16 *)malloc(size * sizeof(int16));
+	}
+
+	void fillRandom(int16 *buffer, uint size) {
+		for (uint i = 0; i < size; ++i)
+			buffer[i] = random16();
+
+		// Make sure the extremes are covered
+		if (size >= 2) {
+			buffer[0] = -32768;
+			buffer[1] = 32767;
+		}
+	}
+
+	/**
+	 * Check all kernel sets usable on this CPU against the reference one.
+	 */
+	void checkKernels(Audio::RateMixProc Audio::RateMixKernels::*proc, bool stereo) {
+		static const Audio::st_volume_t volumes[] = { 0, 1, 77, 128, 255, 256 };
+		const Audio::RateMixKernels &reference = Audio::getRateMixKernels(0);
+
+		for (uint k = 1; k < Audio::getRateMixKernelsCount(); ++k) {
+			const Audio::RateMixKernels &kernels = Audio::getRateMixKernels(k);
+
+			for (uint frames = 0; frames < 70; frames += (frames < 40 ? 1 : 13)) {
+				for (uint v = 0; v < ARRAYSIZE(volumes); ++v) {
+					const uint numSamples = frames * (stereo ? 2 : 1);
+					int16 *samples = createBuffer(numSamples + 1);
+					int16 *expected = createBuffer(frames * 2 + 1);
+					int16 *output = createBuffer(frames * 2 + 1);
+
+					fillRandom(samples, numSamples);
+					fillRandom(expected, frames * 2);
+					memcpy(output, expected, frames * 2 * sizeof(int16));
+
+					const Audio::st_volume_t vol_l = volumes[v];
+					const Audio::st_volume_t vol_r = volumes[ARRAYSIZE(volumes) - 1 - v];
+					(reference.*proc)(expected, samples, frames, vol_l, vol_r);
+					(kernels.*proc)(output, samples, frames, vol_l, vol_r);
+
+					TSM_ASSERT_EQUALS(kernels.name, memcmp(expected, output, frames * 2 * sizeof(int16)), 0);
+
+					free(samples);
+					free(expected);
+					free(output);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Run a constant signal through the sinc rate converter. Since each
+	 * filter has unity gain, the signal has to come out unchanged once the
+	 * filter window is filled.
+	 */
+	void checkSincConstant(bool stereo, Audio::st_rate_t inRate, Audio::st_rate_t outRate) {
+		const uint inFrames = 4000;
+		const uint numSamples = inFrames * (stereo ? 2 : 1);
+		const uint outFrames = inFrames * outRate / inRate;
+		const uint latency = 64 * outRate / inRate + 1;
+		const int16 values[2] = { 10000, -20000 };
+
+		int16 *data = createBuffer(numSamples);
+		for (uint i = 0; i < numSamples; ++i)
+			data[i] = values[stereo ? (i & 1) : 0];
+
+		int16 *output = createBuffer(outFrames * 2);
+		memset(output, 0, outFrames * 2 * sizeof(int16));
+
+		Audio::AudioStream *stream = Audio::makeRawStream((byte *)data, numSamples * sizeof(int16), inRate,
+		                                                  Audio::FLAG_16BITS
+#ifdef SCUMM_LITTLE_ENDIAN
+		                                                  | Audio::FLAG_LITTLE_ENDIAN
+#endif
+		                                                  | (stereo ? Audio::FLAG_STEREO : 0));
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, false, true);
+
+		uint frames = 0;
+		for (uint chunk = 1; frames < outFrames; chunk = chunk * 3 % 1021) {
+			const int result = converter->flow(*stream, output + frames * 2, MIN(chunk, outFrames - frames), 256, 256);
+			frames += result;
+			if (result == 0 && stream->endOfData())
+				break;
+		}
+
+		TS_ASSERT_LESS_THAN(latency, frames);
+		for (uint i = latency; i < frames; ++i) {
+			TS_ASSERT_EQUALS(output[i * 2 + 0], values[0]);
+			TS_ASSERT_EQUALS(output[i * 2 + 1], values[stereo ? 1 : 0]);
+		}
+
+		delete converter;
+		delete stream;
+		free(output);
+	}
+
+	/**
+	 * Scalar reference of the linear interpolating rate converter.
+	 */
+	static uint convertLinear(const int16 *in, uint inFrames, int16 *out, uint outFrames, bool stereo, Audio::st_rate_t inRate, Audio::st_rate_t outRate, Audio::st_volume_t vol_l, Audio::st_volume_t vol_r) {
+		frac_t opos = FRAC_ONE;
+		const frac_t opos_inc = (inRate << FRAC_BITS) / outRate;
+		int16 ilast0 = 0, ilast1 = 0, icur0 = 0, icur1 = 0;
+		uint frames = 0;
+
+		while (frames < outFrames) {
+			while ((frac_t)FRAC_ONE <= opos) {
+				if (!inFrames)
+					return frames;
+				inFrames--;
+				ilast0 = icur0;
+				icur0 = *in++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *in++;
+				}
+				opos -= FRAC_ONE;
+			}
+
+			while (opos < (frac_t)FRAC_ONE && frames < outFrames) {
+				const int16 out0 = (int16)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF) >> FRAC_BITS));
+				const int16 out1 = stereo ? (int16)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF) >> FRAC_BITS)) : out0;
+				Audio::clampedAdd(out[0], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+				Audio::clampedAdd(out[1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+				out += 2;
+				frames++;
+				opos += opos_inc;
+			}
+		}
+
+		return frames;
+	}
+
+	/**
+	 * Scalar reference of the copying rate converter.
+	 */
+	static uint convertCopy(const int16 *in, uint inFrames, int16 *out, uint outFrames, bool stereo, Audio::st_volume_t vol_l, Audio::st_volume_t vol_r) {
+		const uint frames = MIN(inFrames, outFrames);
+
+		for (uint i = 0; i < frames; ++i) {
+			const int16 out0 = *in++;
+			const int16 out1 = stereo ? *in++ : out0;
+			Audio::clampedAdd(out[0], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			Audio::clampedAdd(out[1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			out += 2;
+		}
+
+		return frames;
+	}
+
+	/**
+	 * Run a stream through a rate converter in chunks of varying size and
+	 * compare the result to the reference.
+	 */
+	void checkConverter(bool stereo, Audio::st_rate_t inRate, Audio::st_rate_t outRate) {
+		const uint inFrames = 3001;
+		const uint numSamples = inFrames * (stereo ? 2 : 1);
+		const uint outFrames = inFrames * outRate / inRate + 16;
+		const Audio::st_volume_t vol_l = 200, vol_r = 256;
+
+		int16 *in = createBuffer(numSamples);
+		fillRandom(in, numSamples);
+
+		int16 *expected = createBuffer(outFrames * 2);
+		int16 *output = createBuffer(outFrames * 2);
+		fillRandom(expected, outFrames * 2);
+		memcpy(output, expected, outFrames * 2 * sizeof(int16));
+
+		uint expectedFrames;
+		if (inRate == outRate)
+			expectedFrames = convertCopy(in, inFrames, expected, outFrames, stereo, vol_l, vol_r);
+		else
+			expectedFrames = convertLinear(in, inFrames, expected, outFrames, stereo, inRate, outRate, vol_l, vol_r);
+
+		int16 *data = createBuffer(numSamples);
+		memcpy(data, in, numSamples * sizeof(int16));
+		Audio::AudioStream *stream = Audio::makeRawStream((byte *)data, numSamples * sizeof(int16), inRate,
+		                                                  Audio::FLAG_16BITS
+#ifdef SCUMM_LITTLE_ENDIAN
+		                                                  | Audio::FLAG_LITTLE_ENDIAN
+#endif
+		                                                  | (stereo ? Audio::FLAG_STEREO : 0));
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo);
+
+		uint frames = 0;
+		for (uint chunk = 1; frames < outFrames; chunk = chunk * 3 % 1021) {
+			const uint request = MIN(chunk, outFrames - frames);
+			const int result = converter->flow(*stream, output + frames * 2, request, vol_l, vol_r);
+			frames += result;
+			if (result == 0 && stream->endOfData())
+				break;
+		}
+
+		TS_ASSERT_EQUALS(frames, expectedFrames);
+		TS_ASSERT_EQUALS(memcmp(expected, output, outFrames * 2 * sizeof(int16)), 0);
+
+		delete converter;
+		delete stream;
+		free(in);
+		free(expected);
+		free(output);
+	}
+
+public:
+	void setUp() {
+		_seed = 0x1234;
+	}
+
+	void test_kernels_stereo() {
+		checkKernels(&Audio::RateMixKernels::mixStereo, true);
+	}
+
+	void test_kernels_stereo_reversed() {
+		checkKernels(&Audio::RateMixKernels::mixStereoReversed, true);
+	}
+
+	void test_kernels_mono() {
+		checkKernels(&Audio::RateMixKernels::mixMono, false);
+	}
+
+	void test_kernels_filter() {
+		static const frac_t increments[] = { FRAC_ONE / 5, (11025 << FRAC_BITS) / 44100, (22050 << FRAC_BITS) / 32000, FRAC_ONE * 2 };
+		const Audio::RateMixKernels &reference = Audio::getRateMixKernels(0);
+
+		for (uint k = 1; k < Audio::getRateMixKernelsCount(); ++k) {
+			const Audio::RateMixKernels &kernels = Audio::getRateMixKernels(k);
+
+			for (uint numTaps = 8; numTaps <= 64; numTaps *= 2) {
+				const uint numCoeffs = ((1 << Audio::kRateFilterPhaseBits) + 1) * numTaps;
+				int16 *coeffs = createBuffer(numCoeffs);
+				int16 *left = createBuffer(numTaps);
+				int16 *right = createBuffer(numTaps);
+				const int16 *const windows[2] = { left, right };
+
+				// Keep the dot products within 32 bits
+				for (uint i = 0; i < numCoeffs; ++i)
+					coeffs[i] = random16() / 64;
+				fillRandom(left, numTaps);
+				fillRandom(right, numTaps);
+
+				for (uint i = 0; i < ARRAYSIZE(increments); ++i) {
+					for (uint maxFrames = 1; maxFrames <= 7; maxFrames += 3) {
+						const frac_t start = (uint16)random16() << (FRAC_BITS - 16);
+						int16 expected[14], output[14];
+						frac_t expectedPos = start, outputPos = start;
+
+						uint expectedFrames = (reference.filterMono)(expected, windows, coeffs, numTaps, expectedPos, increments[i], maxFrames);
+						uint outputFrames = (kernels.filterMono)(output, windows, coeffs, numTaps, outputPos, increments[i], maxFrames);
+						TSM_ASSERT_EQUALS(kernels.name, outputFrames, expectedFrames);
+						TSM_ASSERT_EQUALS(kernels.name, outputPos, expectedPos);
+						TSM_ASSERT_EQUALS(kernels.name, memcmp(output, expected, expectedFrames * sizeof(int16)), 0);
+
+						expectedPos = outputPos = start;
+						expectedFrames = (reference.filterStereo)(expected, windows, coeffs, numTaps, expectedPos, increments[i], maxFrames);
+						outputFrames = (kernels.filterStereo)(output, windows, coeffs, numTaps, outputPos, increments[i], maxFrames);
+						TSM_ASSERT_EQUALS(kernels.name, outputFrames, expectedFrames);
+						TSM_ASSERT_EQUALS(kernels.name, outputPos, expectedPos);
+						TSM_ASSERT_EQUALS(kernels.name, memcmp(output, expected, expectedFrames * 2 * sizeof(int16)), 0);
+					}
+				}
+
+				free(coeffs);
+				free(left);
+				free(right);
+			}
+		}
+	}
+
+	void test_copy_mono() {
+		checkConverter(false, 22050, 22050);
+	}
+
+	void test_copy_stereo() {
+		checkConverter(true, 22050, 22050);
+	}
+
+	void test_linear_mono() {
+		checkConverter(false, 11025, 22050);
+	}
+
+	void test_linear_stereo() {
+		checkConverter(true, 22050, 44100);
+	}
+
+	void test_sinc_upsampling() {
+		checkSincConstant(false, 11025, 44100);
+		checkSincConstant(true, 22050, 48000);
+	}
+
+	void test_sinc_downsampling() {
+		checkSincConstant(false, 48000, 44100);
+		checkSincConstant(true, 44100, 11025);
+	}
+};
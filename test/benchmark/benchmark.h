@@ -0,0 +1,104 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef TEST_BENCHMARK_BENCHMARK_H
+#define TEST_BENCHMARK_BENCHMARK_H
+
+#include "common/scummsys.h"
+
+namespace Audio {
+class AudioStream;
+}
+
+namespace Benchmark {
+
+/**
+ * Returns the processor time used so far, in microseconds.
+ */
+uint64 getMicroseconds();
+
+/**
+ * Returns the number of memory allocations done through operator new so far.
+ */
+uint64 getAllocationCount();
+
+/**
+ * Returns the directory given with --data on the command line, which holds
+ * the reference files for the decoder benchmarks. Empty if none was given.
+ */
+const char *getDataPath();
+
+/**
+ * Installs a headless OSystem, as needed by the mixer.
+ */
+void initSystem();
+void deinitSystem();
+
+/**
+ * Creates an endless stream of noise at the given rate.
+ */
+Audio::AudioStream *makeNoiseStream(uint rate, bool stereo);
+
+/**
+ * Measures a single benchmark run.
+ */
+class Measurement {
+public:
+	Measurement() : _micros(getMicroseconds()), _allocations(getAllocationCount()) {}
+
+	/**
+	 * Prints the result of the run.
+	 *
+	 * @param group   the benchmark group, e.g. "rate"
+	 * @param name    description of the run
+	 * @param samples number of samples processed
+	 */
+	void print(const char *group, const char *name, uint64 samples) const;
+
+private:
+	const uint64 _micros;
+	const uint64 _allocations;
+};
+
+/**
+ * Measures the throughput of the rate converters.
+ */
+void runRateBenchmarks();
+
+/**
+ * Measures the throughput of the mixer with many playing channels.
+ */
+void runMixerBenchmarks();
+
+/**
+ * Measures the throughput of the audio decoders.
+ */
+void runDecoderBenchmarks();
+
+/**
+ * Measures the throughput of the TransparentSurface blit kernels.
+ */
+void runBlitBenchmarks();
+
+} // End of namespace Benchmark
+
+#endif
@@ -0,0 +1,105 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "test/benchmark/benchmark.h"
+
+#include "graphics/transparent_surface.h"
+
+#include "common/str.h"
+#include "common/util.h"
+
+namespace Benchmark {
+
+enum {
+	/** Size of the target, a typical Wintermute screen. */
+	kBlitTargetWidth = 800,
+	kBlitTargetHeight = 600,
+
+	/** Size of the sprites blitted onto it. */
+	kBlitSpriteWidth = 160,
+	kBlitSpriteHeight = 120,
+
+	/** Number of pixels blitted by each run. */
+	kBlitPixels = 100000000
+};
+
+/**
+ * Creates a sprite with smooth alpha edges, an opaque center and some
+ * fully transparent pixels, like a typical anti-aliased sprite.
+ */
+static void createSprite(Graphics::TransparentSurface &sprite, const Graphics::PixelFormat &format) {
+	sprite.create(kBlitSpriteWidth, kBlitSpriteHeight, format);
+
+	uint32 seed = 0x1234;
+	for (int y = 0; y < kBlitSpriteHeight; ++y) {
+		for (int x = 0; x < kBlitSpriteWidth; ++x) {
+			seed = seed * 1103515245 + 12345;
+			const int edge = MIN(MIN(x, kBlitSpriteWidth - 1 - x), MIN(y, kBlitSpriteHeight - 1 - y));
+			const int alpha = (edge < 4) ? 0 : MIN(255, (edge - 4) * 32);
+			*(uint32 *)sprite.getBasePtr(x, y) = format.ARGBToColor(alpha, seed >> 24, seed >> 16, seed >> 8);
+		}
+	}
+}
+
+static void benchmarkBlit(const Graphics::TransparentBlitKernels &kernels, const char *mode,
+                          Graphics::TransparentBlitRowProc proc, uint32 color, int32 inStep) {
+	const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+	Graphics::TransparentSurface sprite;
+	createSprite(sprite, format);
+	Graphics::Surface target;
+	target.create(kBlitTargetWidth, kBlitTargetHeight, format);
+
+	const Measurement measurement;
+	uint64 pixels = 0;
+	int pos = 0;
+	while (pixels < kBlitPixels) {
+		// Spread the sprites over the target, so that it does not fit in the cache
+		const int x = (pos * 97) % (kBlitTargetWidth - kBlitSpriteWidth);
+		const int y = (pos * 61) % (kBlitTargetHeight - kBlitSpriteHeight);
+		++pos;
+
+		for (int row = 0; row < kBlitSpriteHeight; ++row) {
+			const byte *in = (const byte *)sprite.getBasePtr(inStep > 0 ? 0 : kBlitSpriteWidth - 1, row);
+			proc(in, inStep, (byte *)target.getBasePtr(x, y + row), kBlitSpriteWidth, color);
+		}
+		pixels += kBlitSpriteWidth * kBlitSpriteHeight;
+	}
+
+	const Common::String name = Common::String::format("%s %s%s", kernels.name, mode, inStep > 0 ? "" : " flipped");
+	measurement.print("blit", name.c_str(), pixels);
+
+	target.free();
+	sprite.free();
+}
+
+void runBlitBenchmarks() {
+	for (uint i = 0; i < Graphics::getTransparentBlitKernelsCount(); ++i) {
+		const Graphics::TransparentBlitKernels &kernels = Graphics::getTransparentBlitKernels(i);
+
+		benchmarkBlit(kernels, "opaque", kernels.opaque, 0xFFFFFFFF, 4);
+		benchmarkBlit(kernels, "binary", kernels.binary, 0xFFFFFFFF, 4);
+		benchmarkBlit(kernels, "alpha", kernels.alphaBlend, 0xFFFFFFFF, 4);
+		benchmarkBlit(kernels, "alpha", kernels.alphaBlend, 0xFFFFFFFF, -4);
+		benchmarkBlit(kernels, "alpha color", kernels.alphaBlendColor, 0xC0FF8040, 4);
+	}
+}
+
+} // End of namespace Benchmark
@@ -0,0 +1,196 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// The reference files are read with the C library, since the benchmarks have
+// no filesystem backend.
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "test/benchmark/benchmark.h"
+
+#include "audio/audiostream.h"
+#include "audio/decoders/adpcm.h"
+#include "audio/decoders/flac.h"
+#include "audio/decoders/mp3.h"
+#include "audio/decoders/vorbis.h"
+
+#include "common/memstream.h"
+#include "common/str.h"
+#include "common/util.h"
+
+#include <stdio.h>
+
+namespace Benchmark {
+
+enum {
+	/** Minimum number of samples decoded by each run. */
+	kDecoderSamples = 4000000,
+
+	/** Number of samples requested per call. */
+	kDecoderChunkSamples = 4096,
+
+	kADPCMRate = 22050,
+	kADPCMSize = 256 * 1024,
+	kADPCMBlockAlign = 1024
+};
+
+typedef Audio::RewindableAudioStream *(*DecoderProc)(Common::SeekableReadStream *stream, const void *param);
+
+/**
+ * Decodes the given data over and over again, until enough samples are
+ * produced.
+ */
+static void benchmarkDecoder(const char *name, const byte *data, uint32 size, DecoderProc makeStream, const void *param) {
+	int16 *buffer = new int16[kDecoderChunkSamples];
+
+	const Measurement measurement;
+	uint64 samples = 0;
+	while (samples < kDecoderSamples) {
+		Audio::RewindableAudioStream *stream = makeStream(new Common::MemoryReadStream(data, size), param);
+		if (!stream) {
+			printf("%-8s %-40s failed to decode\n", "decoder", name);
+			break;
+		}
+
+		int result;
+		while ((result = stream->readBuffer(buffer, kDecoderChunkSamples)) > 0)
+			samples += result;
+		delete stream;
+
+		// Protect against looping forever on empty streams
+		if (!samples)
+			break;
+	}
+
+	if (samples)
+		measurement.print("decoder", name, samples);
+	delete[] buffer;
+}
+
+static Audio::RewindableAudioStream *makeADPCMStream(Common::SeekableReadStream *stream, const void *param) {
+	const Audio::ADPCMType type = *(const Audio::ADPCMType *)param;
+	return Audio::makeADPCMStream(stream, DisposeAfterUse::YES, 0, type, kADPCMRate, 1, kADPCMBlockAlign);
+}
+
+/**
+ * Benchmark the ADPCM decoders on random data, which is valid input for
+ * them once the block headers are fixed up.
+ */
+static void benchmarkADPCM() {
+	static const struct {
+		const char *name;
+		Audio::ADPCMType type;
+	} types[] = {
+		{ "adpcm oki", Audio::kADPCMOki },
+		{ "adpcm ms ima", Audio::kADPCMMSIma },
+		{ "adpcm ms", Audio::kADPCMMS },
+		{ "adpcm dvi", Audio::kADPCMDVI }
+	};
+
+	byte *data = new byte[kADPCMSize];
+	uint32 seed = 0x1234;
+
+	for (uint i = 0; i < ARRAYSIZE(types); ++i) {
+		for (uint j = 0; j < kADPCMSize; ++j) {
+			seed = seed * 1103515245 + 12345;
+			data[j] = (byte)(seed >> 16);
+		}
+
+		// MS IMA ADPCM blocks start with a step index, which is not checked
+		// by the decoder
+		if (types[i].type == Audio::kADPCMMSIma) {
+			for (uint j = 0; j < kADPCMSize; j += kADPCMBlockAlign) {
+				data[j + 2] %= 89;
+				data[j + 3] = 0;
+			}
+		}
+
+		benchmarkDecoder(types[i].name, data, kADPCMSize, &makeADPCMStream, &types[i].type);
+	}
+
+	delete[] data;
+}
+
+typedef Audio::SeekableAudioStream *(*CompressedDecoderProc)(Common::SeekableReadStream *stream, DisposeAfterUse::Flag disposeAfterUse);
+
+static Audio::RewindableAudioStream *makeCompressedStream(Common::SeekableReadStream *stream, const void *param) {
+	const CompressedDecoderProc makeStream = *(const CompressedDecoderProc *)param;
+	return makeStream(stream, DisposeAfterUse::YES);
+}
+
+/**
+ * Benchmark a decoder on a reference file from the data directory.
+ */
+static void benchmarkCompressed(const char *name, const char *filename, CompressedDecoderProc makeStream) {
+	if (!makeStream) {
+		printf("%-8s %-40s skipped, decoder not compiled in\n", "decoder", name);
+		return;
+	}
+
+	if (!*getDataPath()) {
+		printf("%-8s %-40s skipped, no --data directory given\n", "decoder", name);
+		return;
+	}
+
+	const Common::String path = Common::String::format("%s/%s", getDataPath(), filename);
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file) {
+		printf("%-8s %-40s skipped, cannot open %s\n", "decoder", name, path.c_str());
+		return;
+	}
+
+	fseek(file, 0, SEEK_END);
+	const long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	byte *data = new byte[MAX<long>(size, 1)];
+	if (size > 0 && fread(data, size, 1, file) == 1)
+		benchmarkDecoder(name, data, size, &makeCompressedStream, &makeStream);
+	else
+		printf("%-8s %-40s skipped, cannot read %s\n", "decoder", name, path.c_str());
+
+	delete[] data;
+	fclose(file);
+}
+
+void runDecoderBenchmarks() {
+	benchmarkADPCM();
+
+	CompressedDecoderProc makeStream = 0;
+#ifdef USE_MAD
+	makeStream = &Audio::makeMP3Stream;
+#endif
+	benchmarkCompressed("mp3", "reference.mp3", makeStream);
+
+	makeStream = 0;
+#ifdef USE_VORBIS
+	makeStream = &Audio::makeVorbisStream;
+#endif
+	benchmarkCompressed("vorbis", "reference.ogg", makeStream);
+
+	makeStream = 0;
+#ifdef USE_FLAC
+	makeStream = &Audio::makeFLACStream;
+#endif
+	benchmarkCompressed("flac", "reference.flac", makeStream);
+}
+
+} // End of namespace Benchmark
@@ -0,0 +1,135 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// The benchmarks are a standalone program which needs the C library for
+// timing, output and counting allocations.
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "test/benchmark/benchmark.h"
+
+#include "common/util.h"
+
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64 s_allocationCount = 0;
+
+void *operator new(size_t size) throw (std::bad_alloc) {
+	s_allocationCount++;
+	void *ptr = malloc(size ? size : 1);
+	if (!ptr)
+		abort();
+	return ptr;
+}
+
+void *operator new[](size_t size) throw (std::bad_alloc) {
+	return operator new(size);
+}
+
+void operator delete(void *ptr) throw () {
+	free(ptr);
+}
+
+void operator delete[](void *ptr) throw () {
+	free(ptr);
+}
+
+namespace Benchmark {
+
+static const char *s_dataPath = "";
+
+uint64 getMicroseconds() {
+	return (uint64)clock() * 1000000 / CLOCKS_PER_SEC;
+}
+
+uint64 getAllocationCount() {
+	return s_allocationCount;
+}
+
+const char *getDataPath() {
+	return s_dataPath;
+}
+
+void Measurement::print(const char *group, const char *name, uint64 samples) const {
+	const uint64 micros = getMicroseconds() - _micros;
+	const uint64 allocations = getAllocationCount() - _allocations;
+	const double seconds = MAX<uint64>(micros, 1) / 1000000.0;
+
+	printf("%-8s %-40s %10.3f ms %14.0f samples/s %10.0f allocs/s\n", group, name,
+	       micros / 1000.0, samples / seconds, allocations / seconds);
+	fflush(stdout);
+}
+
+struct Group {
+	const char *name;
+	void (*run)();
+};
+
+static const Group s_groups[] = {
+	{ "rate", &runRateBenchmarks },
+	{ "mixer", &runMixerBenchmarks },
+	{ "decoder", &runDecoderBenchmarks },
+	{ "blit", &runBlitBenchmarks }
+};
+
+} // End of namespace Benchmark
+
+/**
+ * Runs all benchmark groups, or only those named on the command line.
+ */
+int main(int argc, char *argv[]) {
+	bool selected[ARRAYSIZE(Benchmark::s_groups)];
+	bool selectAll = true;
+
+	memset(selected, 0, sizeof(selected));
+	for (int arg = 1; arg < argc; ++arg) {
+		if (!strncmp(argv[arg], "--data=", 7)) {
+			Benchmark::s_dataPath = argv[arg] + 7;
+			continue;
+		}
+
+		bool found = false;
+		for (uint i = 0; i < ARRAYSIZE(Benchmark::s_groups); ++i) {
+			if (!strcmp(argv[arg], Benchmark::s_groups[i].name))
+				selected[i] = found = true;
+		}
+
+		if (!found) {
+			fprintf(stderr, "Usage: %s [--data=DIR] [GROUP...]\n", argv[0]);
+			return 1;
+		}
+		selectAll = false;
+	}
+
+	Benchmark::initSystem();
+
+	for (uint i = 0; i < ARRAYSIZE(Benchmark::s_groups); ++i) {
+		if (selectAll || selected[i])
+			Benchmark::s_groups[i].run();
+	}
+
+	Benchmark::deinitSystem();
+	return 0;
+}
@@ -0,0 +1,98 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "test/benchmark/benchmark.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+
+#include "common/config-manager.h"
+#include "common/str.h"
+#include "common/system.h"
+#include "common/util.h"
+
+namespace Benchmark {
+
+enum {
+	kMixerOutputRate = 44100,
+
+	/** Number of channel frames mixed by each run. */
+	kMixerChannelFrames = 8000000,
+
+	/** Number of frames requested per callback, as done by most backends. */
+	kMixerCallbackFrames = 1024
+};
+
+static void benchmarkMixer(uint rate, bool stereo, uint numChannels, const char *resampler) {
+	ConfMan.set("resampler", resampler);
+
+	Audio::MixerImpl *mixer = new Audio::MixerImpl(g_system, kMixerOutputRate);
+	mixer->setReady(true);
+
+	// MixerImpl hides the default arguments of Mixer::playStream
+	Audio::Mixer *api = mixer;
+	for (uint i = 0; i < numChannels; ++i) {
+		Audio::SoundHandle handle;
+		api->playStream(Audio::Mixer::kSFXSoundType, &handle, makeNoiseStream(rate, stereo));
+	}
+
+	byte *buffer = new byte[kMixerCallbackFrames * 4];
+	const uint64 outputFrames = kMixerChannelFrames / numChannels;
+
+	const Measurement measurement;
+	uint64 frames = 0;
+	while (frames < outputFrames) {
+		mixer->mixCallback(buffer, kMixerCallbackFrames * 4);
+		frames += kMixerCallbackFrames;
+	}
+
+	const Common::String name = Common::String::format("%-6s %3d x %s %d", resampler, numChannels,
+	                                                   stereo ? "stereo" : "mono", rate);
+	measurement.print("mixer", name.c_str(), frames * numChannels);
+
+	delete[] buffer;
+	delete mixer;
+}
+
+void runMixerBenchmarks() {
+	static const struct {
+		uint rate;
+		bool stereo;
+	} formats[] = {
+		{ 11025, false },
+		{ 22050, true },
+		{ 44100, true }
+	};
+	static const uint channelCounts[] = { 1, 16, 64 };
+
+	for (uint i = 0; i < ARRAYSIZE(formats); ++i) {
+		for (uint j = 0; j < ARRAYSIZE(channelCounts); ++j)
+			benchmarkMixer(formats[i].rate, formats[i].stereo, channelCounts[j], "linear");
+
+		if (formats[i].rate != kMixerOutputRate)
+			benchmarkMixer(formats[i].rate, formats[i].stereo, 16, "sinc");
+	}
+
+	ConfMan.set("resampler", "linear");
+}
+
+} // End of namespace Benchmark
@@ -0,0 +1,96 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "test/benchmark/benchmark.h"
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+#include "audio/decoders/raw.h"
+
+#include "common/str.h"
+#include "common/util.h"
+
+namespace Benchmark {
+
+enum {
+	/** Number of output frames produced by each run. */
+	kRateOutputFrames = 2000000,
+
+	/** Number of frames requested per call, as done by the mixer. */
+	kRateChunkFrames = 1024
+};
+
+Audio::AudioStream *makeNoiseStream(uint rate, bool stereo) {
+	const uint numSamples = rate * (stereo ? 2 : 1);
+	int16 *data = (int16 *)malloc(numSamples * sizeof(int16));
+
+	uint32 seed = 0x1234;
+	for (uint i = 0; i < numSamples; ++i) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (int16)(seed >> 16) / 4;
+	}
+
+	Audio::RewindableAudioStream *stream = Audio::makeRawStream((byte *)data, numSamples * sizeof(int16), rate,
+	                                                            Audio::FLAG_16BITS
+#ifdef SCUMM_LITTLE_ENDIAN
+	                                                            | Audio::FLAG_LITTLE_ENDIAN
+#endif
+	                                                            | (stereo ? Audio::FLAG_STEREO : 0));
+	return Audio::makeLoopingAudioStream(stream, 0);
+}
+
+static void benchmarkConverter(Audio::st_rate_t inRate, Audio::st_rate_t outRate, bool stereo, bool highQuality) {
+	Audio::AudioStream *stream = makeNoiseStream(inRate, stereo);
+	Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, false, highQuality);
+	int16 *buffer = (int16 *)calloc(kRateChunkFrames * 2, sizeof(int16));
+
+	const Measurement measurement;
+	uint64 frames = 0;
+	while (frames < kRateOutputFrames)
+		frames += converter->flow(*stream, buffer, kRateChunkFrames, 128, 128);
+
+	const Common::String name = Common::String::format("%s %s %d -> %d", highQuality ? "sinc" : "linear",
+	                                                   stereo ? "stereo" : "mono", inRate, outRate);
+	measurement.print("rate", name.c_str(), frames);
+
+	free(buffer);
+	delete converter;
+	delete stream;
+}
+
+void runRateBenchmarks() {
+	static const struct {
+		Audio::st_rate_t inRate, outRate;
+		bool stereo;
+	} configs[] = {
+		{ 11025, 48000, false },
+		{ 22050, 44100, true },
+		{ 48000, 44100, true }
+	};
+
+	for (uint i = 0; i < ARRAYSIZE(configs); ++i) {
+		benchmarkConverter(configs[i].inRate, configs[i].outRate, configs[i].stereo, false);
+		benchmarkConverter(configs[i].inRate, configs[i].outRate, configs[i].stereo, true);
+	}
+}
+
+} // End of namespace Benchmark
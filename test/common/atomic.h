@@ -0,0 +1,46 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atomic.h"
+
+class AtomicTestSuite : public CxxTest::TestSuite {
+public:
+	void test_load_store() {
+		volatile int32 value = 0;
+
+		Common::atomicStore(&value, 42);
+		TS_ASSERT_EQUALS(Common::atomicLoad(&value), 42);
+
+		Common::atomicStore(&value, -1);
+		TS_ASSERT_EQUALS(Common::atomicLoad(&value), -1);
+	}
+
+	void test_exchange() {
+		volatile int32 value = 3;
+
+		TS_ASSERT_EQUALS(Common::atomicExchange(&value, 7), 3);
+		TS_ASSERT_EQUALS(Common::atomicExchange(&value, 0), 7);
+		TS_ASSERT_EQUALS(value, 0);
+	}
+
+	void test_increment() {
+		volatile int32 value = 0;
+
+		TS_ASSERT_EQUALS(Common::atomicIncrement(&value), 1);
+		TS_ASSERT_EQUALS(Common::atomicIncrement(&value), 2);
+		TS_ASSERT_EQUALS(Common::atomicLoad(&value), 2);
+	}
+
+	void test_pointers() {
+		int a, b;
+		int *volatile ptr = 0;
+
+		TS_ASSERT(!Common::atomicLoad(&ptr));
+
+		Common::atomicStore(&ptr, &a);
+		TS_ASSERT_EQUALS(Common::atomicLoad(&ptr), &a);
+
+		TS_ASSERT_EQUALS(Common::atomicExchange(&ptr, &b), &a);
+		TS_ASSERT_EQUALS(Common::atomicExchange(&ptr, (int *)0), &b);
+		TS_ASSERT(!ptr);
+	}
+};
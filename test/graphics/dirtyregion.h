@@ -0,0 +1,96 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/dirtyregion.h"
+
+class DirtyRegionTestSuite : public CxxTest::TestSuite {
+public:
+	/** Check that every pixel of rect is covered by some rectangle of the region. */
+	bool covers(const Graphics::DirtyRegion &region, const Common::Rect &rect) {
+		for (int y = rect.top; y < rect.bottom; ++y) {
+			for (int x = rect.left; x < rect.right; ++x) {
+				bool found = false;
+				for (uint i = 0; i < region.size() && !found; ++i)
+					found = region[i].contains(x, y);
+				if (!found)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	void test_empty_rects() {
+		Graphics::DirtyRegion region(8, 0);
+		region.addRect(Common::Rect());
+		region.addRect(Common::Rect(10, 10, 10, 20));
+		TS_ASSERT(region.empty());
+		TS_ASSERT_EQUALS(region.getStats().rectsAdded, 0U);
+	}
+
+	void test_separate_rects() {
+		Graphics::DirtyRegion region(8, 16);
+		region.addRect(Common::Rect(0, 0, 10, 10));
+		region.addRect(Common::Rect(20, 0, 30, 10));
+		region.addRect(Common::Rect(0, 20, 10, 30));
+		TS_ASSERT_EQUALS(region.size(), 3U);
+		TS_ASSERT_EQUALS(region.getStats().merges, 0U);
+	}
+
+	void test_contained_and_adjacent_rects() {
+		Graphics::DirtyRegion region(8, 0);
+		region.addRect(Common::Rect(0, 0, 10, 10));
+		region.addRect(Common::Rect(2, 2, 5, 5));
+		region.addRect(Common::Rect(10, 0, 20, 10));
+		region.addRect(Common::Rect(0, 10, 20, 15));
+		TS_ASSERT_EQUALS(region.size(), 1U);
+		TS_ASSERT_EQUALS(region[0], Common::Rect(0, 0, 20, 15));
+		TS_ASSERT_EQUALS(region.getStats().merges, 3U);
+	}
+
+	void test_cascading_merge() {
+		// The third rect bridges the first two, whose bounding box then
+		// wastes nothing
+		Graphics::DirtyRegion region(8, 0);
+		region.addRect(Common::Rect(0, 0, 10, 10));
+		region.addRect(Common::Rect(20, 0, 30, 10));
+		TS_ASSERT_EQUALS(region.size(), 2U);
+		region.addRect(Common::Rect(5, 0, 25, 10));
+		TS_ASSERT_EQUALS(region.size(), 1U);
+		TS_ASSERT_EQUALS(region[0], Common::Rect(0, 0, 30, 10));
+	}
+
+	void test_max_rects() {
+		Graphics::DirtyRegion region(4, 0);
+		for (int i = 0; i < 16; ++i) {
+			const Common::Rect rect(i * 20, i * 10, i * 20 + 5, i * 10 + 5);
+			region.addRect(rect);
+			TS_ASSERT_LESS_THAN_EQUALS(region.size(), 4U);
+			TS_ASSERT(covers(region, rect));
+		}
+		TS_ASSERT_LESS_THAN(0U, region.getStats().forcedMerges);
+		TS_ASSERT_EQUALS(region.getStats().merges + region.getStats().forcedMerges + region.size(), 16U);
+
+		// All earlier rects must still be covered
+		for (int i = 0; i < 16; ++i)
+			TS_ASSERT(covers(region, Common::Rect(i * 20, i * 10, i * 20 + 5, i * 10 + 5)));
+	}
+
+	void test_stats() {
+		Graphics::DirtyRegion region(8, 0);
+		region.addRect(Common::Rect(0, 0, 10, 10));
+		region.addRect(Common::Rect(0, 0, 10, 10));
+		region.addRect(Common::Rect(50, 50, 60, 60));
+		region.clear();
+		TS_ASSERT(region.empty());
+
+		const Graphics::DirtyRegion::Stats &stats = region.getStats();
+		TS_ASSERT_EQUALS(stats.frames, 1U);
+		TS_ASSERT_EQUALS(stats.rectsAdded, 3U);
+		TS_ASSERT_EQUALS(stats.rectsOutput, 2U);
+		TS_ASSERT_EQUALS(stats.areaAdded, 300U);
+		TS_ASSERT_EQUALS(stats.areaOutput, 200U);
+
+		region.resetStats();
+		TS_ASSERT_EQUALS(region.getStats().frames, 0U);
+		TS_ASSERT_EQUALS(region.getStats().rectsAdded, 0U);
+	}
+};
@@ -0,0 +1,166 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler.h"
+#include "graphics/scaler/intern.h"
+
+class HQScalerTestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_HQ_SCALERS
+private:
+	enum {
+		kWidth = 61,
+		kHeight = 37,
+		// The scalers read one pixel around the source rectangle, the
+		// golden hashes were made with a border of two pixels
+		kBorder = 2
+	};
+
+	uint32 _seed;
+
+	uint32 random32() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	/**
+	 * Create a test image with flat areas, smooth gradients and noise,
+	 * including a border around it.
+	 */
+	byte *createImage(int width, int height, int bytesPerPixel) {
+		const int pitch = (width + 2 * kBorder) * bytesPerPixel;
+		byte *image = (byte *)malloc(pitch * (height + 2 * kBorder));
+
+		_seed = 1;
+		for (int y = 0; y < height + 2 * kBorder; ++y) {
+			for (int x = 0; x < width + 2 * kBorder; ++x) {
+				uint32 color;
+				switch ((x / 8 + y / 8) % 3) {
+				case 0:
+					color = ((x / 4) & 1) ? 0xFFFFFFFF : 0;
+					break;
+				case 1:
+					color = random32();
+					break;
+				default:
+					color = (x * 0x0421) ^ (y * 0x10101);
+					break;
+				}
+
+				if (bytesPerPixel == 2)
+					*(uint16 *)(image + y * pitch + x * 2) = color & 0xFFFF;
+				else
+					*(uint32 *)(image + y * pitch + x * 4) = color & 0xFFFFFF;
+			}
+		}
+
+		return image;
+	}
+
+	/**
+	 * Scale the test image with the given pattern kernels and return an FNV-1a
+	 * hash of the resulting pixel values.
+	 */
+	uint32 hashScaled(const HQPatternKernels &kernels, int bitFormat, int scale) {
+		const int bytesPerPixel = (bitFormat == 888) ? 4 : 2;
+		const int srcPitch = (kWidth + 2 * kBorder) * bytesPerPixel;
+		const int dstWidth = kWidth * scale;
+		const int dstHeight = kHeight * scale;
+
+		byte *src = createImage(kWidth, kHeight, bytesPerPixel);
+		byte *dst = (byte *)calloc(dstWidth * dstHeight, bytesPerPixel);
+		const byte *srcStart = src + kBorder * srcPitch + kBorder * bytesPerPixel;
+
+		if (scale == 2)
+			HQ2xWithPatternKernels(kernels, bitFormat, srcStart, srcPitch, dst, dstWidth * bytesPerPixel, kWidth, kHeight);
+		else
+			HQ3xWithPatternKernels(kernels, bitFormat, srcStart, srcPitch, dst, dstWidth * bytesPerPixel, kWidth, kHeight);
+
+		uint32 hash = 2166136261U;
+		for (int i = 0; i < dstWidth * dstHeight; ++i) {
+			const uint32 color = (bytesPerPixel == 2) ? ((uint16 *)dst)[i] : ((uint32 *)dst)[i];
+			hash = (hash ^ color) * 16777619U;
+		}
+
+		free(src);
+		free(dst);
+		return hash;
+	}
+
+	void checkGolden(int bitFormat, int scale, uint32 golden) {
+		if (bitFormat != 888)
+			InitScalers(bitFormat);
+
+		for (uint k = 0; k < getHQPatternKernelsCount(); ++k) {
+			const HQPatternKernels &kernels = getHQPatternKernels(k);
+			TSM_ASSERT_EQUALS(kernels.name, hashScaled(kernels, bitFormat, scale), golden);
+		}
+
+		if (bitFormat != 888)
+			DestroyScalers();
+	}
+
+	/**
+	 * Check the patterns of all kernel sets usable on this CPU against the
+	 * reference one, for all row lengths up to a full chunk.
+	 */
+	void checkPatterns(HQPatternProc HQPatternKernels::*proc, int bitFormat) {
+		const int bytesPerPixel = (bitFormat == 888) ? 4 : 2;
+		const int width = kHQPatternChunkSize;
+		const int pitch = (width + 2 * kBorder) * bytesPerPixel;
+
+		byte *image = createImage(width, 3, bytesPerPixel);
+		const byte *start = image + kBorder * pitch + kBorder * bytesPerPixel;
+
+		if (bitFormat != 888)
+			InitScalers(bitFormat);
+
+		uint8 expected[kHQPatternChunkSize];
+		uint8 patterns[kHQPatternChunkSize];
+
+		const HQPatternKernels &reference = getHQPatternKernels(0);
+		for (uint k = 1; k < getHQPatternKernelsCount(); ++k) {
+			const HQPatternKernels &kernels = getHQPatternKernels(k);
+
+			for (int x = 0; x < 3; ++x) {
+				for (int w = 0; w <= width - x; w += (w < 40 ? 1 : 23)) {
+					(reference.*proc)(start + x * bytesPerPixel, pitch, w, expected);
+					(kernels.*proc)(start + x * bytesPerPixel, pitch, w, patterns);
+					TSM_ASSERT(kernels.name, memcmp(expected, patterns, w) == 0);
+				}
+			}
+		}
+
+		if (bitFormat != 888)
+			DestroyScalers();
+		free(image);
+	}
+#endif
+
+public:
+	void test_kernels_patterns() {
+#ifdef USE_HQ_SCALERS
+		checkPatterns(&HQPatternKernels::pattern555, 555);
+		checkPatterns(&HQPatternKernels::pattern565, 565);
+		checkPatterns(&HQPatternKernels::pattern888, 888);
+#endif
+	}
+
+	// The golden hashes were produced by the original C implementation of
+	// the scalers. Any change to them means the output is no longer the same.
+
+	void test_hq2x_golden() {
+#ifdef USE_HQ_SCALERS
+		checkGolden(555, 2, 0xb2e09a09);
+		checkGolden(565, 2, 0xe173d1ef);
+		checkGolden(888, 2, 0x16dc06e5);
+#endif
+	}
+
+	void test_hq3x_golden() {
+#ifdef USE_HQ_SCALERS
+		checkGolden(555, 3, 0x1e57f948);
+		checkGolden(565, 3, 0x8d2d9c6a);
+		checkGolden(888, 3, 0x029e2afa);
+#endif
+	}
+};
@@ -0,0 +1,111 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transform_cache.h"
+
+class TransformCacheTestSuite : public CxxTest::TestSuite {
+public:
+	/** A 4 bytes per pixel surface filled with the given value. */
+	void makeSurface(Graphics::Surface &surf, int w, int h, uint32 value) {
+		surf.create(w, h, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		for (int y = 0; y < h; ++y) {
+			uint32 *row = (uint32 *)surf.getBasePtr(0, y);
+			for (int x = 0; x < w; ++x)
+				row[x] = value;
+		}
+	}
+
+	void test_hit_and_miss() {
+		Graphics::TransformCache cache(1024 * 1024);
+		Graphics::Surface surf;
+		makeSurface(surf, 8, 4, 0x12345678);
+		int source;
+		Common::Rect srcRect(0, 0, 16, 8);
+		Graphics::TransformStruct transform(50, 50, 0);
+
+		TS_ASSERT(!cache.get(&source, srcRect, transform, 8, 4));
+		cache.put(&source, srcRect, transform, 8, 4, surf);
+
+		const Graphics::Surface *cached = cache.get(&source, srcRect, transform, 8, 4);
+		TS_ASSERT(cached);
+		if (cached) {
+			TS_ASSERT_EQUALS(cached->w, 8);
+			TS_ASSERT_EQUALS(cached->h, 4);
+			TS_ASSERT_EQUALS(*(const uint32 *)cached->getBasePtr(7, 3), 0x12345678U);
+		}
+
+		// Any part of the key differing is a miss
+		int otherSource;
+		Graphics::TransformStruct rotated(50, 50, 90);
+		Graphics::TransformStruct moved(50, 50, 0, 3, 3);
+		TS_ASSERT(!cache.get(&otherSource, srcRect, transform, 8, 4));
+		TS_ASSERT(!cache.get(&source, Common::Rect(1, 0, 17, 8), transform, 8, 4));
+		TS_ASSERT(!cache.get(&source, srcRect, rotated, 8, 4));
+		TS_ASSERT(!cache.get(&source, srcRect, moved, 8, 4));
+		TS_ASSERT(!cache.get(&source, srcRect, transform, 8, 5));
+
+		TS_ASSERT_EQUALS(cache.getStats().hits, 1U);
+		TS_ASSERT_EQUALS(cache.getStats().misses, 6U);
+		surf.free();
+	}
+
+	void test_lru_eviction() {
+		// Room for exactly two 8x8 surfaces
+		Graphics::TransformCache cache(2 * 8 * 8 * 4);
+		Graphics::Surface surf;
+		makeSurface(surf, 8, 8, 0);
+		int a, b, c;
+		Common::Rect srcRect(0, 0, 4, 4);
+		Graphics::TransformStruct transform(200, 200, 0);
+
+		cache.put(&a, srcRect, transform, 8, 8, surf);
+		cache.put(&b, srcRect, transform, 8, 8, surf);
+		// Touch a, so b is the least recently used entry
+		TS_ASSERT(cache.get(&a, srcRect, transform, 8, 8));
+		cache.put(&c, srcRect, transform, 8, 8, surf);
+
+		TS_ASSERT_EQUALS(cache.size(), 2U);
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), cache.getMaxBytes());
+		TS_ASSERT_EQUALS(cache.getStats().evictions, 1U);
+		TS_ASSERT(cache.get(&a, srcRect, transform, 8, 8));
+		TS_ASSERT(!cache.get(&b, srcRect, transform, 8, 8));
+		TS_ASSERT(cache.get(&c, srcRect, transform, 8, 8));
+		surf.free();
+	}
+
+	void test_too_large() {
+		Graphics::TransformCache cache(100);
+		Graphics::Surface surf;
+		makeSurface(surf, 8, 8, 0);
+		int source;
+		cache.put(&source, Common::Rect(0, 0, 8, 8), Graphics::TransformStruct(), 8, 8, surf);
+		TS_ASSERT_EQUALS(cache.size(), 0U);
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), 0U);
+		surf.free();
+	}
+
+	void test_invalidate() {
+		Graphics::TransformCache cache(1024 * 1024);
+		Graphics::Surface surf;
+		makeSurface(surf, 4, 4, 0);
+		int a, b;
+		Common::Rect srcRect(0, 0, 2, 2);
+		Graphics::TransformStruct small(200, 200, 0);
+		Graphics::TransformStruct large(400, 400, 0);
+
+		cache.put(&a, srcRect, small, 4, 4, surf);
+		cache.put(&a, srcRect, large, 8, 8, surf);
+		cache.put(&b, srcRect, small, 4, 4, surf);
+		cache.invalidate(&a);
+
+		TS_ASSERT_EQUALS(cache.size(), 1U);
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), (uint32)surf.pitch * surf.h);
+		TS_ASSERT(!cache.get(&a, srcRect, small, 4, 4));
+		TS_ASSERT(!cache.get(&a, srcRect, large, 8, 8));
+		TS_ASSERT(cache.get(&b, srcRect, small, 4, 4));
+
+		cache.clear();
+		TS_ASSERT_EQUALS(cache.size(), 0U);
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), 0U);
+		surf.free();
+	}
+};
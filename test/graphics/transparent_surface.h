@@ -0,0 +1,113 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transparent_surface.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite {
+private:
+	enum {
+		kMaxWidth = 37
+	};
+
+	uint32 _seed;
+
+	uint32 random32() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8 | _seed << 24;
+	}
+
+	/**
+	 * Fill a row with random pixels, using the extreme alpha values much
+	 * more often than others.
+	 */
+	void fillRow(uint32 *row, uint width) {
+		for (uint i = 0; i < width; ++i) {
+			uint32 pixel = random32();
+			switch (random32() % 4) {
+			case 0:
+				pixel &= ~(uint32)0xFF;
+				break;
+			case 1:
+				pixel |= 0xFF;
+				break;
+			default:
+				break;
+			}
+			row[i] = TO_LE_32(pixel);
+		}
+	}
+
+	typedef Graphics::TransparentBlitRowProc Graphics::TransparentBlitKernels::*KernelProc;
+
+	/**
+	 * Run the given kernel of all implementations on random rows of every
+	 * width up to kMaxWidth, in both directions, and compare the results to
+	 * the C++ implementation.
+	 */
+	void compareKernels(KernelProc proc, const char *name) {
+		const Graphics::TransparentBlitKernels &reference = Graphics::getTransparentBlitKernels(0);
+
+		for (uint k = 1; k < Graphics::getTransparentBlitKernelsCount(); ++k) {
+			const Graphics::TransparentBlitKernels &kernels = Graphics::getTransparentBlitKernels(k);
+			_seed = 1;
+
+			for (uint width = 0; width <= kMaxWidth; ++width) {
+				for (int flip = 0; flip < 2; ++flip) {
+					uint32 src[kMaxWidth], dst[kMaxWidth], expected[kMaxWidth];
+					fillRow(src, width);
+					fillRow(dst, width);
+					memcpy(expected, dst, sizeof(dst));
+
+					const uint32 color = (random32() % 2) ? 0xFFFFFFFF : random32();
+					const byte *in = (const byte *)(flip ? src + width - 1 : src);
+					const int32 inStep = flip ? -4 : 4;
+
+					(reference.*proc)(in, inStep, (byte *)expected, width, color);
+					(kernels.*proc)(in, inStep, (byte *)dst, width, color);
+
+					if (memcmp(dst, expected, width * 4))
+						TS_FAIL(Common::String::format("%s %s: width %d %s differs", kernels.name, name, width, flip ? "flipped" : "").c_str());
+				}
+			}
+		}
+	}
+
+public:
+	void test_kernels_opaque() {
+		compareKernels(&Graphics::TransparentBlitKernels::opaque, "opaque");
+	}
+
+	void test_kernels_binary() {
+		compareKernels(&Graphics::TransparentBlitKernels::binary, "binary");
+	}
+
+	void test_kernels_alpha_blend() {
+		compareKernels(&Graphics::TransparentBlitKernels::alphaBlend, "alphaBlend");
+	}
+
+	void test_kernels_alpha_blend_color() {
+		compareKernels(&Graphics::TransparentBlitKernels::alphaBlendColor, "alphaBlendColor");
+	}
+
+	void test_blit_opaque_flipped() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::TransparentSurface src;
+		src.create(5, 2, format);
+		src.setAlphaMode(Graphics::ALPHA_OPAQUE);
+		for (int y = 0; y < 2; ++y) {
+			for (int x = 0; x < 5; ++x)
+				*(uint32 *)src.getBasePtr(x, y) = format.ARGBToColor(0, x * 40, y * 40, 7);
+		}
+
+		Graphics::Surface dst;
+		dst.create(5, 2, format);
+		src.blit(dst, 0, 0, Graphics::FLIP_H);
+
+		for (int y = 0; y < 2; ++y) {
+			for (int x = 0; x < 5; ++x)
+				TS_ASSERT_EQUALS(*(uint32 *)dst.getBasePtr(x, y), format.ARGBToColor(255, (4 - x) * 40, y * 40, 7));
+		}
+
+		dst.free();
+		src.free();
+	}
+};
@@ -3,10 +3,18 @@
 # Use the 'test' target to run them.
 # Edit TESTS and TESTLIBS to add more tests.
 #
+# Performance benchmarks are built and run by the 'benchmark' target.
+#
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h
+TEST_LIBS    := audio/libaudio.a graphics/libgraphics.a common/libcommon.a
+
+BENCHMARKS   := $(wildcard $(srcdir)/test/benchmark/*.cpp)
+BENCHMARK_OBJS :=
+ifdef ENABLE_EVENTRECORDER
+BENCHMARK_OBJS += $(addprefix test/benchmark/norecorder/,audio/mixer.o common/random.o common/system.o)
+endif
 
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
@@ -34,9 +42,23 @@ test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+benchmark: test/benchmark/runner
+	./test/benchmark/runner
+test/benchmark/runner: $(BENCHMARKS) $(BENCHMARK_OBJS) $(TEST_LIBS)
+	@mkdir -p test/benchmark
+	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+
+# The event recorder is part of the GUI and needs a backend, which the
+# benchmarks don't link. The library objects calling into it are rebuilt
+# with the recorder disabled and linked ahead of the libraries instead.
+test/benchmark/norecorder/%.o: $(srcdir)/%.cpp $(srcdir)/test/benchmark/norecorder.h
+	@mkdir -p $(dir $@)
+	$(QUIET_CXX)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) -include $(srcdir)/test/benchmark/norecorder.h -c $< -o $@
+
 
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/benchmark/runner
+	-$(RM) -r test/benchmark/norecorder
 
-.PHONY: test clean-test
+.PHONY: test benchmark clean-test